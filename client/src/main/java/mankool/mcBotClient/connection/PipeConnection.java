@@ -20,8 +20,15 @@ import java.nio.ByteOrder;
 import java.nio.channels.Channels;
 import java.nio.channels.SocketChannel;
 import java.nio.file.Path;
+import java.util.ArrayList;
+import java.util.EnumSet;
+import java.util.HashMap;
+import java.util.List;
+import java.util.Map;
+import java.util.Set;
 import java.util.concurrent.BlockingQueue;
 import java.util.concurrent.LinkedBlockingQueue;
+import java.util.concurrent.Semaphore;
 import java.util.concurrent.atomic.AtomicBoolean;
 
 public class PipeConnection {
@@ -39,11 +46,53 @@ public class PipeConnection {
         return "/tmp/" + PIPE_NAME;
     }
 
-    private final BlockingQueue<Protocol.ClientToManagerMessage> sendQueue = new LinkedBlockingQueue<>();
+    // Protocol features offered in ConnectionInfo; the manager replies with the ones it accepts
+    public static final int SUPPORTED_FEATURES = Connection.ProtocolFeature.TICK_BATCH_VALUE
+        | Connection.ProtocolFeature.PACKED_BLOCK_INDICES_VALUE
+        | Connection.ProtocolFeature.ENTITY_DELTAS_VALUE
+        | Connection.ProtocolFeature.STRING_DICTIONARY_VALUE;
+    // A tick batch is sent early once it grows past this many serialized bytes
+    private static final int MAX_TICK_BATCH_BYTES = 1024 * 1024;
+
+    // Messages someone may be waiting on (handshake, heartbeats, chat, command responses) go out
+    // ahead of bulk world data. Must match the manager's control lane in ConnectionSession::laneFor.
+    // String definitions stay in bulk so they reach the manager ahead of the messages using them.
+    private static final Set<Protocol.ClientToManagerMessage.PayloadCase> CONTROL_PAYLOADS = EnumSet.of(
+        Protocol.ClientToManagerMessage.PayloadCase.CONNECTION_INFO,
+        Protocol.ClientToManagerMessage.PayloadCase.HEARTBEAT,
+        Protocol.ClientToManagerMessage.PayloadCase.CHAT,
+        Protocol.ClientToManagerMessage.PayloadCase.COMMAND_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.MODULES_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.MODULE_CONFIG_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.BARITONE_SETTINGS_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.BARITONE_COMMANDS_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.BARITONE_SETTINGS_SET_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.BARITONE_COMMAND_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.QUERY_REGISTRY,
+        Protocol.ClientToManagerMessage.PayloadCase.QUERY_ITEM_REGISTRY,
+        Protocol.ClientToManagerMessage.PayloadCase.CAN_REACH_BLOCK_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.CAN_REACH_BLOCKS_RESPONSE,
+        Protocol.ClientToManagerMessage.PayloadCase.HOLD_ATTACK_STATUS_RESPONSE);
+
+    private final BlockingQueue<Protocol.ClientToManagerMessage> controlQueue = new LinkedBlockingQueue<>();
+    private final BlockingQueue<Protocol.ClientToManagerMessage> bulkQueue = new LinkedBlockingQueue<>();
+    private final Semaphore sendPermits = new Semaphore(0);  // One permit per queued message
     private final BlockingQueue<Protocol.ManagerToClientMessage> receiveQueue = new LinkedBlockingQueue<>();
     private final AtomicBoolean connected = new AtomicBoolean(false);
     private final AtomicBoolean running = new AtomicBoolean(false);
 
+    // ProtocolFeature bits accepted by the manager; zero until it replies to ConnectionInfo
+    private volatile int enabledFeatures = 0;
+
+    // Tick batching (TICK_BATCH feature): messages are collected here and sent as one frame per tick
+    private volatile boolean tickBatchEnabled = false;
+    private final Object batchLock = new Object();
+    private List<Protocol.ClientToManagerMessage> pendingBatch = new ArrayList<>();
+    private int pendingBatchBytes = 0;
+
+    // Session string dictionary (STRING_DICTIONARY feature); ids are only valid for this connection
+    private final Map<String, Integer> stringIds = new HashMap<>();
+
     private Thread sendThread;
     private Thread receiveThread;
     private OutputStream outputStream;
@@ -100,8 +149,14 @@ public class PipeConnection {
     private void sendLoop() {
         while (running.get()) {
             try {
-                Protocol.ClientToManagerMessage message = sendQueue.take();
-                sendMessageInternal(message);
+                sendPermits.acquire();
+                Protocol.ClientToManagerMessage message = controlQueue.poll();
+                if (message == null) {
+                    message = bulkQueue.poll();
+                }
+                if (message != null) {
+                    sendMessageInternal(message);
+                }
             } catch (InterruptedException e) {
                 Thread.currentThread().interrupt();
                 break;
@@ -178,6 +233,16 @@ public class PipeConnection {
 
         running.set(false);
 
+        enabledFeatures = 0;
+        tickBatchEnabled = false;
+        synchronized (stringIds) {
+            stringIds.clear();
+        }
+        synchronized (batchLock) {
+            pendingBatch.clear();
+            pendingBatchBytes = 0;
+        }
+
         if (sendThread != null) sendThread.interrupt();
         if (receiveThread != null) receiveThread.interrupt();
 
@@ -200,7 +265,96 @@ public class PipeConnection {
         if (!connected.get()) {
             throw new IllegalStateException("Not connected to pipe");
         }
-        sendQueue.offer(message);
+        // Control messages are never held back for the tick batch
+        if (!tickBatchEnabled || CONTROL_PAYLOADS.contains(message.getPayloadCase())) {
+            enqueue(message);
+            return;
+        }
+
+        boolean full;
+        synchronized (batchLock) {
+            pendingBatch.add(message);
+            pendingBatchBytes += message.getSerializedSize();
+            full = pendingBatchBytes >= MAX_TICK_BATCH_BYTES;
+        }
+        if (full) {
+            flushTickBatch();
+        }
+    }
+
+    public void setEnabledFeatures(int flags) {
+        enabledFeatures = flags;
+        tickBatchEnabled = (flags & Connection.ProtocolFeature.TICK_BATCH_VALUE) != 0;
+        if (!tickBatchEnabled) {
+            flushTickBatch();
+        }
+    }
+
+    public boolean isFeatureEnabled(Connection.ProtocolFeature feature) {
+        return (enabledFeatures & feature.getNumber()) != 0;
+    }
+
+    /**
+     * Returns the session dictionary id for a string, defining it on first use, or 0 when
+     * the manager hasn't enabled STRING_DICTIONARY (callers then send the string inline).
+     * The definition is queued (in the tick batch or the bulk queue, like the world data that
+     * refers to it) while the lock is held, so no thread can send the id before it.
+     */
+    public int stringId(String value) {
+        if (!isFeatureEnabled(Connection.ProtocolFeature.STRING_DICTIONARY)) {
+            return 0;
+        }
+        synchronized (stringIds) {
+            Integer existing = stringIds.get(value);
+            if (existing != null) {
+                return existing;
+            }
+            int id = stringIds.size() + 1;
+            stringIds.put(value, id);
+
+            Connection.StringDefinitions definitions = Connection.StringDefinitions.newBuilder()
+                .addDefinitions(Connection.StringDefinition.newBuilder().setStringId(id).setValue(value))
+                .build();
+            sendMessage(Protocol.ClientToManagerMessage.newBuilder()
+                .setTimestamp(System.currentTimeMillis())
+                .setStringDefinitions(definitions)
+                .build());
+            return id;
+        }
+    }
+
+    // Sends everything collected since the last flush as one ClientTickBatch frame.
+    // Called at the end of each client tick; a no-op when batching is off.
+    public void flushTickBatch() {
+        List<Protocol.ClientToManagerMessage> batch;
+        synchronized (batchLock) {
+            if (pendingBatch.isEmpty()) {
+                return;
+            }
+            batch = pendingBatch;
+            pendingBatch = new ArrayList<>();
+            pendingBatchBytes = 0;
+        }
+
+        if (batch.size() == 1) {
+            enqueue(batch.get(0));
+            return;
+        }
+
+        Protocol.ClientToManagerMessage message = Protocol.ClientToManagerMessage.newBuilder()
+            .setTimestamp(System.currentTimeMillis())
+            .setTickBatch(Protocol.ClientTickBatch.newBuilder().addAllMessages(batch))
+            .build();
+        enqueue(message);
+    }
+
+    private void enqueue(Protocol.ClientToManagerMessage message) {
+        if (CONTROL_PAYLOADS.contains(message.getPayloadCase())) {
+            controlQueue.offer(message);
+        } else {
+            bulkQueue.offer(message);
+        }
+        sendPermits.release();
     }
 
     public Protocol.ManagerToClientMessage receiveMessage() {
@@ -225,6 +379,8 @@ public class PipeConnection {
 
         Connection.HeartbeatMessage heartbeat = Connection.HeartbeatMessage.newBuilder()
             .setCurrentMemory(currentMemory)
+            .setControlQueueDepth(controlQueue.size())
+            .setBulkQueueDepth(bulkQueue.size())
             .build();
 
         Protocol.ClientToManagerMessage message = Protocol.ClientToManagerMessage.newBuilder()
@@ -112,6 +112,8 @@ public class MessageHandler {
             msg -> worldInteractionHandler.handleInteractWithBlock(msg.getMessageId(), msg.getInteractWithBlock()));
         handlers.put(Protocol.ManagerToClientMessage.PayloadCase.CAN_REACH_BLOCK,
             msg -> worldInteractionHandler.handleCanReachBlock(msg.getMessageId(), msg.getCanReachBlock()));
+        handlers.put(Protocol.ManagerToClientMessage.PayloadCase.CAN_REACH_BLOCKS,
+            msg -> worldInteractionHandler.handleCanReachBlocks(msg.getMessageId(), msg.getCanReachBlocks()));
         handlers.put(Protocol.ManagerToClientMessage.PayloadCase.REGISTRY_RESPONSE,
             msg -> worldOutbound.handleRegistryResponse(msg.getRegistryResponse()));
         handlers.put(Protocol.ManagerToClientMessage.PayloadCase.ITEM_REGISTRY_RESPONSE,
@@ -140,6 +142,13 @@ public class MessageHandler {
             msg -> worldInteractionHandler.handleGetHoldAttackStatus(msg.getMessageId()));
         handlers.put(Protocol.ManagerToClientMessage.PayloadCase.REQUEST_INVENTORY_RESYNC,
             msg -> inventoryHandler.handleRequestInventoryResync(msg.getMessageId()));
+        handlers.put(Protocol.ManagerToClientMessage.PayloadCase.PROTOCOL_FEATURES,
+            msg -> handleProtocolFeatures(msg.getProtocolFeatures()));
+    }
+
+    private void handleProtocolFeatures(Connection.ProtocolFeatures features) {
+        connection.setEnabledFeatures(features.getFeatureFlags());
+        LOGGER.info("Manager protocol features: 0x{}", Integer.toHexString(features.getFeatureFlags()));
     }
 
     public void start() {
@@ -200,5 +209,8 @@ public class MessageHandler {
 
         // Tick world interaction handler for continuous actions
         worldInteractionHandler.tick();
+
+        // Everything queued this tick goes out as one frame (no-op unless tick batching is on)
+        connection.flushTickBatch();
     }
 }
\ No newline at end of file
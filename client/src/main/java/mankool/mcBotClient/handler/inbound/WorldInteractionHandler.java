@@ -1,6 +1,7 @@
 package mankool.mcBotClient.handler.inbound;
 
 import baritone.api.BaritoneAPI;
+import com.google.protobuf.ByteString;
 import mankool.mcBotClient.connection.PipeConnection;
 import mankool.mcbot.protocol.Common;
 import mankool.mcbot.protocol.Protocol;
@@ -190,6 +191,45 @@ public class WorldInteractionHandler extends BaseInboundHandler {
         }
     }
 
+    public void handleCanReachBlocks(String messageId, World.CanReachBlocksCommand command) {
+        LocalPlayer player = client.player;
+        ClientLevel level = client.level;
+        int count = command.getPositionsCount();
+        byte[] reachable = new byte[(count + 7) / 8];
+
+        if (player == null || level == null) {
+            sendCanReachBlocksResponse(messageId, reachable, count);
+            return;
+        }
+
+        try {
+            var ctx = BaritoneAPI.getProvider().getPrimaryBaritone().getPlayerContext();
+            double blockReachDistance = ctx.playerController().getBlockReachDistance();
+
+            Common.BlockPos from = command.hasFromPosition() ? command.getFromPosition() : null;
+            double baseX = from != null ? from.getX() + 0.5 : player.getX();
+            double baseY = from != null ? from.getY()       : player.getY();
+            double baseZ = from != null ? from.getZ() + 0.5 : player.getZ();
+            Vec3 eyePos = new Vec3(baseX, baseY + player.getEyeHeight(command.getSneak() ? Pose.CROUCHING : Pose.STANDING), baseZ);
+
+            int faceOrdinal = command.getFace().getNumber();
+            for (int i = 0; i < count; i++) {
+                Common.BlockPos protoPos = command.getPositions(i);
+                BlockPos blockPos = new BlockPos(protoPos.getX(), protoPos.getY(), protoPos.getZ());
+                boolean hit = faceOrdinal == 0
+                    ? rayTraceBlock(level, player, eyePos, blockPos, blockReachDistance).isPresent()
+                    : rayTraceBlockFace(level, player, eyePos, blockPos, blockReachDistance, faceOrdinal).isPresent();
+                if (hit) {
+                    reachable[i >> 3] |= (byte) (1 << (i & 7));
+                }
+            }
+        } catch (Exception e) {
+            LOGGER.error("Error checking reachability", e);
+            reachable = new byte[(count + 7) / 8];
+        }
+        sendCanReachBlocksResponse(messageId, reachable, count);
+    }
+
     private Optional<BlockHitResult> rayTraceBlock(ClientLevel level, LocalPlayer player, Vec3 eyePos, BlockPos blockPos, double reachDistance) {
         VoxelShape shape = level.getBlockState(blockPos).getShape(level, blockPos);
         if (shape.isEmpty()) return Optional.empty();
@@ -246,4 +286,18 @@ public class WorldInteractionHandler extends BaseInboundHandler {
             .build();
         connection.sendMessage(msg);
     }
-}
\ No newline at end of file
+
+    private void sendCanReachBlocksResponse(String messageId, byte[] reachable, int count) {
+        World.CanReachBlocksResponse response = World.CanReachBlocksResponse.newBuilder()
+            .setCommandId(messageId)
+            .setReachable(ByteString.copyFrom(reachable))
+            .setCount(count)
+            .build();
+        Protocol.ClientToManagerMessage msg = Protocol.ClientToManagerMessage.newBuilder()
+            .setMessageId(UUID.randomUUID().toString())
+            .setTimestamp(System.currentTimeMillis())
+            .setCanReachBlocksResponse(response)
+            .build();
+        connection.sendMessage(msg);
+    }
+}
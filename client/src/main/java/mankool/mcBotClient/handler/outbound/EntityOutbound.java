@@ -1,16 +1,19 @@
 package mankool.mcBotClient.handler.outbound;
 
+import mankool.mcbot.protocol.Connection;
 import mankool.mcbot.protocol.Entities;
 import mankool.mcbot.protocol.Protocol;
 import mankool.mcBotClient.connection.PipeConnection;
 import mankool.mcBotClient.util.ProtoUtil;
 import mankool.mcBotClient.util.VersionCompat;
 import net.minecraft.client.Minecraft;
+import net.minecraft.client.multiplayer.ClientLevel;
 import net.minecraft.core.registries.BuiltInRegistries;
 import net.minecraft.world.entity.Entity;
 import net.minecraft.world.entity.LivingEntity;
 import net.minecraft.world.entity.item.ItemEntity;
 import net.minecraft.world.entity.player.Player;
+import net.minecraft.world.item.ItemStack;
 import net.minecraft.world.phys.Vec3;
 
 import java.util.HashMap;
@@ -24,6 +27,9 @@ public class EntityOutbound extends BaseOutbound {
     private static class EntitySnapshot {
         final double x, y, z;
         final float yaw, pitch;
+        final double velX, velY, velZ;
+        final float health, maxHealth;
+        final ItemStack item;
 
         EntitySnapshot(Entity e) {
             this.x = e.getX();
@@ -31,10 +37,24 @@ public class EntityOutbound extends BaseOutbound {
             this.z = e.getZ();
             this.yaw = e.getYRot();
             this.pitch = e.getXRot();
+            Vec3 vel = e.getDeltaMovement();
+            this.velX = vel.x;
+            this.velY = vel.y;
+            this.velZ = vel.z;
+            if (e instanceof LivingEntity living) {
+                this.health = living.getHealth();
+                this.maxHealth = living.getMaxHealth();
+            } else {
+                this.health = 0;
+                this.maxHealth = 0;
+            }
+            this.item = e instanceof ItemEntity itemEntity ? itemEntity.getItem().copy() : ItemStack.EMPTY;
         }
     }
 
     private final Map<Integer, EntitySnapshot> lastSnapshot = new HashMap<>();
+    // The manager drops its entities when the bot leaves a server, so a new level starts from full records
+    private ClientLevel lastLevel;
 
     public EntityOutbound(Minecraft client, PipeConnection connection) {
         super(client, connection);
@@ -42,6 +62,10 @@ public class EntityOutbound extends BaseOutbound {
 
     @Override
     protected void onClientTick(Minecraft client) {
+        if (client.level != lastLevel) {
+            lastLevel = client.level;
+            lastSnapshot.clear();
+        }
         if (client.level == null) {
             return;
         }
@@ -51,20 +75,34 @@ public class EntityOutbound extends BaseOutbound {
 
         Set<Integer> currentIds = new HashSet<>();
 
+        boolean deltas = connection.isFeatureEnabled(Connection.ProtocolFeature.ENTITY_DELTAS);
+
         for (Entity entity : client.level.entitiesForRendering()) {
             int id = entity.getId();
             currentIds.add(id);
 
             EntitySnapshot snap = lastSnapshot.get(id);
-            boolean isNew = (snap == null);
-            boolean changed = false;
+            if (snap == null) {
+                Entities.EntityData data = buildEntityData(entity);
+                if (data != null) {
+                    builder.addUpserted(data);
+                    lastSnapshot.put(id, new EntitySnapshot(entity));
+                }
+                continue;
+            }
 
-            if (!isNew) {
-                changed = entity.getX() != snap.x || entity.getY() != snap.y || entity.getZ() != snap.z
-                     || entity.getYRot() != snap.yaw || entity.getXRot() != snap.pitch;
+            if (deltas) {
+                Entities.EntityDelta delta = buildEntityDelta(entity, snap);
+                if (delta != null) {
+                    builder.addDeltas(delta);
+                    lastSnapshot.put(id, new EntitySnapshot(entity));
+                }
+                continue;
             }
 
-            if (isNew || changed) {
+            boolean changed = entity.getX() != snap.x || entity.getY() != snap.y || entity.getZ() != snap.z
+                 || entity.getYRot() != snap.yaw || entity.getXRot() != snap.pitch;
+            if (changed) {
                 Entities.EntityData data = buildEntityData(entity);
                 if (data != null) {
                     builder.addUpserted(data);
@@ -81,7 +119,7 @@ public class EntityOutbound extends BaseOutbound {
             lastSnapshot.remove(removedId);
         }
 
-        if (builder.getUpsertedCount() > 0 || builder.getRemovedIdsCount() > 0) {
+        if (builder.getUpsertedCount() > 0 || builder.getRemovedIdsCount() > 0 || builder.getDeltasCount() > 0) {
             Protocol.ClientToManagerMessage message = Protocol.ClientToManagerMessage.newBuilder()
                     .setMessageId(UUID.randomUUID().toString())
                     .setTimestamp(System.currentTimeMillis())
@@ -98,6 +136,40 @@ public class EntityOutbound extends BaseOutbound {
         return result;
     }
 
+    /**
+     * Builds a delta with the field groups that changed since the snapshot, or null if nothing did.
+     */
+    private Entities.EntityDelta buildEntityDelta(Entity entity, EntitySnapshot snap) {
+        Entities.EntityDelta.Builder builder = Entities.EntityDelta.newBuilder()
+                .setEntityId(entity.getId());
+        int changed = 0;
+
+        if (entity.getX() != snap.x || entity.getY() != snap.y || entity.getZ() != snap.z) {
+            changed |= Entities.EntityDeltaField.ENTITY_DELTA_POSITION_VALUE;
+            builder.setX(entity.getX()).setY(entity.getY()).setZ(entity.getZ());
+        }
+        if (entity.getYRot() != snap.yaw || entity.getXRot() != snap.pitch) {
+            changed |= Entities.EntityDeltaField.ENTITY_DELTA_ROTATION_VALUE;
+            builder.setYaw(normalizeYaw(entity.getYRot())).setPitch(entity.getXRot());
+        }
+        Vec3 vel = entity.getDeltaMovement();
+        if (vel.x != snap.velX || vel.y != snap.velY || vel.z != snap.velZ) {
+            changed |= Entities.EntityDeltaField.ENTITY_DELTA_VELOCITY_VALUE;
+            builder.setVelX(vel.x).setVelY(vel.y).setVelZ(vel.z);
+        }
+        if (entity instanceof LivingEntity living
+                && (living.getHealth() != snap.health || living.getMaxHealth() != snap.maxHealth)) {
+            changed |= Entities.EntityDeltaField.ENTITY_DELTA_HEALTH_VALUE;
+            builder.setHealth(living.getHealth()).setMaxHealth(living.getMaxHealth());
+        }
+        if (entity instanceof ItemEntity itemEntity && !ItemStack.matches(itemEntity.getItem(), snap.item)) {
+            changed |= Entities.EntityDeltaField.ENTITY_DELTA_ITEM_STACK_VALUE;
+            builder.setItemStack(ProtoUtil.buildItemStack(itemEntity.getItem(), 0));
+        }
+
+        return changed == 0 ? null : builder.setChanged(changed).build();
+    }
+
     private Entities.EntityData buildEntityData(Entity entity) {
         String typeId = VersionCompat.registryGetKeyId(BuiltInRegistries.ENTITY_TYPE, entity.getType());
         if (typeId == null) {
@@ -109,7 +181,6 @@ public class EntityOutbound extends BaseOutbound {
         Entities.EntityData.Builder builder = Entities.EntityData.newBuilder()
                 .setEntityId(entity.getId())
                 .setUuid(entity.getUUID().toString())
-                .setType(typeId)
                 .setX(entity.getX())
                 .setY(entity.getY())
                 .setZ(entity.getZ())
@@ -119,6 +190,13 @@ public class EntityOutbound extends BaseOutbound {
                 .setVelY(vel.y)
                 .setVelZ(vel.z);
 
+        int typeRef = connection.stringId(typeId);
+        if (typeRef != 0) {
+            builder.setTypeRef(typeRef);
+        } else {
+            builder.setType(typeId);
+        }
+
         if (entity instanceof LivingEntity living) {
             builder.setIsLiving(true)
                    .setHealth(living.getHealth())
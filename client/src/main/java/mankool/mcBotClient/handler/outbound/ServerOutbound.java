@@ -66,6 +66,7 @@ public class ServerOutbound extends BaseOutbound {
             .setDataVersion(dataVersion)
             .setVersionSeries(versionSeries)
             .setVersionIsSnapshot(isSnapshot)
+            .setFeatureFlags(PipeConnection.SUPPORTED_FEATURES)
             .build();
 
         Protocol.ClientToManagerMessage message = Protocol.ClientToManagerMessage.newBuilder()
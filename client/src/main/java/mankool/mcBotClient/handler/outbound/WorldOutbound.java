@@ -4,6 +4,7 @@ import mankool.mcBotClient.connection.PipeConnection;
 import mankool.mcBotClient.util.VersionCompat;
 import net.minecraft.SharedConstants;
 import mankool.mcbot.protocol.Common;
+import mankool.mcbot.protocol.Connection;
 import mankool.mcbot.protocol.Protocol;
 import mankool.mcbot.protocol.Registry;
 import mankool.mcbot.protocol.World;
@@ -330,9 +331,16 @@ public class WorldOutbound extends BaseOutbound {
         World.ChunkDataMessage.Builder chunkBuilder = World.ChunkDataMessage.newBuilder()
             .setChunkX(VersionCompat.chunkPosX(chunk.getPos()))
             .setChunkZ(VersionCompat.chunkPosZ(chunk.getPos()))
-            .setDimension(VersionCompat.keyId(client.level.dimension()))
             .setMinY(chunk.getMinY())
             .setMaxY(chunk.getMaxY());
+        String dimension = VersionCompat.keyId(client.level.dimension());
+        int dimensionRef = connection.stringId(dimension);
+        if (dimensionRef != 0) {
+            chunkBuilder.setDimensionRef(dimensionRef);
+        } else {
+            chunkBuilder.setDimension(dimension);
+        }
+        boolean packedIndices = connection.isFeatureEnabled(Connection.ProtocolFeature.PACKED_BLOCK_INDICES);
 
         // Encode each section
         LevelChunkSection[] sections = chunk.getSections();
@@ -343,7 +351,7 @@ public class WorldOutbound extends BaseOutbound {
             }
 
             int sectionY = chunk.getMinSectionY() + i;
-            World.ChunkSection sectionProto = encodeSection(section, sectionY, blockLightMap, skyLightMap);
+            World.ChunkSection sectionProto = encodeSection(section, sectionY, blockLightMap, skyLightMap, packedIndices, connection);
             chunkBuilder.addSections(sectionProto);
         }
 
@@ -375,11 +383,14 @@ public class WorldOutbound extends BaseOutbound {
      */
     private static World.ChunkSection encodeSection(LevelChunkSection section, int sectionY,
                                                     java.util.Map<Integer, byte[]> blockLightMap,
-                                                    java.util.Map<Integer, byte[]> skyLightMap) {
+                                                    java.util.Map<Integer, byte[]> skyLightMap,
+                                                    boolean packedIndices,
+                                                    PipeConnection connection) {
         // Build palette and indices using numeric state IDs
         Map<Integer, Integer> stateIdToPaletteIndex = new LinkedHashMap<>();
         List<Integer> paletteStateIds = new ArrayList<>();
-        List<Integer> indices = new ArrayList<>(4096);
+        int[] indices = new int[4096];
+        int blockIndex = 0;
 
         boolean uniform = true;
         Integer firstStateId = null;
@@ -403,7 +414,7 @@ public class WorldOutbound extends BaseOutbound {
                         return paletteStateIds.size() - 1;
                     });
 
-                    indices.add(paletteIndex);
+                    indices[blockIndex++] = paletteIndex;
                 }
             }
         }
@@ -415,7 +426,15 @@ public class WorldOutbound extends BaseOutbound {
 
         // Only include indices if not uniform
         if (!uniform) {
-            builder.addAllBlockIndices(indices);
+            if (packedIndices) {
+                int bits = Math.max(1, 32 - Integer.numberOfLeadingZeros(paletteStateIds.size() - 1));
+                builder.setBitsPerEntry(bits)
+                    .setPackedBlockIndices(ByteString.copyFrom(packIndices(indices, bits)));
+            } else {
+                for (int index : indices) {
+                    builder.addBlockIndices(index);
+                }
+            }
         }
 
         // Extract biome data (4x4x4 per section, 64 entries, index = y*16 + z*4 + x)
@@ -447,7 +466,15 @@ public class WorldOutbound extends BaseOutbound {
             }
         }
 
-        builder.addAllBiomePalette(biomePaletteList).setBiomeUniform(biomeUniform);
+        for (String biomeId : biomePaletteList) {
+            int ref = connection.stringId(biomeId);
+            if (ref == 0) {
+                builder.addBiomePalette(biomeId);
+            } else {
+                builder.addBiomePaletteRefs(ref);
+            }
+        }
+        builder.setBiomeUniform(biomeUniform);
         if (!biomeUniform) {
             builder.addAllBiomeIndices(biomeIndices);
         }
@@ -465,6 +492,25 @@ public class WorldOutbound extends BaseOutbound {
         return builder.build();
     }
 
+    /**
+     * Packs palette indices into little-endian longs, 64 / bits entries per long from the
+     * low bits up, never spanning two longs (same layout as Minecraft's SimpleBitStorage).
+     */
+    private static byte[] packIndices(int[] indices, int bits) {
+        int perLong = 64 / bits;
+        int longCount = (indices.length + perLong - 1) / perLong;
+        java.nio.ByteBuffer buffer = java.nio.ByteBuffer.allocate(longCount * 8).order(java.nio.ByteOrder.LITTLE_ENDIAN);
+        int i = 0;
+        for (int l = 0; l < longCount; l++) {
+            long word = 0;
+            for (int k = 0; k < perLong && i < indices.length; k++, i++) {
+                word |= ((long) indices[i]) << (k * bits);
+            }
+            buffer.putLong(word);
+        }
+        return buffer.array();
+    }
+
     private static Common.BlockPos toProtoBlockPos(BlockPos pos) {
         return Common.BlockPos.newBuilder()
             .setX(pos.getX())
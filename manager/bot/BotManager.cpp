@@ -8,14 +8,16 @@
 #include "scripting/ScriptEngine.h"
 #include "ui/ScriptsWidget.h"
 #include "scripting/PythonAPI.h"
+#include "world/PackedIndices.h"
 #include <io/stream_reader.h>
 #include <nbt_tags.h>
+#include <algorithm>
+#include <cmath>
 #include <optional>
 #include <sstream>
 #include <QCoreApplication>
 #include <QDateTime>
 #include <QDataStream>
-#include <QUuid>
 #include <QtProtobuf/QProtobufSerializer>
 #include <QNetworkReply>
 #include <QNetworkRequest>
@@ -25,6 +27,9 @@
 #include <QFile>
 #include <QDir>
 #include <QEventLoop>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QtConcurrent/QtConcurrentRun>
 
 static QVariant baritoneProtoToVariant(
     const mankool::mcbot::protocol::BaritoneSettingValue &value,
@@ -567,6 +572,80 @@ static mankool::mcbot::protocol::MeteorSettingValue variantToMeteorProto(
     return protoValue;
 }
 
+namespace {
+
+// Write lock for the world update handlers; a no-op while a WorldWriteBatch holds it.
+// Publishes the world snapshot for lock-free readers before unlocking.
+class WorldWriteLocker
+{
+public:
+    explicit WorldWriteLocker(BotInstance *bot)
+        : bot(bot)
+        , lock(bot->worldWriteBatched ? nullptr : bot->worldDataLock.get())
+    {
+        if (lock) lock->lockForWrite();
+    }
+    ~WorldWriteLocker()
+    {
+        if (!lock) return;
+        bot->worldData.publishSnapshot();
+        lock->unlock();
+    }
+
+    WorldWriteLocker(const WorldWriteLocker&) = delete;
+    WorldWriteLocker& operator=(const WorldWriteLocker&) = delete;
+
+private:
+    BotInstance *bot;
+    QReadWriteLock *lock;
+};
+
+// Server address, or launcher instance and world in singleplayer. Shared savers and chunks are keyed by it.
+QString serverKey(const BotInstance *bot)
+{
+    return bot->isSingleplayer
+        ? (bot->instance.isEmpty() ? "singleplayer" : bot->instance) + "/" + bot->singleplayerWorld
+        : bot->server;
+}
+
+// Adds the current version of a section to `refs` unless it is already listed
+void noteSection(const BotWorldData &world, QVector<SectionRef> &refs, int chunkX, int chunkZ, int sectionY)
+{
+    for (const SectionRef &ref : std::as_const(refs)) {
+        if (ref.chunkX == chunkX && ref.chunkZ == chunkZ && ref.sectionY == sectionY) return;
+    }
+    refs.append(world.sectionRef(chunkX, chunkZ, sectionY));
+}
+
+} // namespace
+
+void WorldWriteBatch::acquire()
+{
+    if (lock) return;
+    bot = BotManager::getBotByConnectionId(connectionId);
+    if (!bot) return;
+    lock = bot->worldDataLock;
+    lock->lockForWrite();
+    bot->worldWriteBatched = true;
+}
+
+void WorldWriteBatch::release()
+{
+    if (!lock) return;
+    bot->worldWriteBatched = false;
+    bot->worldData.publishSnapshot();
+    lock->unlock();
+    lock.reset();
+    bot = nullptr;
+}
+
+const quint32 BotManager::kSupportedProtocolFeatures =
+    static_cast<quint32>(mankool::mcbot::protocol::ProtocolFeatureGadget::ProtocolFeature::TICK_BATCH)
+    | static_cast<quint32>(mankool::mcbot::protocol::ProtocolFeatureGadget::ProtocolFeature::PACKED_BLOCK_INDICES)
+    | static_cast<quint32>(mankool::mcbot::protocol::ProtocolFeatureGadget::ProtocolFeature::ENTITY_DELTAS)
+    | static_cast<quint32>(mankool::mcbot::protocol::ProtocolFeatureGadget::ProtocolFeature::STRING_DICTIONARY)
+    | static_cast<quint32>(mankool::mcbot::protocol::ProtocolFeatureGadget::ProtocolFeature::HEARTBEAT_ACK);
+
 BotManager::BotManager(QObject *parent)
     : QObject(parent)
 {
@@ -590,12 +669,30 @@ BotInstance* BotManager::getBotByConnectionId(int connectionId)
 
 BotInstance* BotManager::getBotByConnectionIdImpl(int connectionId)
 {
-    for (BotInstance *bot : std::as_const(botInstances)) {
-        if (bot->connectionId == connectionId) {
-            return bot;
-        }
+    auto it = botsByConnectionId.find(connectionId);
+    if (it == botsByConnectionId.end()) {
+        return nullptr;
     }
-    return nullptr;
+    // connectionId is reset elsewhere when a bot goes offline; drop stale entries lazily
+    if ((*it)->connectionId != connectionId) {
+        botsByConnectionId.erase(it);
+        return nullptr;
+    }
+    return *it;
+}
+
+void BotManager::clearConnectionId(BotInstance *bot)
+{
+    instance().clearConnectionIdImpl(bot);
+}
+
+void BotManager::clearConnectionIdImpl(BotInstance *bot)
+{
+    if (!bot) return;
+    if (botsByConnectionId.value(bot->connectionId) == bot) {
+        botsByConnectionId.remove(bot->connectionId);
+    }
+    bot->connectionId = -1;
 }
 
 BotInstance* BotManager::getBotByName(const QString &name)
@@ -615,24 +712,102 @@ BotInstance* BotManager::getBotByNameImpl(const QString &name)
 
 bool BotManager::sendOutboundMessage(int connectionId, mankool::mcbot::protocol::ManagerToClientMessage &msg, bool silent, const QString &messageId)
 {
-    QString id = messageId.isEmpty() ? QUuid::createUuid().toString(QUuid::WithoutBraces) : messageId;
+    QString id = messageId.isEmpty() ? nextMessageId() : messageId;
     msg.setMessageId(id);
     msg.setTimestamp(QDateTime::currentMSecsSinceEpoch());
     if (silent)
-        silentMessageIds.insert(id);
-    QProtobufSerializer serializer;
-    QByteArray protoData = serializer.serialize(&msg);
-    if (protoData.isEmpty()) {
-        LogManager::log("Failed to serialize outbound message", LogManager::Error);
-        return false;
-    }
-    QByteArray packet;
-    QDataStream stream(&packet, QIODevice::WriteOnly);
-    stream.setByteOrder(QDataStream::LittleEndian);
-    stream << static_cast<quint32>(protoData.size());
-    packet.append(protoData);
-    PipeServer::sendToClient(connectionId, packet);
-    return true;
+        markSilent(id);
+    return PipeServer::sendMessage(connectionId, msg);
+}
+
+QString BotManager::nextMessageId()
+{
+    return QString::number(m_nextMessageId.fetch_add(1, std::memory_order_relaxed));
+}
+
+PendingReply BotManager::sendRequest(BotInstance *bot, mankool::mcbot::protocol::ManagerToClientMessage &msg, int timeoutMs,
+                                     PendingRequestTable::CompletionHook onComplete)
+{
+    // Registered before sending so a fast response can't arrive ahead of its entry
+    const quint64 id = m_nextMessageId.fetch_add(1, std::memory_order_relaxed);
+    const int connectionId = bot->connectionId;
+    PendingReply reply = m_pendingRequests.add(id, connectionId, timeoutMs, std::move(onComplete));
+    if (!sendOutboundMessage(connectionId, msg, false, QString::number(id))) {
+        m_pendingRequests.fail(id, PendingReply::Status::SendFailed);
+    }
+    return reply;
+}
+
+void BotManager::completeRequest(int connectionId, const QString &commandId, const QVariant &value)
+{
+    bool ok = false;
+    const quint64 id = commandId.toULongLong(&ok);
+    if (ok) {
+        m_pendingRequests.complete(id, connectionId, value);
+    }
+}
+
+void BotManager::failPendingRequests(int connectionId)
+{
+    instance().m_pendingRequests.failConnection(connectionId);
+}
+
+// Resolves a dictionary reference if the client sent one, otherwise interns the inline string
+static QString sessionString(const BotInstance *bot, quint32 ref, const QString &inlineValue)
+{
+    return ref != 0 ? bot->sessionStrings.resolve(ref) : StringInterner::intern(inlineValue);
+}
+
+void BotManager::sendProtocolFeatures(BotInstance *bot, quint32 requested)
+{
+    // Clients that predate negotiation send no flags and never see anything but plain frames
+    bot->protocolFeatures = requested & kSupportedProtocolFeatures;
+    bot->sessionStrings.clear();
+
+    mankool::mcbot::protocol::ProtocolFeatures features;
+    features.setFeatureFlags(bot->protocolFeatures);
+
+    mankool::mcbot::protocol::ManagerToClientMessage msg;
+    msg.setProtocolFeatures(features);
+    sendOutboundMessage(bot->connectionId, msg);
+
+    if (bot->debugLogging) {
+        LogManager::log(QString("[%1] Protocol features: requested 0x%2, enabled 0x%3")
+                       .arg(bot->name)
+                       .arg(requested, 0, 16)
+                       .arg(bot->protocolFeatures, 0, 16),
+                       LogManager::Debug);
+    }
+}
+
+void BotManager::markSilent(const QString &messageId)
+{
+    bool ok = false;
+    quint64 id = messageId.toULongLong(&ok);
+    if (!ok) return;
+
+    qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QMutexLocker lock(&m_silentIdsMutex);
+    // Expire from the front: entries are in insertion order, so deadlines are too
+    while (!m_silentIdOrder.isEmpty() &&
+           (m_silentIdOrder.head().second <= now || m_silentIdOrder.size() >= kMaxSilentIds)) {
+        QPair<quint64, qint64> oldest = m_silentIdOrder.dequeue();
+        auto it = m_silentIdDeadlines.find(oldest.first);
+        if (it != m_silentIdDeadlines.end() && *it == oldest.second)
+            m_silentIdDeadlines.erase(it);
+    }
+    m_silentIdDeadlines.insert(id, now + kSilentIdTtlMs);
+    m_silentIdOrder.enqueue({id, now + kSilentIdTtlMs});
+}
+
+bool BotManager::takeSilent(const QString &messageId)
+{
+    bool ok = false;
+    quint64 id = messageId.toULongLong(&ok);
+    if (!ok) return false;
+
+    QMutexLocker lock(&m_silentIdsMutex);
+    return m_silentIdDeadlines.remove(id) > 0;
 }
 
 void BotManager::tryInitializeWorldAutoSaver(BotInstance* bot)
@@ -655,9 +830,7 @@ void BotManager::tryInitializeWorldAutoSaver(BotInstance* bot)
         return;
     }
 
-    const QString saveKey = bot->isSingleplayer
-        ? (bot->instance.isEmpty() ? "singleplayer" : bot->instance) + "/" + bot->singleplayerWorld
-        : bot->server;
+    const QString saveKey = serverKey(bot);
 
     // Check if already using the correct saver
     if (bot->worldAutoSaver && bot->worldAutoSaverServerIp == saveKey) {
@@ -717,14 +890,14 @@ void BotManager::tryInitializeWorldAutoSaver(BotInstance* bot)
 
         // Chunk provider searches all bots sharing this save key
         saver->setChunkProvider([saveKey, this](int cx, int cz, const QString& dim)
-            -> std::optional<std::pair<ChunkData, QVector<BlockEntityData>>> {
+            -> std::optional<std::pair<std::shared_ptr<const ChunkData>, QVector<BlockEntityData>>> {
             for (auto* b : std::as_const(botInstances)) {
                 if (b->worldAutoSaverServerIp != saveKey) continue;
                 QReadLocker locker(b->worldDataLock.get());
                 const ChunkData* chunk = b->worldData.getChunk(cx, cz);
                 if (!chunk) continue;
                 auto bes = b->worldData.getBlockEntitiesInChunk(cx, cz, dim);
-                return std::make_pair(*chunk, bes);
+                return std::make_pair(std::make_shared<const ChunkData>(*chunk), bes);
             }
             return std::nullopt;
         });
@@ -742,7 +915,7 @@ void BotManager::tryInitializeWorldAutoSaver(BotInstance* bot)
             QVector<BlockEntityData> earlyBEs;
             {
                 QReadLocker locker(bot->worldDataLock.get());
-                earlyBEs = bot->worldData.getBlockEntitiesInChunk(earlyChunk.chunkX, earlyChunk.chunkZ, earlyChunk.dimension);
+                earlyBEs = bot->worldData.getBlockEntitiesInChunk(earlyChunk->chunkX, earlyChunk->chunkZ, earlyChunk->dimension);
             }
             bot->worldAutoSaver->saveChunkAsync(earlyChunk, earlyBEs);
         }
@@ -796,6 +969,14 @@ void BotManager::removeBotImpl(const QString &name)
                 botInstances[i]->debugWidget = nullptr;
             }
 
+            PipeServer::unbindBot(botInstances[i]);
+            m_sharedWorld.releaseAll(botInstances[i]);
+            // By value: entries left behind by an earlier connection id must not outlive the bot
+            BotInstance *removed = botInstances[i];
+            botsByConnectionId.removeIf([removed](QHash<int, BotInstance*>::iterator it) {
+                return it.value() == removed;
+            });
+
             QString serverKey = botInstances[i]->worldAutoSaverServerIp;
             delete botInstances[i];
             botInstances.removeAt(i);
@@ -861,9 +1042,25 @@ void BotManager::handleConnectionInfoImpl(int connectionId, const mankool::mcbot
             break;
         }
     }
+    if (!bot && acceptUnlaunchedClients) {
+        bot = findUnlaunchedBot(playerName, playerUuid);
+        if (!bot && createTestBots && !playerName.isEmpty()) {
+            BotConfig config;
+            config.name = playerName;
+            config.accountId = playerUuid;
+            config.autoConnect = false;
+            config.autoRestart = false;
+            config.tokenRefresh = false;
+            config.saveWorldToDisk = false;
+            addBotImpl(config);
+            bot = botInstances.last();
+            bot->testBot = true;
+        }
+    }
 
     if (bot) {
         bot->connectionId = connectionId;
+        botsByConnectionId.insert(connectionId, bot);
         bot->status = BotStatus::Online;
         bot->minecraftPid = info.processId();
         bot->startTime = QDateTime::currentDateTime();
@@ -893,6 +1090,9 @@ void BotManager::handleConnectionInfoImpl(int connectionId, const mankool::mcbot
 
         emit botUpdated(bot->name);
 
+        sendProtocolFeatures(bot, info.featureFlags());
+        bot->reachCache->clear();
+
         // Send proxy config immediately so it's applied before any server connection
         sendProxyConfig(bot->name);
 
@@ -908,6 +1108,51 @@ void BotManager::handleConnectionInfoImpl(int connectionId, const mankool::mcbot
     }
 }
 
+BotInstance* BotManager::findUnlaunchedBot(const QString &playerName, const QString &playerUuid) const
+{
+    const QString uuid = QString(playerUuid).remove('-');
+    for (BotInstance *b : botInstances) {
+        if (b->status == BotStatus::Offline && !uuid.isEmpty() && QString(b->accountId).remove('-') == uuid) {
+            return b;
+        }
+    }
+    for (BotInstance *b : botInstances) {
+        if (b->status == BotStatus::Offline && b->name == playerName) {
+            return b;
+        }
+    }
+    return nullptr;
+}
+
+void BotManager::setAcceptUnlaunchedClients(bool accept)
+{
+    instance().acceptUnlaunchedClients = accept;
+}
+
+bool BotManager::acceptsUnlaunchedClients()
+{
+    return instance().acceptUnlaunchedClients;
+}
+
+void BotManager::setCreateTestBots(bool create)
+{
+    instance().createTestBots = create;
+}
+
+void BotManager::setShareWorldData(bool share)
+{
+    instance().shareWorldData = share;
+}
+
+void BotManager::setRetainedChunkBudget(qint64 bytes)
+{
+    BotManager &manager = instance();
+    manager.retainedChunkBudget = static_cast<size_t>(std::max<qint64>(0, bytes));
+    for (BotInstance *bot : std::as_const(manager.botInstances)) {
+        manager.trimRetainedChunks(bot);
+    }
+}
+
 void BotManager::handleServerStatus(int connectionId, const mankool::mcbot::protocol::ServerConnectionStatus &status)
 {
     instance().handleServerStatusImpl(connectionId, status);
@@ -964,9 +1209,10 @@ void BotManager::handleServerStatusImpl(int connectionId, const mankool::mcbot::
             }
 
             {
-                QWriteLocker locker(bot->worldDataLock.get());
+                WorldWriteLocker locker(bot);
                 bot->worldData.clearWorldState();
             }
+            m_sharedWorld.releaseAll(bot);
 
             QMutexLocker tabLocker(bot->dataMutex.get());
             bot->tabList.clear();
@@ -999,11 +1245,28 @@ void BotManager::handlePlayerStateImpl(int connectionId, const mankool::mcbot::p
             bot->playerUuid = state.uuid();
         }
         if (state.hasPosition()) {
-            bot->position = QVector3D(state.position().x(), state.position().y(), state.position().z());
+            QVector3D position(state.position().x(), state.position().y(), state.position().z());
+            bool moved = position != bot->position;
+            bot->position = position;
+            // After the store, so a query that sees the new move generation also sees the new position
+            if (moved) {
+                bot->reachCache->botMoved();
+            }
         }
         bot->yaw   = state.yaw();
         bot->pitch = state.pitch();
         if (!state.dimension().isEmpty()) {
+            if (state.dimension() != bot->dimension) {
+                bot->reachCache->clear();
+                if (shareWorldData) {
+                    m_sharedWorld.releaseAll(bot, sharedWorldKey(bot, state.dimension()));
+                }
+                {
+                    WorldWriteLocker locker(bot);
+                    bot->worldData.setCurrentDimension(state.dimension());
+                }
+                trimRetainedChunks(bot);
+            }
             bot->dimension = state.dimension();
         }
 
@@ -1249,7 +1512,7 @@ void BotManager::handleCommandResponseImpl(int connectionId, const mankool::mcbo
     BotInstance *bot = getBotByConnectionIdImpl(connectionId);
     if (!bot) return;
 
-    bool isSilent = silentMessageIds.remove(response.commandId());
+    bool isSilent = takeSilent(response.commandId());
 
     QString statusText;
     bool success = false;
@@ -1324,7 +1587,7 @@ void BotManager::handleModulesResponseImpl(int connectionId, const mankool::mcbo
         bot->meteorModules.insert(moduleData.name, moduleData);
     }
 
-    silentMessageIds.remove(response.requestId());
+    takeSilent(response.requestId());
 
     LogManager::log(QString("[%1] Received %2 Meteor modules").arg(bot->name).arg(response.modules().size()), LogManager::Info);
 
@@ -1408,7 +1671,7 @@ void BotManager::handleModuleConfigResponseImpl(int connectionId, const mankool:
         output = QString("Error: %1").arg(response.errorMessage());
     }
 
-    bool isSilent = silentMessageIds.remove(response.requestId());
+    bool isSilent = takeSilent(response.requestId());
 
     if (!isSilent) {
         if (bot->consoleWidget) {
@@ -1785,6 +2048,9 @@ void BotManager::handleHeartbeatImpl(int connectionId, const mankool::mcbot::pro
             }
         }
 
+        bot->clientControlQueueDepth = static_cast<int>(heartbeat.controlQueueDepth());
+        bot->clientBulkQueueDepth = static_cast<int>(heartbeat.bulkQueueDepth());
+
         if (bot->debugLogging) {
             LogManager::log(QString("[%1] Heartbeat received").arg(bot->name), LogManager::Debug);
         }
@@ -2056,6 +2322,7 @@ void BotManager::handleQueryRegistryImpl(int connectionId, const mankool::mcbot:
     if (haveCached) {
         bot->blockRegistry = std::make_shared<BlockRegistry>();
         if (bot->blockRegistry->loadFromCache(dataVersion)) {
+            bot->worldData.setBlockRegistry(bot->blockRegistry);
             LogManager::log(QString("[%1] Loaded block registry from cache for data version %2")
                            .arg(bot->name).arg(dataVersion), LogManager::Success);
         } else {
@@ -2115,6 +2382,8 @@ void BotManager::handleBlockRegistryImpl(int connectionId, const mankool::mcbot:
         bot->blockRegistry->setFaceMask(static_cast<uint32_t>(it.key()), static_cast<uint8_t>(it.value()));
     }
 
+    bot->worldData.setBlockRegistry(bot->blockRegistry);
+
     // Save to cache
     bot->blockRegistry->saveToCache();
 
@@ -2393,6 +2662,97 @@ void BotManager::sendProxyConfig(const QString &botName)
 // World Data Handlers
 // ============================================================================
 
+namespace {
+
+void decodeChunkSections(const BotInstance *bot, const mankool::mcbot::protocol::ChunkDataMessage &chunkData,
+                         ChunkData &chunk)
+{
+    for (const auto &sectionProto : chunkData.sections()) {
+        const int sectionY = sectionProto.sectionY();
+        auto section = std::make_shared<ChunkSection>();
+        section->uniform = sectionProto.uniform();
+
+        // Palette entries stay global state ids; names are resolved when read
+        section->palette = sectionProto.palette();
+
+        // Indices (only if not uniform). Packed ones are kept exactly as they arrived.
+        if (!section->uniform) {
+            const QByteArray &packed = sectionProto.packedBlockIndices();
+            const int bits = static_cast<int>(sectionProto.bitsPerEntry());
+            if (!packed.isEmpty()) {
+                if (bits >= 1 && bits <= 32 && packed.size() >= PackedIndices::packedSize(4096, bits)) {
+                    section->packedIndices = packed;
+                    section->bitsPerEntry = bits;
+                } else {
+                    LogManager::log(QString("[%1] Malformed packed indices in chunk (%2, %3) section %4 (%5 bits, %6 bytes)")
+                                   .arg(bot->name).arg(chunk.chunkX).arg(chunk.chunkZ).arg(sectionY)
+                                   .arg(bits).arg(packed.size()), LogManager::Warning);
+                    section->uniform = true;  // Every block reads as palette[0]
+                }
+            } else {
+                std::vector<uint32_t> indices(4096, 0);
+                const auto &blockIndices = sectionProto.blockIndices();
+                std::copy_n(blockIndices.begin(), std::min<qsizetype>(blockIndices.size(), 4096), indices.begin());
+                section->setIndices(indices.data());
+            }
+        }
+
+        // Copy biome data
+        section->biomeUniform = sectionProto.biomeUniform();
+        if (!sectionProto.biomePaletteRefs().isEmpty()) {
+            for (uint32_t ref : sectionProto.biomePaletteRefs()) {
+                section->biomePalette.append(StringInterner::idFor(bot->sessionStrings.resolve(ref)));
+            }
+        } else {
+            for (const auto& biomeId : sectionProto.biomePalette()) {
+                section->biomePalette.append(StringInterner::idFor(biomeId));
+            }
+        }
+        if (!section->biomeUniform) {
+            for (uint32_t idx : sectionProto.biomeIndices()) {
+                section->biomeIndices.append(static_cast<char>(idx));
+            }
+        }
+
+        // Light data; all-dark and all-bright arrays are shared
+        section->blockLight = sectionProto.blockLight();
+        section->skyLight = sectionProto.skyLight();
+        ChunkSection::shareLight(section->blockLight);
+        ChunkSection::shareLight(section->skyLight);
+
+        chunk.setSection(sectionY, ChunkSection::shareUniform(std::move(section)));
+    }
+}
+
+// Identifies a chunk message's content for SharedWorldStore. Biome refs only mean
+// something within one connection, so the names they stand for are hashed instead.
+quint64 chunkContentHash(const BotInstance *bot, const mankool::mcbot::protocol::ChunkDataMessage &chunkData)
+{
+    size_t hash = qHashMulti(0, int(chunkData.minY()), int(chunkData.maxY()), chunkData.sections().size());
+    for (const auto &section : chunkData.sections()) {
+        hash = qHashMulti(hash, int(section.sectionY()), section.uniform(), quint32(section.bitsPerEntry()),
+                          section.biomeUniform());
+        hash = qHashBits(section.palette().constData(), section.palette().size() * sizeof(uint32_t), hash);
+        hash = qHashBits(section.blockIndices().constData(), section.blockIndices().size() * sizeof(uint32_t), hash);
+        hash = qHash(section.packedBlockIndices(), hash);
+        if (!section.biomePaletteRefs().isEmpty()) {
+            for (uint32_t ref : section.biomePaletteRefs()) {
+                hash = qHash(bot->sessionStrings.resolve(ref), hash);
+            }
+        } else {
+            for (const QString &biome : section.biomePalette()) {
+                hash = qHash(biome, hash);
+            }
+        }
+        hash = qHashBits(section.biomeIndices().constData(), section.biomeIndices().size() * sizeof(uint32_t), hash);
+        hash = qHash(section.blockLight(), hash);
+        hash = qHash(section.skyLight(), hash);
+    }
+    return hash;
+}
+
+} // namespace
+
 void BotManager::handleChunkData(int connectionId, const mankool::mcbot::protocol::ChunkDataMessage &chunkData)
 {
     instance().handleChunkDataImpl(connectionId, chunkData);
@@ -2410,112 +2770,90 @@ void BotManager::handleChunkDataImpl(int connectionId, const mankool::mcbot::pro
         return;
     }
 
-    // Convert protobuf message to ChunkData
-    ChunkData chunk;
-    chunk.chunkX = chunkData.chunkX();
-    chunk.chunkZ = chunkData.chunkZ();
-    chunk.dimension = chunkData.dimension();
-    chunk.minY = chunkData.minY();
-    chunk.maxY = chunkData.maxY();
-
-    // Convert sections
-    for (const auto &sectionProto : chunkData.sections()) {
-        ChunkSection section;
-        section.sectionY = sectionProto.sectionY();
-        section.uniform = sectionProto.uniform();
-
-        // Convert palette from IDs to strings using block registry
-        for (uint32_t stateId : sectionProto.palette()) {
-            auto blockState = bot->blockRegistry->getBlockState(stateId);
-            if (!blockState) {
-                LogManager::log(QString("[%1] Unknown block state ID %2 in chunk palette, defaulting to air")
-                               .arg(bot->name).arg(stateId), LogManager::Warning);
-                section.palette.append("minecraft:air");
-            } else {
-                section.palette.append(*blockState);
-            }
-        }
-
-        // Copy indices (only if not uniform)
-        if (!section.uniform) {
-            for (uint32_t index : sectionProto.blockIndices()) {
-                section.blockIndices.append(index);
-            }
-        }
+    const QString dimension = sessionString(bot, chunkData.dimensionRef(), chunkData.dimension());
+    const ChunkPos pos(chunkData.chunkX(), chunkData.chunkZ());
+    const QString worldKey = sharedWorldKey(bot, dimension);
+    quint64 contentHash = 0;
+    std::optional<ChunkData> shared;
+    if (!worldKey.isEmpty()) {
+        contentHash = chunkContentHash(bot, chunkData);
+        shared = m_sharedWorld.acquire(worldKey, pos, contentHash, bot);
+    }
 
-        // Copy biome data
-        section.biomeUniform = sectionProto.biomeUniform();
-        for (const auto& biomeId : sectionProto.biomePalette()) {
-            section.biomePalette.append(biomeId);
+    // Convert protobuf message to ChunkData, unless another bot already has
+    ChunkData decoded;
+    if (shared) {
+        decoded = std::move(*shared);
+    } else {
+        decoded.chunkX = pos.x;
+        decoded.chunkZ = pos.z;
+        decoded.dimension = dimension;
+        decoded.minY = chunkData.minY();
+        decoded.maxY = chunkData.maxY();
+        decoded.blockRegistry = bot->blockRegistry;
+        decodeChunkSections(bot, chunkData, decoded);
+        if (!worldKey.isEmpty()) {
+            m_sharedWorld.publish(worldKey, decoded, contentHash, bot);
         }
-        if (!section.biomeUniform) {
-            for (uint32_t idx : sectionProto.biomeIndices()) {
-                section.biomeIndices.append(idx);
+    }
+    // Frozen from here on; world data and the saver share this one instance
+    const std::shared_ptr<const ChunkData> chunk = std::make_shared<const ChunkData>(std::move(decoded));
+
+    bot->reachCache->invalidateColumn(chunk->chunkX, chunk->chunkZ);
+
+    // Parse block entity NBT before taking the write lock, so readers aren't held up by it
+    QVector<BlockEntityData> parsedBEs;
+    for (const QByteArray& beBytes : chunkData.blockEntityNbt()) {
+        if (beBytes.isEmpty()) continue;
+        try {
+            std::istringstream ss(std::string(beBytes.constData(), beBytes.size()), std::ios::binary);
+            nbt::io::stream_reader reader(ss);
+            auto tagPtr = reader.read_payload(nbt::tag_type::Compound);
+            auto& compound = static_cast<nbt::tag_compound&>(*tagPtr);
+
+            BlockEntityData be;
+            be.x = compound.has_key("x") ? static_cast<nbt::tag_int&>(compound.at("x").get()).get() : 0;
+            be.y = compound.has_key("y") ? static_cast<nbt::tag_int&>(compound.at("y").get()).get() : 0;
+            be.z = compound.has_key("z") ? static_cast<nbt::tag_int&>(compound.at("z").get()).get() : 0;
+            if (compound.has_key("id")) {
+                be.type = QString::fromStdString(static_cast<nbt::tag_string&>(compound.at("id").get()).get());
             }
-        }
-
-        // Copy light data
-        const auto& bl = sectionProto.blockLight();
-        if (!bl.isEmpty()) {
-            section.blockLight = QByteArray(bl.data(), bl.size());
-        }
-        const auto& sl = sectionProto.skyLight();
-        if (!sl.isEmpty()) {
-            section.skyLight = QByteArray(sl.data(), sl.size());
-        }
-
-        chunk.sections[section.sectionY] = section;
+            be.dimension = chunk->dimension;
+            be.rawNbt = beBytes;
+            parsedBEs.append(std::move(be));
+        } catch (...) {}
     }
 
-    // Load chunk into world data (with write lock), also parse and store block entities
+    // Load chunk into world data (with write lock) and store its block entities
     QVector<BlockEntityData> chunkBlockEntities;
     {
-        QWriteLocker locker(bot->worldDataLock.get());
-        bot->worldData.loadChunk(chunk);
+        WorldWriteLocker locker(bot);
+        bot->worldData.loadChunk(*chunk);
 
         // Snapshot existing block entities for this chunk before modifying worldData:
         // used to preserve item data for containers opened earlier this session,
         // and to detect broken blocks (zombie cleanup).
-        auto existingBEs = bot->worldData.getBlockEntitiesInChunk(chunk.chunkX, chunk.chunkZ, chunk.dimension);
+        auto existingBEs = bot->worldData.getBlockEntitiesInChunk(chunk->chunkX, chunk->chunkZ, chunk->dimension);
         QHash<BlockEntityPos, BlockEntityData> existingMap;
         for (const auto& e : std::as_const(existingBEs)) {
             existingMap[{e.dimension, e.x, e.y, e.z}] = e;
         }
 
-        // Parse all block entity NBT from chunk and update worldData.
         QSet<BlockEntityPos> rawNbtPositions;
-        for (const QByteArray& beBytes : chunkData.blockEntityNbt()) {
-            if (beBytes.isEmpty()) continue;
-            try {
-                std::istringstream ss(std::string(beBytes.constData(), beBytes.size()), std::ios::binary);
-                nbt::io::stream_reader reader(ss);
-                auto tagPtr = reader.read_payload(nbt::tag_type::Compound);
-                auto& compound = static_cast<nbt::tag_compound&>(*tagPtr);
-
-                BlockEntityData be;
-                be.x = compound.has_key("x") ? static_cast<nbt::tag_int&>(compound.at("x").get()).get() : 0;
-                be.y = compound.has_key("y") ? static_cast<nbt::tag_int&>(compound.at("y").get()).get() : 0;
-                be.z = compound.has_key("z") ? static_cast<nbt::tag_int&>(compound.at("z").get()).get() : 0;
-                if (compound.has_key("id")) {
-                    be.type = QString::fromStdString(static_cast<nbt::tag_string&>(compound.at("id").get()).get());
-                }
-                be.dimension = chunkData.dimension();
-
-                BlockEntityPos posKey{be.dimension, be.x, be.y, be.z};
-                rawNbtPositions.insert(posKey);
-
-                // If we already have items for this block entity (container opened earlier this
-                // session), preserve them. The server never sends container contents in chunk data.
-                auto existingIt = existingMap.find(posKey);
-                if (existingIt != existingMap.end() && !existingIt->items.isEmpty()) {
-                    be.items = existingIt->items;
-                    // rawNbt stays empty so the structured items path is used in serialization
-                } else {
-                    be.rawNbt = beBytes;  // No known items; processChunk will check disk
-                }
+        for (BlockEntityData& be : parsedBEs) {
+            BlockEntityPos posKey{be.dimension, be.x, be.y, be.z};
+            rawNbtPositions.insert(posKey);
+
+            // If we already have items for this block entity (container opened earlier this
+            // session), preserve them. The server never sends container contents in chunk data.
+            auto existingIt = existingMap.find(posKey);
+            if (existingIt != existingMap.end() && !existingIt->items.isEmpty()) {
+                be.items = existingIt->items;
+                be.rawNbt.clear();  // The structured items path is used in serialization
+            }
+            // Otherwise rawNbt stays; processChunk will check disk for known items
 
-                bot->worldData.updateBlockEntity(be);
-            } catch (...) {}
+            bot->worldData.updateBlockEntity(be);
         }
 
         // Zombie cleanup: remove worldData entries for this chunk that the server no longer
@@ -2528,7 +2866,7 @@ void BotManager::handleChunkDataImpl(int connectionId, const mankool::mcbot::pro
 
         // Collect block entities for this chunk to pass to the saver
         if (bot->saveWorldToDisk) {
-            chunkBlockEntities = bot->worldData.getBlockEntitiesInChunk(chunk.chunkX, chunk.chunkZ, chunk.dimension);
+            chunkBlockEntities = bot->worldData.getBlockEntitiesInChunk(chunk->chunkX, chunk->chunkZ, chunk->dimension);
         }
     }
 
@@ -2544,16 +2882,16 @@ void BotManager::handleChunkDataImpl(int connectionId, const mankool::mcbot::pro
     if (bot->debugLogging) {
         LogManager::log(QString("[%1] Loaded chunk (%2, %3) with %4 sections")
                        .arg(bot->name)
-                       .arg(chunk.chunkX)
-                       .arg(chunk.chunkZ)
-                       .arg(chunk.sections.size()),
+                       .arg(chunk->chunkX)
+                       .arg(chunk->chunkZ)
+                       .arg(chunk->sectionCount()),
                        LogManager::Debug);
     }
 
     // Fire script event
     if (bot->scriptEngine) {
         QVariantList args;
-        args << chunk.chunkX << chunk.chunkZ << chunk.dimension;
+        args << chunk->chunkX << chunk->chunkZ << chunk->dimension;
         bot->scriptEngine->fireEvent("chunk_loaded", args);
     }
 }
@@ -2587,10 +2925,17 @@ void BotManager::handleBlockUpdateImpl(int connectionId, const mankool::mcbot::p
                        .arg(bot->name).arg(stateId), LogManager::Warning);
     }
 
+    QVector<SectionRef> before;
     {
-        QWriteLocker locker(bot->worldDataLock.get());
-        bot->worldData.setBlock(x, y, z, blockStr);
+        WorldWriteLocker locker(bot);
+        if (shareWorldData) {
+            before.append(bot->worldData.sectionRef(x >> 4, z >> 4, y >> 4));
+        }
+        bot->worldData.setStateId(x, y, z, blockState ? stateId : BlockRegistry::AIR_STATE_ID);
     }
+    shareSectionEdits(bot, before);
+    bot->reachCache->invalidateBlock(x, y, z);
+    scheduleSectionCompaction(bot);
 
     if (bot->saveWorldToDisk && bot->worldAutoSaver) {
         bot->worldAutoSaver->markBlockChunkDirty(x >> 4, z >> 4, bot->dimension);
@@ -2631,22 +2976,37 @@ void BotManager::handleMultiBlockUpdateImpl(int connectionId, const mankool::mcb
 
     int updateCount = qMin(multiBlockUpdate.positions().size(), multiBlockUpdate.stateIds().size());
 
+    // Same as handleBlockUpdateImpl: unknown ids are stored as air
+    QVector<uint32_t> stateIds;
+    stateIds.reserve(updateCount);
+    for (int i = 0; i < updateCount; ++i) {
+        uint32_t stateId = multiBlockUpdate.stateIds()[i];
+        if (!bot->blockRegistry->getBlockState(stateId)) {
+            LogManager::log(QString("[%1] Unknown block state ID %2 in multi-block update, defaulting to air")
+                           .arg(bot->name).arg(stateId), LogManager::Warning);
+            stateId = BlockRegistry::AIR_STATE_ID;
+        }
+        stateIds.append(stateId);
+    }
+
+    QVector<SectionRef> before;
     {
-        QWriteLocker locker(bot->worldDataLock.get());
+        WorldWriteLocker locker(bot);
         for (int i = 0; i < updateCount; ++i) {
             const auto &pos = multiBlockUpdate.positions()[i];
-            uint32_t stateId = multiBlockUpdate.stateIds()[i];
-            auto blockState = bot->blockRegistry->getBlockState(stateId);
-
-            if (!blockState) {
-                LogManager::log(QString("[%1] Unknown block state ID %2 in multi-block update, defaulting to air")
-                               .arg(bot->name).arg(stateId), LogManager::Warning);
-                bot->worldData.setBlock(pos.x(), pos.y(), pos.z(), "minecraft:air");
-            } else {
-                bot->worldData.setBlock(pos.x(), pos.y(), pos.z(), *blockState);
+            if (shareWorldData) {
+                noteSection(bot->worldData, before, pos.x() >> 4, pos.z() >> 4, pos.y() >> 4);
             }
+            bot->worldData.setStateId(pos.x(), pos.y(), pos.z(), stateIds[i]);
         }
     }
+    shareSectionEdits(bot, before);
+
+    for (int i = 0; i < updateCount; ++i) {
+        const auto &pos = multiBlockUpdate.positions()[i];
+        bot->reachCache->invalidateBlock(pos.x(), pos.y(), pos.z());
+    }
+    scheduleSectionCompaction(bot);
 
     if (bot->saveWorldToDisk && bot->worldAutoSaver) {
         for (int i = 0; i < updateCount; ++i) {
@@ -2670,6 +3030,159 @@ void BotManager::handleMultiBlockUpdateImpl(int connectionId, const mankool::mcb
     }
 }
 
+void BotManager::scheduleSectionCompaction(BotInstance *bot)
+{
+    if (bot->sectionCompactionScheduled) return;
+    bot->sectionCompactionScheduled = true;
+
+    QString botName = bot->name;
+    QTimer::singleShot(kSectionCompactionDelayMs, this, [this, botName]() {
+        compactEditedSections(botName);
+    });
+}
+
+void BotManager::compactEditedSections(const QString &botName)
+{
+    BotInstance *bot = getBotByNameImpl(botName);
+    if (!bot) return;
+    bot->sectionCompactionScheduled = false;
+
+    QVector<SectionRef> edited;
+    {
+        WorldWriteLocker locker(bot);
+        edited = bot->worldData.takeEditedSections();
+    }
+    if (edited.isEmpty()) return;
+
+    // The refs keep these versions alive and make any further edit copy the section,
+    // so the worker reads them without the lock
+    using Compacted = QVector<QPair<SectionRef, std::shared_ptr<const ChunkSection>>>;
+    QFuture<Compacted> future = QtConcurrent::run([edited]() {
+        Compacted result;
+        for (const SectionRef &ref : edited) {
+            if (auto section = ref.section->compacted()) {
+                result.append({ref, std::move(section)});
+            }
+        }
+        return result;
+    });
+
+    auto *watcher = new QFutureWatcher<Compacted>(this);
+    connect(watcher, &QFutureWatcher<Compacted>::finished, this, [this, watcher, botName]() {
+        Compacted compacted = watcher->result();
+        watcher->deleteLater();
+
+        BotInstance *bot = getBotByNameImpl(botName);
+        if (!bot || compacted.isEmpty()) return;
+
+        QVector<SectionRef> replaced;
+        {
+            WorldWriteLocker locker(bot);
+            for (const auto &entry : std::as_const(compacted)) {
+                if (bot->worldData.replaceSection(entry.first, entry.second)) {
+                    replaced.append(entry.first);
+                }
+            }
+        }
+        shareSectionEdits(bot, replaced);
+        if (bot->debugLogging) {
+            LogManager::log(QString("[%1] Compacted %2 edited chunk sections").arg(bot->name).arg(replaced.size()),
+                            LogManager::Debug);
+        }
+    });
+    watcher->setFuture(future);
+}
+
+QString BotManager::sharedWorldKey(const BotInstance *bot, const QString &dimension) const
+{
+    if (!shareWorldData || bot->dataVersion == 0) return QString();
+    const bool hasTarget = bot->isSingleplayer ? !bot->singleplayerWorld.isEmpty() : !bot->server.isEmpty();
+    if (!hasTarget) return QString();
+    // State ids differ between versions, so bots on different ones don't share
+    return serverKey(bot) + '|' + QString::number(bot->dataVersion) + '|' + dimension;
+}
+
+void BotManager::shareSectionEdits(BotInstance *bot, const QVector<SectionRef> &before)
+{
+    // Reads the bot's own world without its lock: only this (GUI) thread writes to it
+    for (const SectionRef &ref : before) {
+        const ChunkData *chunk = bot->worldData.getChunk(ref.chunkX, ref.chunkZ);
+        if (!chunk) continue;
+        std::shared_ptr<const ChunkSection> after = chunk->sectionRef(ref.sectionY);
+        if (after == ref.section) continue;
+        const QString worldKey = sharedWorldKey(bot, chunk->dimension);
+        if (worldKey.isEmpty()) return;
+
+        // Their own clients send the same updates, which then find nothing to change;
+        // that is also what invalidates their caches and marks their chunks dirty
+        const QVector<const BotInstance*> others = m_sharedWorld.updateSection(worldKey, ref, after, bot);
+        for (const BotInstance *holder : others) {
+            auto it = std::find(botInstances.begin(), botInstances.end(), holder);
+            if (it == botInstances.end()) continue;
+            WorldWriteLocker locker(*it);
+            (*it)->worldData.replaceSection(ref, after);
+        }
+    }
+}
+
+void BotManager::trimRetainedChunks(BotInstance *bot)
+{
+    {
+        WorldWriteLocker locker(bot);
+        bot->worldData.trimRetained(size_t(std::max(0, bot->retainedChunksMiB)) * 1024 * 1024);
+    }
+
+    // Other bots' counters and eviction order are only written on this thread, so they are
+    // read without their locks
+    size_t total = 0;
+    for (const BotInstance *b : std::as_const(botInstances)) {
+        total += b->worldData.retainedMemoryUsage();
+    }
+    if (total <= retainedChunkBudget) return;
+
+    // Global LRU over each bot's lower bound on its oldest read. Only the bot with the lowest
+    // bound is locked; once settled, its oldest chunk is evicted if no other bot can hold an
+    // older one, otherwise its bound is raised to the settled value and the next bot tried.
+    struct Candidate {
+        BotInstance *bot;
+        quint64 bound;
+    };
+    QVector<Candidate> candidates;
+    for (BotInstance *b : std::as_const(botInstances)) {
+        if (std::optional<quint64> bound = b->worldData.oldestRetainedUseBound()) {
+            candidates.append({b, *bound});
+        }
+    }
+    while (total > retainedChunkBudget && !candidates.isEmpty()) {
+        int oldest = 0;
+        quint64 nextBound = std::numeric_limits<quint64>::max();
+        for (int i = 1; i < candidates.size(); ++i) {
+            if (candidates[i].bound < candidates[oldest].bound) {
+                nextBound = candidates[oldest].bound;
+                oldest = i;
+            } else {
+                nextBound = std::min(nextBound, candidates[i].bound);
+            }
+        }
+
+        Candidate &candidate = candidates[oldest];
+        std::optional<quint64> bound;
+        {
+            WorldWriteLocker locker(candidate.bot);
+            const size_t before = candidate.bot->worldData.retainedMemoryUsage();
+            if (candidate.bot->worldData.evictOldestRetained(nextBound)) {
+                total -= before - candidate.bot->worldData.retainedMemoryUsage();
+            }
+            bound = candidate.bot->worldData.oldestRetainedUseBound();
+        }
+        if (bound) {
+            candidate.bound = *bound;
+        } else {
+            candidates.removeAt(oldest);
+        }
+    }
+}
+
 void BotManager::handleChunkUnload(int connectionId, const mankool::mcbot::protocol::ChunkUnloadMessage &chunkUnload)
 {
     instance().handleChunkUnloadImpl(connectionId, chunkUnload);
@@ -2683,10 +3196,20 @@ void BotManager::handleChunkUnloadImpl(int connectionId, const mankool::mcbot::p
     int chunkX = chunkUnload.chunkX();
     int chunkZ = chunkUnload.chunkZ();
 
+    QString dimension;
     {
-        QWriteLocker locker(bot->worldDataLock.get());
+        WorldWriteLocker locker(bot);
+        if (const ChunkData *chunk = bot->worldData.getChunk(chunkX, chunkZ)) {
+            dimension = chunk->dimension;
+        }
         bot->worldData.unloadChunk(chunkX, chunkZ);
     }
+    const QString worldKey = sharedWorldKey(bot, dimension);
+    if (!dimension.isEmpty() && !worldKey.isEmpty()) {
+        m_sharedWorld.release(worldKey, ChunkPos(chunkX, chunkZ), bot);
+    }
+    trimRetainedChunks(bot);
+    bot->reachCache->invalidateColumn(chunkX, chunkZ);
 
     if (bot->debugLogging) {
         LogManager::log(QString("[%1] Unloaded chunk (%2, %3)")
@@ -2787,7 +3310,7 @@ void BotManager::handleContainerUpdateImpl(int connectionId, const mankool::mcbo
                     const ChunkData* chunk = bot->worldData.getChunk(chunkX, chunkZ);
                     if (chunk) {
                         auto bes = bot->worldData.getBlockEntitiesInChunk(chunkX, chunkZ, be.dimension);
-                        bot->worldAutoSaver->saveChunkAsync(*chunk, bes);
+                        bot->worldAutoSaver->saveChunkAsync(std::make_shared<const ChunkData>(*chunk), bes);
                     }
                 }
             };
@@ -2968,6 +3491,36 @@ void BotManager::handleEntityUpdate(int connectionId, const mankool::mcbot::prot
     instance().handleEntityUpdateImpl(connectionId, batch);
 }
 
+// Patches the field groups flagged in the delta; everything else is left as is
+static void applyEntityDelta(EntityData &e, const mankool::mcbot::protocol::EntityDelta &delta)
+{
+    using Field = mankool::mcbot::protocol::EntityDeltaFieldGadget::EntityDeltaField;
+    const quint32 changed = delta.changed();
+    auto has = [changed](Field field) { return (changed & static_cast<quint32>(field)) != 0; };
+
+    if (has(Field::ENTITY_DELTA_POSITION)) {
+        e.x = delta.x();
+        e.y = delta.y();
+        e.z = delta.z();
+    }
+    if (has(Field::ENTITY_DELTA_ROTATION)) {
+        e.yaw = delta.yaw();
+        e.pitch = delta.pitch();
+    }
+    if (has(Field::ENTITY_DELTA_VELOCITY)) {
+        e.velX = delta.velX();
+        e.velY = delta.velY();
+        e.velZ = delta.velZ();
+    }
+    if (has(Field::ENTITY_DELTA_HEALTH)) {
+        e.health = delta.health();
+        e.maxHealth = delta.maxHealth();
+    }
+    if (has(Field::ENTITY_DELTA_ITEM_STACK) && e.isItem) {
+        e.itemStack = delta.itemStack();
+    }
+}
+
 void BotManager::handleEntityUpdateImpl(int connectionId, const mankool::mcbot::protocol::EntityUpdate &batch)
 {
     BotInstance *bot = getBotByConnectionIdImpl(connectionId);
@@ -2981,7 +3534,7 @@ void BotManager::handleEntityUpdateImpl(int connectionId, const mankool::mcbot::
         EntityData e;
         e.entityId  = proto.entityId();
         e.uuid       = proto.uuid();
-        e.type       = proto.type();
+        e.type       = sessionString(bot, proto.typeRef(), proto.type());
         e.x          = proto.x();
         e.y          = proto.y();
         e.z          = proto.z();
@@ -3008,12 +3561,32 @@ void BotManager::handleEntityUpdateImpl(int connectionId, const mankool::mcbot::
         removed.append(id);
     }
 
+    // The saver works on full records, so patched entities are copied out for it
+    const bool saveEntities = bot->saveWorldToDisk && bot->worldAutoSaver && bot->worldSaveSettings.saveEntities;
+    int unknownDeltas = 0;
     {
-        QWriteLocker locker(bot->worldDataLock.get());
+        WorldWriteLocker locker(bot);
         bot->worldData.updateEntities(upserted, removed);
+
+        for (const auto &delta : batch.deltas()) {
+            const EntityData *e = bot->worldData.patchEntity(delta.entityId(),
+                [&delta](EntityData &entity) { applyEntityDelta(entity, delta); });
+            if (!e) {
+                ++unknownDeltas;
+                continue;
+            }
+            if (saveEntities) {
+                upserted.append(*e);
+            }
+        }
     }
 
-    if (bot->saveWorldToDisk && bot->worldAutoSaver && bot->worldSaveSettings.saveEntities) {
+    if (unknownDeltas > 0 && bot->debugLogging) {
+        LogManager::log(QString("[%1] Ignored %2 entity deltas for untracked entities")
+                       .arg(bot->name).arg(unknownDeltas), LogManager::Debug);
+    }
+
+    if (saveEntities) {
         bot->worldAutoSaver->onEntitiesUpdated(upserted, removed, bot->dimension);
     }
 }
@@ -3094,27 +3667,56 @@ void BotManager::handleScreenUpdateImpl(int connectionId, const mankool::mcbot::
 
 bool BotManager::sendCanReachBlock(const QString &botName, int x, int y, int z, bool sneak, int timeoutMs, int face)
 {
-    return instance().sendCanReachBlockImpl(botName, x, y, z, sneak, timeoutMs, false, 0, 0, 0, face);
+    PendingReply reply = instance().requestCanReachBlockImpl(botName, x, y, z, sneak, timeoutMs, false, 0, 0, 0, face);
+    return reply.wait() == PendingReply::Status::Completed && reply.value().toBool();
 }
 
 bool BotManager::sendCanReachBlockFrom(const QString &botName, int fromX, int fromY, int fromZ, int x, int y, int z, bool sneak, int timeoutMs, int face)
 {
-    return instance().sendCanReachBlockImpl(botName, x, y, z, sneak, timeoutMs, true, fromX, fromY, fromZ, face);
+    PendingReply reply = instance().requestCanReachBlockImpl(botName, x, y, z, sneak, timeoutMs, true, fromX, fromY, fromZ, face);
+    return reply.wait() == PendingReply::Status::Completed && reply.value().toBool();
+}
+
+PendingReply BotManager::requestCanReachBlock(const QString &botName, int x, int y, int z, bool sneak, int timeoutMs, int face)
+{
+    return instance().requestCanReachBlockImpl(botName, x, y, z, sneak, timeoutMs, false, 0, 0, 0, face);
+}
+
+PendingReply BotManager::requestCanReachBlockFrom(const QString &botName, int fromX, int fromY, int fromZ, int x, int y, int z, bool sneak, int timeoutMs, int face)
+{
+    return instance().requestCanReachBlockImpl(botName, x, y, z, sneak, timeoutMs, true, fromX, fromY, fromZ, face);
 }
 
-bool BotManager::sendCanReachBlockImpl(const QString &botName, int x, int y, int z, bool sneak, int timeoutMs,
-                                        bool hasFrom, int fromX, int fromY, int fromZ, int face)
+PendingReply BotManager::requestCanReachBlockImpl(const QString &botName, int x, int y, int z, bool sneak, int timeoutMs,
+                                                  bool hasFrom, int fromX, int fromY, int fromZ, int face)
 {
     BotInstance *bot = getBotByNameImpl(botName);
     if (!bot || bot->connectionId <= 0)
-        return false;
-
-    QString msgId = QUuid::createUuid().toString(QUuid::WithoutBraces);
+        return PendingReply();
+
+    ReachabilityCache::Key key;
+    key.targetX = x;
+    key.targetY = y;
+    key.targetZ = z;
+    key.sneak = sneak;
+    key.face = face;
+    key.fromCurrent = !hasFrom;
+
+    // Taken before reading the position, so a move after this point voids the answer
+    ReachabilityCache::Ticket ticket = bot->reachCache->begin();
+    if (hasFrom) {
+        key.standX = fromX;
+        key.standY = fromY;
+        key.standZ = fromZ;
+    } else {
+        const QVector3D position = bot->position;
+        key.standX = static_cast<int>(std::floor(position.x()));
+        key.standY = static_cast<int>(std::floor(position.y()));
+        key.standZ = static_cast<int>(std::floor(position.z()));
+    }
 
-    PendingCanReachBlockEntry entry;
-    {
-        QMutexLocker lock(&m_pendingCanReachBlockMutex);
-        m_pendingCanReachBlockRequests[msgId] = &entry;
+    if (std::optional<bool> cached = bot->reachCache->lookup(key)) {
+        return PendingReply::ready(*cached);
     }
 
     mankool::mcbot::protocol::BlockPos pos;
@@ -3137,36 +3739,79 @@ bool BotManager::sendCanReachBlockImpl(const QString &botName, int x, int y, int
 
     mankool::mcbot::protocol::ManagerToClientMessage msg;
     msg.setCanReachBlock(cmd);
-    if (!sendOutboundMessage(bot->connectionId, msg, false, msgId)) {
-        QMutexLocker lock(&m_pendingCanReachBlockMutex);
-        m_pendingCanReachBlockRequests.remove(msgId);
-        return false;
-    }
+    std::shared_ptr<ReachabilityCache> cache = bot->reachCache;
+    return sendRequest(bot, msg, timeoutMs, [cache, key, ticket](const QVariant &reachable) {
+        cache->insert(key, ticket, reachable.toBool());
+    });
+}
 
-    bool acquired = entry.sem.tryAcquire(1, timeoutMs);
+void BotManager::handleCanReachBlockResponse(int connectionId, const mankool::mcbot::protocol::CanReachBlockResponse &response)
+{
+    instance().handleCanReachBlockResponseImpl(connectionId, response);
+}
 
-    {
-        QMutexLocker lock(&m_pendingCanReachBlockMutex);
-        m_pendingCanReachBlockRequests.remove(msgId);
+void BotManager::handleCanReachBlockResponseImpl(int connectionId, const mankool::mcbot::protocol::CanReachBlockResponse &response)
+{
+    completeRequest(connectionId, response.commandId(), response.reachable());
+}
+
+PendingReply BotManager::requestCanReachBlocks(const QString &botName, const QVector<Vec3i> &positions, bool sneak,
+                                               const std::optional<Vec3i> &from, int face, int timeoutMs)
+{
+    return instance().requestCanReachBlocksImpl(botName, positions, sneak, from, face, timeoutMs);
+}
+
+PendingReply BotManager::requestCanReachBlocksImpl(const QString &botName, const QVector<Vec3i> &positions, bool sneak,
+                                                   const std::optional<Vec3i> &from, int face, int timeoutMs)
+{
+    BotInstance *bot = getBotByNameImpl(botName);
+    if (!bot || bot->connectionId <= 0 || positions.size() > kMaxReachBatch)
+        return PendingReply();
+
+    QList<mankool::mcbot::protocol::BlockPos> protoPositions;
+    protoPositions.reserve(positions.size());
+    for (const Vec3i &p : positions) {
+        mankool::mcbot::protocol::BlockPos pos;
+        pos.setX(p.x);
+        pos.setY(p.y);
+        pos.setZ(p.z);
+        protoPositions.append(pos);
     }
 
-    return acquired && entry.reachable;
+    mankool::mcbot::protocol::CanReachBlocksCommand cmd;
+    cmd.setPositions(protoPositions);
+    cmd.setSneak(sneak);
+    if (face != 0)
+        cmd.setFace(static_cast<mankool::mcbot::protocol::BlockFaceGadget::BlockFace>(face));
+    if (from) {
+        mankool::mcbot::protocol::BlockPos fromPos;
+        fromPos.setX(from->x);
+        fromPos.setY(from->y);
+        fromPos.setZ(from->z);
+        cmd.setFromPosition(fromPos);
+    }
+
+    mankool::mcbot::protocol::ManagerToClientMessage msg;
+    msg.setCanReachBlocks(cmd);
+    return sendRequest(bot, msg, timeoutMs);
 }
 
-void BotManager::handleCanReachBlockResponse(int connectionId, const mankool::mcbot::protocol::CanReachBlockResponse &response)
+void BotManager::handleCanReachBlocksResponse(int connectionId, const mankool::mcbot::protocol::CanReachBlocksResponse &response)
 {
-    instance().handleCanReachBlockResponseImpl(connectionId, response);
+    instance().handleCanReachBlocksResponseImpl(connectionId, response);
 }
 
-void BotManager::handleCanReachBlockResponseImpl(int connectionId, const mankool::mcbot::protocol::CanReachBlockResponse &response)
+void BotManager::handleCanReachBlocksResponseImpl(int connectionId, const mankool::mcbot::protocol::CanReachBlocksResponse &response)
 {
-    Q_UNUSED(connectionId);
-    QMutexLocker lock(&m_pendingCanReachBlockMutex);
-    auto it = m_pendingCanReachBlockRequests.find(response.commandId());
-    if (it != m_pendingCanReachBlockRequests.end()) {
-        it.value()->reachable = response.reachable();
-        it.value()->sem.release();
+    const QByteArray &bits = response.reachable();
+    const int count = std::min<qint64>(response.count(), qint64(bits.size()) * 8);
+
+    QVariantList reachable;
+    reachable.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        reachable.append(bool((static_cast<quint8>(bits[i >> 3]) >> (i & 7)) & 1));
     }
+    completeRequest(connectionId, response.commandId(), reachable);
 }
 
 void BotManager::sendHoldAttack(const QString &botName, bool enabled, int durationTicks)
@@ -3193,37 +3838,24 @@ void BotManager::sendHoldAttackImpl(const QString &botName, bool enabled, int du
 
 bool BotManager::getHoldAttackStatus(const QString &botName, int timeoutMs)
 {
-    return instance().getHoldAttackStatusImpl(botName, timeoutMs);
+    PendingReply reply = instance().requestHoldAttackStatusImpl(botName, timeoutMs);
+    return reply.wait() == PendingReply::Status::Completed && reply.value().toBool();
 }
 
-bool BotManager::getHoldAttackStatusImpl(const QString &botName, int timeoutMs)
+PendingReply BotManager::requestHoldAttackStatus(const QString &botName, int timeoutMs)
+{
+    return instance().requestHoldAttackStatusImpl(botName, timeoutMs);
+}
+
+PendingReply BotManager::requestHoldAttackStatusImpl(const QString &botName, int timeoutMs)
 {
     BotInstance *bot = getBotByNameImpl(botName);
     if (!bot || bot->connectionId <= 0)
-        return false;
-
-    QString msgId = QUuid::createUuid().toString(QUuid::WithoutBraces);
-
-    PendingHoldAttackStatusEntry entry;
-    {
-        QMutexLocker lock(&m_pendingHoldAttackStatusMutex);
-        m_pendingHoldAttackStatusRequests[msgId] = &entry;
-    }
+        return PendingReply();
 
     mankool::mcbot::protocol::ManagerToClientMessage msg;
     msg.setGetHoldAttackStatus(mankool::mcbot::protocol::GetHoldAttackStatusCommand{});
-    if (!sendOutboundMessage(bot->connectionId, msg, false, msgId)) {
-        QMutexLocker lock(&m_pendingHoldAttackStatusMutex);
-        m_pendingHoldAttackStatusRequests.remove(msgId);
-        return false;
-    }
-
-    bool acquired = entry.sem.tryAcquire(1, timeoutMs);
-    {
-        QMutexLocker lock(&m_pendingHoldAttackStatusMutex);
-        m_pendingHoldAttackStatusRequests.remove(msgId);
-    }
-    return acquired && entry.enabled;
+    return sendRequest(bot, msg, timeoutMs);
 }
 
 void BotManager::handleHoldAttackStatusResponse(int connectionId, const mankool::mcbot::protocol::HoldAttackStatusResponse &response)
@@ -3233,13 +3865,7 @@ void BotManager::handleHoldAttackStatusResponse(int connectionId, const mankool:
 
 void BotManager::handleHoldAttackStatusResponseImpl(int connectionId, const mankool::mcbot::protocol::HoldAttackStatusResponse &response)
 {
-    Q_UNUSED(connectionId);
-    QMutexLocker lock(&m_pendingHoldAttackStatusMutex);
-    auto it = m_pendingHoldAttackStatusRequests.find(response.commandId());
-    if (it != m_pendingHoldAttackStatusRequests.end()) {
-        it.value()->enabled = response.enabled();
-        it.value()->sem.release();
-    }
+    completeRequest(connectionId, response.commandId(), response.enabled());
 }
 
 void BotManager::sendInteractWithBlock(const QString &botName, int x, int y, int z,
@@ -3659,18 +4285,28 @@ void BotManager::handleLightUpdateImpl(int connectionId, const mankool::mcbot::p
     int chunkX = lightUpdate.chunkX();
     int chunkZ = lightUpdate.chunkZ();
 
-    QWriteLocker locker(bot->worldDataLock.get());
+    QVector<SectionRef> before;
+    {
+        WorldWriteLocker locker(bot);
 
-    for (const auto &sec : lightUpdate.skySections()) {
-        const auto &d = sec.data();
-        bot->worldData.updateSectionSkyLight(chunkX, chunkZ, sec.sectionY(),
-                                             d.isEmpty() ? QByteArray() : QByteArray(d.data(), d.size()));
-    }
-    for (const auto &sec : lightUpdate.blockSections()) {
-        const auto &d = sec.data();
-        bot->worldData.updateSectionBlockLight(chunkX, chunkZ, sec.sectionY(),
-                                               d.isEmpty() ? QByteArray() : QByteArray(d.data(), d.size()));
+        for (const auto &sec : lightUpdate.skySections()) {
+            const auto &d = sec.data();
+            if (shareWorldData) {
+                noteSection(bot->worldData, before, chunkX, chunkZ, sec.sectionY());
+            }
+            bot->worldData.updateSectionSkyLight(chunkX, chunkZ, sec.sectionY(),
+                                                 d.isEmpty() ? QByteArray() : QByteArray(d.data(), d.size()));
+        }
+        for (const auto &sec : lightUpdate.blockSections()) {
+            const auto &d = sec.data();
+            if (shareWorldData) {
+                noteSection(bot->worldData, before, chunkX, chunkZ, sec.sectionY());
+            }
+            bot->worldData.updateSectionBlockLight(chunkX, chunkZ, sec.sectionY(),
+                                                   d.isEmpty() ? QByteArray() : QByteArray(d.data(), d.size()));
+        }
     }
+    shareSectionEdits(bot, before);
 }
 
 void BotManager::handleMapData(int connectionId, const mankool::mcbot::protocol::MapDataMessage &mapData)
@@ -3695,3 +4331,20 @@ void BotManager::handleMapDataImpl(int connectionId, const mankool::mcbot::proto
     );
 }
 
+void BotManager::handleStringDefinitions(int connectionId, const mankool::mcbot::protocol::StringDefinitions &definitions)
+{
+    instance().handleStringDefinitionsImpl(connectionId, definitions);
+}
+
+void BotManager::handleStringDefinitionsImpl(int connectionId, const mankool::mcbot::protocol::StringDefinitions &definitions)
+{
+    BotInstance *bot = getBotByConnectionIdImpl(connectionId);
+    if (!bot) return;
+
+    for (const auto &definition : definitions.definitions()) {
+        if (!bot->sessionStrings.define(definition.stringId(), definition.value())) {
+            LogManager::log(QString("[%1] Rejected string dictionary id %2")
+                           .arg(bot->name).arg(definition.stringId()), LogManager::Warning);
+        }
+    }
+}
@@ -10,11 +10,13 @@
 #include <QMap>
 #include <QSet>
 #include <QMutex>
-#include <QSemaphore>
 #include <QHash>
 #include <QReadWriteLock>
 #include <QPointer>
+#include <QQueue>
 #include <memory>
+#include <atomic>
+#include <optional>
 #include "protocol.qpb.h"
 #include "connection.qpb.h"
 #include "player.qpb.h"
@@ -29,10 +31,14 @@
 #include "registry.qpb.h"
 #include "entities.qpb.h"
 #include "WorldData.h"
+#include "ReachabilityCache.h"
+#include "SharedWorldStore.h"
 #include "world/BlockRegistry.h"
 #include "world/ItemRegistry.h"
 #include "saving/WorldAutoSaver.h"
 #include "crafting/RecipeRegistry.h"
+#include "network/StringDictionary.h"
+#include "network/PendingRequests.h"
 
 using SettingType = mankool::mcbot::protocol::SettingInfo::SettingType;
 using BaritoneSettingType = mankool::mcbot::protocol::BaritoneSettingInfo::SettingType;
@@ -213,6 +219,7 @@ struct BotConfig {
     bool tokenRefresh = true;
     bool debugLogging = false;
     bool saveWorldToDisk = true;
+    int retainedChunksMiB = 64;  // Unloaded chunks kept in memory for scripts; 0 drops them
 
     WorldSaveSettings worldSaveSettings;
 
@@ -233,6 +240,8 @@ struct BotInstance : public BotConfig {
     BotStatus status = BotStatus::Offline;
     mankool::mcbot::protocol::ServerConnectionStatus_QtProtobufNested::Status serverConnectionStatus = mankool::mcbot::protocol::ServerConnectionStatus_QtProtobufNested::Status::INITIAL;
     int connectionId = -1;
+    quint32 protocolFeatures = 0;  // ProtocolFeature bits negotiated in the handshake
+    SessionStringTable sessionStrings;  // Reset on every handshake
     int currentMemory = 0;
     bool tokenRefreshPending = false;
 
@@ -240,6 +249,7 @@ struct BotInstance : public BotConfig {
     bool proxyDisabledAutoReconnect = false;
 
     bool manualStop = false;
+    bool testBot = false;  // Created for an unknown test client; not saved with the settings
     QDateTime startTime;
 
     QString playerUuid;
@@ -282,6 +292,8 @@ struct BotInstance : public BotConfig {
     qint64 bytesSent = 0;
     double dataRateIn = 0.0;   // bytes/sec
     double dataRateOut = 0.0;  // bytes/sec
+    int clientControlQueueDepth = 0;  // Client's send queues, from its last heartbeat
+    int clientBulkQueueDepth = 0;
 
     QPointer<BotConsoleWidget> consoleWidget;
     QPointer<MeteorModulesWidget> meteorWidget;
@@ -346,13 +358,40 @@ struct BotInstance : public BotConfig {
 
     std::shared_ptr<WorldAutoSaver> worldAutoSaver;
     QString worldAutoSaverServerIp;
-    QVector<ChunkData> earlyChunkQueue;
+    QVector<std::shared_ptr<const ChunkData>> earlyChunkQueue;
 
     // Recipe registry
     RecipeRegistry recipeRegistry;
 
     std::shared_ptr<QMutex> dataMutex = std::make_shared<QMutex>();
     std::shared_ptr<QReadWriteLock> worldDataLock = std::make_shared<QReadWriteLock>();
+    bool worldWriteBatched = false;  // worldDataLock is write-held by a WorldWriteBatch (GUI thread only)
+    bool sectionCompactionScheduled = false;  // GUI thread only
+
+    // can_reach_block answers, invalidated by block updates and movement
+    std::shared_ptr<ReachabilityCache> reachCache = std::make_shared<ReachabilityCache>();
+};
+
+// Holds a bot's world write lock across several handler calls, so a client tick
+// batch pays for one lock acquisition instead of one per update. While held, the
+// world update handlers skip their own locking. GUI thread only; nothing that
+// takes a read lock on the same bot may run between acquire() and release().
+class WorldWriteBatch
+{
+public:
+    explicit WorldWriteBatch(int connectionId) : connectionId(connectionId) {}
+    ~WorldWriteBatch() { release(); }
+
+    WorldWriteBatch(const WorldWriteBatch&) = delete;
+    WorldWriteBatch& operator=(const WorldWriteBatch&) = delete;
+
+    void acquire();
+    void release();
+
+private:
+    int connectionId;
+    BotInstance *bot = nullptr;
+    std::shared_ptr<QReadWriteLock> lock;
 };
 
 class BotManager : public QObject
@@ -369,12 +408,27 @@ public:
     static QVector<BotInstance*>& getBots();
     static BotInstance* getBotByConnectionId(int connectionId);
     static BotInstance* getBotByName(const QString &name);
+    // Resets bot->connectionId to -1 and forgets its connection id mapping
+    static void clearConnectionId(BotInstance *bot);
 
     static void addBot(const BotConfig &config);
     static void removeBot(const QString &name);
     static void clearAllBots();
     static void updateBot(const QString &name, const BotConfig &config);
 
+    // When set, a client the manager didn't launch is bound to an offline bot
+    // with the same account id or name (capture replay, load testing)
+    static void setAcceptUnlaunchedClients(bool accept);
+    static bool acceptsUnlaunchedClients();
+    // When set as well, a client matching no bot at all gets a temporary one
+    // that is never saved (mcbot-loadgen)
+    static void setCreateTestBots(bool create);
+    // When set, bots on the same server and dimension share decoded chunks
+    // through a SharedWorldStore instead of each decoding and holding their own
+    static void setShareWorldData(bool share);
+    // Memory all bots together may use for retained (unloaded) chunks
+    static void setRetainedChunkBudget(qint64 bytes);
+
     // Message handlers
     static void handleConnectionInfo(int connectionId, const mankool::mcbot::protocol::ConnectionInfo &info);
     static void handleServerStatus(int connectionId, const mankool::mcbot::protocol::ServerConnectionStatus &status);
@@ -416,6 +470,9 @@ public:
     // Map data handler
     static void handleMapData(int connectionId, const mankool::mcbot::protocol::MapDataMessage &mapData);
 
+    // Session string dictionary handler
+    static void handleStringDefinitions(int connectionId, const mankool::mcbot::protocol::StringDefinitions &definitions);
+
     // World data handlers
     static void handleChunkData(int connectionId, const mankool::mcbot::protocol::ChunkDataMessage &chunkData);
     static void handleBlockUpdate(int connectionId, const mankool::mcbot::protocol::BlockUpdateMessage &blockUpdate);
@@ -425,13 +482,24 @@ public:
     static void handleContainerUpdate(int connectionId, const mankool::mcbot::protocol::ContainerUpdate &containerUpdate);
     static void handleScreenUpdate(int connectionId, const mankool::mcbot::protocol::ScreenDump &screen);
 
-    // World interaction commands
+    // World interaction commands. The request* variants return immediately; the
+    // blocking ones wait on the same reply and return false if it never comes.
     static bool sendCanReachBlock(const QString &botName, int x, int y, int z, bool sneak = false, int timeoutMs = 3000, int face = 0);
     static bool sendCanReachBlockFrom(const QString &botName, int fromX, int fromY, int fromZ, int x, int y, int z, bool sneak = false, int timeoutMs = 3000, int face = 0);
+    static PendingReply requestCanReachBlock(const QString &botName, int x, int y, int z, bool sneak = false, int timeoutMs = 3000, int face = 0);
+    static PendingReply requestCanReachBlockFrom(const QString &botName, int fromX, int fromY, int fromZ, int x, int y, int z, bool sneak = false, int timeoutMs = 3000, int face = 0);
     static void handleCanReachBlockResponse(int connectionId, const mankool::mcbot::protocol::CanReachBlockResponse &response);
+    // Checks every position in one round trip; the reply value is a QVariantList of bools in input order
+    static PendingReply requestCanReachBlocks(const QString &botName, const QVector<Vec3i> &positions, bool sneak = false,
+                                              const std::optional<Vec3i> &from = std::nullopt, int face = 0, int timeoutMs = 3000);
+    static void handleCanReachBlocksResponse(int connectionId, const mankool::mcbot::protocol::CanReachBlocksResponse &response);
+    static constexpr int kMaxReachBatch = 4096;
     static void sendHoldAttack(const QString &botName, bool enabled, int durationTicks = 0);
     static bool getHoldAttackStatus(const QString &botName, int timeoutMs = 3000);
+    static PendingReply requestHoldAttackStatus(const QString &botName, int timeoutMs = 3000);
     static void handleHoldAttackStatusResponse(int connectionId, const mankool::mcbot::protocol::HoldAttackStatusResponse &response);
+    // Settles every request still waiting on this connection; called when it drops
+    static void failPendingRequests(int connectionId);
     static void sendInteractWithBlock(const QString &botName, int x, int y, int z,
                                       mankool::mcbot::protocol::HandGadget::Hand hand = mankool::mcbot::protocol::HandGadget::Hand::MAIN_HAND,
                                       bool sneak = false,
@@ -484,11 +552,13 @@ private:
 
     QVector<BotInstance*>& getBotsImpl() { return botInstances; }
     BotInstance* getBotByConnectionIdImpl(int connectionId);
+    void clearConnectionIdImpl(BotInstance *bot);
     BotInstance* getBotByNameImpl(const QString &name);
     void addBotImpl(const BotConfig &config);
     void removeBotImpl(const QString &name);
     void updateBotImpl(const QString &name, const BotConfig &config);
     void handleConnectionInfoImpl(int connectionId, const mankool::mcbot::protocol::ConnectionInfo &info);
+    BotInstance* findUnlaunchedBot(const QString &playerName, const QString &playerUuid) const;
     void handleServerStatusImpl(int connectionId, const mankool::mcbot::protocol::ServerConnectionStatus &status);
     void handlePlayerStateImpl(int connectionId, const mankool::mcbot::protocol::PlayerStateUpdate &state);
     void handleInventoryUpdateImpl(int connectionId, const mankool::mcbot::protocol::InventoryUpdate &inventory);
@@ -518,13 +588,17 @@ private:
     void handleEntityUpdateImpl(int connectionId, const mankool::mcbot::protocol::EntityUpdate &batch);
     void handleWeatherUpdateImpl(int connectionId, const mankool::mcbot::protocol::WeatherUpdate &weather);
     void handleMapDataImpl(int connectionId, const mankool::mcbot::protocol::MapDataMessage &mapData);
+    void handleStringDefinitionsImpl(int connectionId, const mankool::mcbot::protocol::StringDefinitions &definitions);
     void handleTabListUpdateImpl(int connectionId, const mankool::mcbot::protocol::TabListPlayerUpdate &update);
     void handleTabListRemoveImpl(int connectionId, const mankool::mcbot::protocol::TabListPlayerRemove &remove);
-    bool sendCanReachBlockImpl(const QString &botName, int x, int y, int z, bool sneak, int timeoutMs,
-                               bool hasFrom = false, int fromX = 0, int fromY = 0, int fromZ = 0, int face = 0);
+    PendingReply requestCanReachBlockImpl(const QString &botName, int x, int y, int z, bool sneak, int timeoutMs,
+                                          bool hasFrom = false, int fromX = 0, int fromY = 0, int fromZ = 0, int face = 0);
     void handleCanReachBlockResponseImpl(int connectionId, const mankool::mcbot::protocol::CanReachBlockResponse &response);
+    PendingReply requestCanReachBlocksImpl(const QString &botName, const QVector<Vec3i> &positions, bool sneak,
+                                           const std::optional<Vec3i> &from, int face, int timeoutMs);
+    void handleCanReachBlocksResponseImpl(int connectionId, const mankool::mcbot::protocol::CanReachBlocksResponse &response);
     void sendHoldAttackImpl(const QString &botName, bool enabled, int durationTicks);
-    bool getHoldAttackStatusImpl(const QString &botName, int timeoutMs);
+    PendingReply requestHoldAttackStatusImpl(const QString &botName, int timeoutMs);
     void handleHoldAttackStatusResponseImpl(int connectionId, const mankool::mcbot::protocol::HoldAttackStatusResponse &response);
     void sendInteractWithBlockImpl(const QString &botName, int x, int y, int z,
                                    mankool::mcbot::protocol::HandGadget::Hand hand, bool sneak, bool lookAtBlock,
@@ -552,25 +626,52 @@ private:
     // Helper to initialize WorldAutoSaver when both server and dataVersion are available
     void tryInitializeWorldAutoSaver(BotInstance* bot);
 
-    bool sendOutboundMessage(int connectionId, mankool::mcbot::protocol::ManagerToClientMessage &msg, bool silent = false, const QString &messageId = {});
+    // Sections grow palettes and widen their indices as blocks change; a while after the
+    // first edit they are compacted on a worker thread and swapped back in if unchanged
+    static constexpr int kSectionCompactionDelayMs = 10000;
+    void scheduleSectionCompaction(BotInstance *bot);
+    void compactEditedSections(const QString &botName);
 
-    struct PendingCanReachBlockEntry {
-        QSemaphore sem{0};
-        bool reachable = false;
-    };
+    // SharedWorldStore key for the bot's server, data version and `dimension`; empty when not sharing
+    QString sharedWorldKey(const BotInstance *bot, const QString &dimension) const;
+    // Hands sections the bot has just changed (given as they were before) to the other bots sharing them
+    void shareSectionEdits(BotInstance *bot, const QVector<SectionRef> &before);
+    // Applies the bot's retention budget, then the global one across all bots
+    void trimRetainedChunks(BotInstance *bot);
 
-    struct PendingHoldAttackStatusEntry {
-        QSemaphore sem{0};
-        bool enabled = false;
-    };
+    bool sendOutboundMessage(int connectionId, mankool::mcbot::protocol::ManagerToClientMessage &msg, bool silent = false, const QString &messageId = {});
+    QString nextMessageId();
+    void sendProtocolFeatures(BotInstance *bot, quint32 requested);
+    void markSilent(const QString &messageId);
+    bool takeSilent(const QString &messageId);
+
+    // Sends msg and registers it in m_pendingRequests under its message id
+    PendingReply sendRequest(BotInstance *bot, mankool::mcbot::protocol::ManagerToClientMessage &msg, int timeoutMs,
+                             PendingRequestTable::CompletionHook onComplete = {});
+    void completeRequest(int connectionId, const QString &commandId, const QVariant &value);
 
     QVector<BotInstance*> botInstances;
+    QHash<int, BotInstance*> botsByConnectionId;  // Validated against bot->connectionId on lookup
+    bool acceptUnlaunchedClients = false;
+    bool createTestBots = false;
+    // ProtocolFeature bits this manager can accept from a client
+    static const quint32 kSupportedProtocolFeatures;
     QMap<QString, std::shared_ptr<WorldAutoSaver>> m_sharedWorldSavers;
-    QSet<QString> silentMessageIds;
-    QMutex m_pendingCanReachBlockMutex;
-    QHash<QString, PendingCanReachBlockEntry*> m_pendingCanReachBlockRequests;
-    QMutex m_pendingHoldAttackStatusMutex;
-    QHash<QString, PendingHoldAttackStatusEntry*> m_pendingHoldAttackStatusRequests;
+    bool shareWorldData = false;
+    SharedWorldStore m_sharedWorld;
+    size_t retainedChunkBudget = size_t(512) * 1024 * 1024;
+    // Outbound message ids are a decimal counter; the client echoes them back verbatim
+    std::atomic<quint64> m_nextMessageId{1};
+
+    // Ids of silent commands whose responses shouldn't be echoed. Bounded so ids
+    // the client never answers don't accumulate.
+    static constexpr int kMaxSilentIds = 4096;
+    static constexpr qint64 kSilentIdTtlMs = 60000;
+    QMutex m_silentIdsMutex;
+    QHash<quint64, qint64> m_silentIdDeadlines;
+    QQueue<QPair<quint64, qint64>> m_silentIdOrder;
+    // Requests awaiting a client response (reachability checks, status queries)
+    PendingRequestTable m_pendingRequests;
 
     // Block state registry cache: data_version -> (state_id -> block_state_string)
     QMap<int, QMap<quint32, QString>> blockRegistryCache;
@@ -0,0 +1,175 @@
+#include "ReachabilityCache.h"
+#include <QDateTime>
+#include <QMutexLocker>
+#include <algorithm>
+#include <limits>
+
+ReachabilityCache::Box ReachabilityCache::boxFor(const Key &key)
+{
+    return Box{
+        std::min(key.standX, key.targetX) - 1,
+        std::min(key.standY, key.targetY) - 1,
+        std::min(key.standZ, key.targetZ) - 1,
+        std::max(key.standX, key.targetX) + 1,
+        std::max(key.standY + 2, key.targetY) + 1,
+        std::max(key.standZ, key.targetZ) + 1,
+    };
+}
+
+quint64 ReachabilityCache::columnKey(int chunkX, int chunkZ)
+{
+    return (quint64(quint32(chunkX)) << 32) | quint32(chunkZ);
+}
+
+QVarLengthArray<quint64, 4> ReachabilityCache::columnsFor(const Box &box)
+{
+    QVarLengthArray<quint64, 4> columns;
+    for (int cx = box.minX >> 4; cx <= box.maxX >> 4; ++cx) {
+        for (int cz = box.minZ >> 4; cz <= box.maxZ >> 4; ++cz) {
+            columns.append(columnKey(cx, cz));
+        }
+    }
+    return columns;
+}
+
+std::optional<bool> ReachabilityCache::lookup(const Key &key)
+{
+    QMutexLocker locker(&mutex);
+    auto it = entries.constFind(key);
+    if (it == entries.constEnd()) {
+        ++misses;
+        return std::nullopt;
+    }
+    if (key.fromCurrent && it->moveGeneration != moveGeneration) {
+        removeLocked(key);
+        ++invalidated;
+        ++misses;
+        return std::nullopt;
+    }
+    if (QDateTime::currentMSecsSinceEpoch() - it->storedAt > kTtlMs) {
+        removeLocked(key);
+        ++misses;
+        return std::nullopt;
+    }
+    ++hits;
+    return it->reachable;
+}
+
+ReachabilityCache::Ticket ReachabilityCache::begin() const
+{
+    QMutexLocker locker(&mutex);
+    return Ticket{blockGeneration, moveGeneration};
+}
+
+void ReachabilityCache::insert(const Key &key, const Ticket &ticket, bool reachable)
+{
+    const Box box = boxFor(key);
+
+    QMutexLocker locker(&mutex);
+    if (key.fromCurrent && ticket.moveGeneration != moveGeneration) {
+        return;
+    }
+    // Too many changes since the query went out to tell whether one of them mattered
+    if (blockGeneration - ticket.blockGeneration > quint64(kChangeLogSize)) {
+        return;
+    }
+    for (quint64 gen = ticket.blockGeneration + 1; gen <= blockGeneration; ++gen) {
+        const Change &change = changeLog[gen % kChangeLogSize];
+        if (change.box.intersects(box)) {
+            return;
+        }
+    }
+
+    if (entries.size() >= kMaxEntries && !entries.contains(key)) {
+        entries.clear();
+        byColumn.clear();
+    }
+    entries.insert(key, Entry{reachable, QDateTime::currentMSecsSinceEpoch(), moveGeneration});
+    for (quint64 column : columnsFor(box)) {
+        byColumn[column].insert(key);
+    }
+}
+
+void ReachabilityCache::invalidateBlock(int x, int y, int z)
+{
+    QMutexLocker locker(&mutex);
+    invalidateBoxLocked(Box{x, y, z, x, y, z});
+}
+
+void ReachabilityCache::invalidateColumn(int chunkX, int chunkZ)
+{
+    QMutexLocker locker(&mutex);
+    invalidateBoxLocked(Box{chunkX * 16, std::numeric_limits<int>::min(), chunkZ * 16,
+                            chunkX * 16 + 15, std::numeric_limits<int>::max(), chunkZ * 16 + 15});
+}
+
+void ReachabilityCache::invalidateBoxLocked(const Box &box)
+{
+    ++blockGeneration;
+    changeLog[blockGeneration % kChangeLogSize] = Change{blockGeneration, box};
+
+    QVarLengthArray<Key, 16> hit;
+    for (quint64 column : columnsFor(box)) {
+        auto bucket = byColumn.constFind(column);
+        if (bucket == byColumn.constEnd()) {
+            continue;
+        }
+        for (const Key &key : *bucket) {
+            if (boxFor(key).intersects(box)) {
+                hit.append(key);
+            }
+        }
+    }
+    // A key whose box spans several columns is listed once per column
+    for (const Key &key : std::as_const(hit)) {
+        if (removeLocked(key)) {
+            ++invalidated;
+        }
+    }
+}
+
+void ReachabilityCache::botMoved()
+{
+    // Entries from the old position are dropped when lookup next finds them
+    QMutexLocker locker(&mutex);
+    ++moveGeneration;
+}
+
+void ReachabilityCache::clear()
+{
+    QMutexLocker locker(&mutex);
+    ++moveGeneration;
+    // Anything still in flight was computed against a world we no longer trust
+    blockGeneration += kChangeLogSize + 1;
+    entries.clear();
+    byColumn.clear();
+}
+
+bool ReachabilityCache::removeLocked(const Key &key)
+{
+    if (!entries.remove(key)) {
+        return false;
+    }
+    for (quint64 column : columnsFor(boxFor(key))) {
+        auto bucket = byColumn.find(column);
+        if (bucket == byColumn.end()) {
+            continue;
+        }
+        bucket->remove(key);
+        if (bucket->isEmpty()) {
+            byColumn.erase(bucket);
+        }
+    }
+    return true;
+}
+
+ReachabilityCache::Stats ReachabilityCache::stats() const
+{
+    QMutexLocker locker(&mutex);
+    Stats result;
+    result.hits = hits;
+    result.misses = misses;
+    result.invalidated = invalidated;
+    result.entries = entries.size();
+    return result;
+}
@@ -0,0 +1,114 @@
+#ifndef REACHABILITYCACHE_H
+#define REACHABILITYCACHE_H
+
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QVarLengthArray>
+#include <optional>
+
+// Answers to CanReachBlock queries, so a script re-checking the same target
+// from the same spot doesn't pay a client round trip each time. An entry is
+// dropped when a block near its ray changes, when the bot moves (for queries
+// made from its live position), or after kTtlMs. Safe from any thread.
+class ReachabilityCache
+{
+public:
+    struct Key {
+        int standX = 0, standY = 0, standZ = 0;  // Block the eyes are raised from
+        int targetX = 0, targetY = 0, targetZ = 0;
+        bool sneak = false;
+        int face = 0;                            // 0 = any face
+        bool fromCurrent = true;                 // Raytraced from the bot's live position
+
+        bool operator==(const Key &other) const
+        {
+            return standX == other.standX && standY == other.standY && standZ == other.standZ
+                && targetX == other.targetX && targetY == other.targetY && targetZ == other.targetZ
+                && sneak == other.sneak && face == other.face && fromCurrent == other.fromCurrent;
+        }
+    };
+
+    // What the cache had seen when a query went out. The answer is only
+    // stored if nothing it depends on changed while it was in flight.
+    struct Ticket {
+        quint64 blockGeneration = 0;
+        quint64 moveGeneration = 0;
+    };
+
+    struct Stats {
+        quint64 hits = 0;
+        quint64 misses = 0;
+        quint64 invalidated = 0;  // Entries dropped by block changes, or found stale after movement
+        int entries = 0;
+    };
+
+    std::optional<bool> lookup(const Key &key);
+    // Take the ticket before reading anything the key depends on
+    Ticket begin() const;
+    void insert(const Key &key, const Ticket &ticket, bool reachable);
+
+    void invalidateBlock(int x, int y, int z);
+    void invalidateColumn(int chunkX, int chunkZ);
+    void botMoved();
+    void clear();
+
+    Stats stats() const;
+
+private:
+    static constexpr int kMaxEntries = 8192;
+    static constexpr qint64 kTtlMs = 10000;
+    static constexpr int kChangeLogSize = 256;
+
+    // Blocks that can change the outcome: everything between the standing
+    // position (feet to above the head) and the target, plus a block of slack
+    struct Box {
+        int minX = 0, minY = 0, minZ = 0, maxX = 0, maxY = 0, maxZ = 0;
+
+        bool intersects(const Box &other) const
+        {
+            return minX <= other.maxX && other.minX <= maxX
+                && minY <= other.maxY && other.minY <= maxY
+                && minZ <= other.maxZ && other.minZ <= maxZ;
+        }
+    };
+
+    struct Entry {
+        bool reachable = false;
+        qint64 storedAt = 0;
+        quint64 moveGeneration = 0;  // Entries from the live position are stale once the bot moves
+    };
+
+    struct Change {
+        quint64 generation = 0;
+        Box box;
+    };
+
+    static Box boxFor(const Key &key);
+    static quint64 columnKey(int chunkX, int chunkZ);
+    static QVarLengthArray<quint64, 4> columnsFor(const Box &box);
+
+    void invalidateBoxLocked(const Box &box);
+    bool removeLocked(const Key &key);  // False if the key wasn't cached
+
+    mutable QMutex mutex;
+    QHash<Key, Entry> entries;
+    QHash<quint64, QSet<Key>> byColumn;  // Chunk column -> entries whose box reaches into it
+
+    // Recent block changes, for validating answers that were in flight
+    Change changeLog[kChangeLogSize];
+    quint64 blockGeneration = 0;
+    quint64 moveGeneration = 0;
+
+    quint64 hits = 0;
+    quint64 misses = 0;
+    quint64 invalidated = 0;
+};
+
+inline size_t qHash(const ReachabilityCache::Key &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.standX, key.standY, key.standZ, key.targetX, key.targetY, key.targetZ,
+                      key.sneak, key.face, key.fromCurrent);
+}
+
+#endif // REACHABILITYCACHE_H
@@ -0,0 +1,92 @@
+#include "SharedWorldStore.h"
+
+std::optional<ChunkData> SharedWorldStore::acquire(const QString& worldKey, const ChunkPos& pos, quint64 contentHash,
+                                                   const BotInstance* holder)
+{
+    auto worldIt = worlds.find(worldKey);
+    if (worldIt == worlds.end()) return std::nullopt;
+    auto it = worldIt->find(pos);
+    if (it == worldIt->end() || it->contentHash != contentHash) {
+        return std::nullopt;
+    }
+    it->holders.insert(holder);
+    return it->chunk;
+}
+
+void SharedWorldStore::publish(const QString& worldKey, const ChunkData& chunk, quint64 contentHash,
+                               const BotInstance* holder)
+{
+    // Bots still holding the old version keep their own copy; they stay registered
+    // so edits to sections they share with the new one still reach them
+    Entry& entry = worlds[worldKey][ChunkPos(chunk.chunkX, chunk.chunkZ)];
+    entry.chunk = chunk;
+    entry.contentHash = contentHash;
+    entry.holders.insert(holder);
+}
+
+void SharedWorldStore::release(const QString& worldKey, const ChunkPos& pos, const BotInstance* holder)
+{
+    auto worldIt = worlds.find(worldKey);
+    if (worldIt == worlds.end()) return;
+    auto it = worldIt->find(pos);
+    if (it == worldIt->end()) return;
+
+    it->holders.remove(holder);
+    if (it->holders.isEmpty()) {
+        worldIt->erase(it);
+        if (worldIt->isEmpty()) {
+            worlds.erase(worldIt);
+        }
+    }
+}
+
+void SharedWorldStore::releaseAll(const BotInstance* holder, const QString& exceptWorldKey)
+{
+    for (auto worldIt = worlds.begin(); worldIt != worlds.end();) {
+        if (worldIt.key() != exceptWorldKey) {
+            for (auto it = worldIt->begin(); it != worldIt->end();) {
+                it->holders.remove(holder);
+                if (it->holders.isEmpty()) {
+                    it = worldIt->erase(it);
+                } else {
+                    ++it;
+                }
+            }
+        }
+        if (worldIt->isEmpty()) {
+            worldIt = worlds.erase(worldIt);
+        } else {
+            ++worldIt;
+        }
+    }
+}
+
+QVector<const BotInstance*> SharedWorldStore::updateSection(const QString& worldKey, const SectionRef& before,
+                                                            std::shared_ptr<const ChunkSection> after,
+                                                            const BotInstance* holder)
+{
+    QVector<const BotInstance*> others;
+    auto worldIt = worlds.find(worldKey);
+    if (worldIt == worlds.end()) return others;
+    auto it = worldIt->find(ChunkPos(before.chunkX, before.chunkZ));
+    if (it == worldIt->end() || !it->holders.contains(holder)) return others;
+
+    if (it->chunk.section(before.sectionY) == before.section.get()) {
+        it->chunk.setSection(before.sectionY, std::move(after));
+    }
+    for (const BotInstance* other : std::as_const(it->holders)) {
+        if (other != holder) {
+            others.append(other);
+        }
+    }
+    return others;
+}
+
+int SharedWorldStore::chunkCount() const
+{
+    int count = 0;
+    for (const auto& chunks : worlds) {
+        count += chunks.size();
+    }
+    return count;
+}
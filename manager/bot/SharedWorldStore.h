@@ -0,0 +1,50 @@
+#ifndef SHAREDWORLDSTORE_H
+#define SHAREDWORLDSTORE_H
+
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVector>
+#include <optional>
+#include "WorldData.h"
+
+struct BotInstance;
+
+// Chunks shared between bots on the same server, so a chunk several bots can
+// see is decoded once and its sections are held once. Entries are keyed by
+// world (server, dimension and data version) and chunk position, remember a
+// hash of the chunk message they were decoded from, and are refcounted by the
+// bots that have them loaded. Each bot still keeps its own BotWorldData; only
+// the section pointers are shared. GUI thread only.
+class SharedWorldStore
+{
+public:
+    // The stored chunk if it was decoded from a message with this content hash,
+    // with `holder` registered on it; nullopt if the caller has to decode. Edits
+    // made since are included: the caller's client receives the same updates.
+    std::optional<ChunkData> acquire(const QString& worldKey, const ChunkPos& pos, quint64 contentHash,
+                                     const BotInstance* holder);
+    // Stores a freshly decoded chunk, replacing any older version at its position
+    void publish(const QString& worldKey, const ChunkData& chunk, quint64 contentHash, const BotInstance* holder);
+    void release(const QString& worldKey, const ChunkPos& pos, const BotInstance* holder);
+    // Drops `holder` from every entry, except those of exceptWorldKey
+    void releaseAll(const BotInstance* holder, const QString& exceptWorldKey = QString());
+
+    // Records that `holder` replaced before.section with `after`. Returns the other
+    // holders of the chunk, which may still have before.section.
+    QVector<const BotInstance*> updateSection(const QString& worldKey, const SectionRef& before,
+                                              std::shared_ptr<const ChunkSection> after, const BotInstance* holder);
+
+    int chunkCount() const;
+
+private:
+    struct Entry {
+        ChunkData chunk;
+        quint64 contentHash = 0;
+        QSet<const BotInstance*> holders;
+    };
+
+    QHash<QString, QHash<ChunkPos, Entry>> worlds;
+};
+
+#endif // SHAREDWORLDSTORE_H
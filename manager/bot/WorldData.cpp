@@ -1,79 +1,206 @@
 #include "WorldData.h"
 #include "logging/LogManager.h"
+#include "network/StringDictionary.h"
+#include "world/BlockPredicate.h"
+#include "world/BlockScan.h"
+#include "world/PackedIndices.h"
+#include <QMultiHash>
+#include <QMutex>
 #include <QtMath>
-#include <QRegularExpression>
+#include <QtAlgorithms>
+#include <QtConcurrent/QtConcurrentMap>
 #include <algorithm>
+#include <atomic>
 
 // ============================================================================
 // ChunkSection Implementation
 // ============================================================================
 
-QString ChunkSection::getBlock(int localX, int localY, int localZ) const
+namespace {
+
+constexpr int kSectionBlocks = 4096;
+constexpr int kLightBytes = 2048;
+
+// Uniform sections in use, so chunks can share identical ones. The pool keeps its own
+// reference; entries nothing else holds are dropped every kPoolSweepInterval inserts.
+struct UniformSectionPool {
+    static constexpr int kPoolSweepInterval = 1024;
+
+    QMutex mutex;
+    QMultiHash<size_t, std::shared_ptr<const ChunkSection>> sections;
+    int insertsSinceSweep = 0;
+};
+
+UniformSectionPool& uniformPool()
+{
+    static UniformSectionPool pool;
+    return pool;
+}
+
+size_t uniformHash(const ChunkSection& section)
+{
+    return qHashMulti(0, section.palette, section.biomePalette, section.biomeIndices,
+                      section.biomeUniform, section.blockLight, section.skyLight);
+}
+
+// Shared nibble arrays for sections that are entirely dark or entirely lit
+const QByteArray& darkLight()
+{
+    static const QByteArray light(kLightBytes, '\0');
+    return light;
+}
+
+const QByteArray& brightLight()
+{
+    static const QByteArray light(kLightBytes, '\xFF');
+    return light;
+}
+
+// Retained chunk reads are stamped from one clock for all bots, so the global budget can
+// evict whichever bot's chunk was read least recently
+quint64 nextRetainedUse()
+{
+    static QAtomicInteger<quint64> clock;
+    return clock.fetchAndAddRelaxed(1) + 1;
+}
+
+// `shared` if it was compiled for the chunk's registry, otherwise `local` compiled for it
+const BlockPredicate& predicateFor(const ChunkData& chunk, const BlockPredicate& shared, BlockPredicate& local)
+{
+    if (shared.isCompiledFor(chunk.blockRegistry)) {
+        return shared;
+    }
+    local = BlockPredicate(shared.patterns(), chunk.blockRegistry);
+    return local;
+}
+
+// Entity cells are 16 blocks on each axis. Coordinates are clamped to what the key holds:
+// 24 bits for X and Z, 16 for Y (far beyond world limits; NaN ends up at the top).
+constexpr double kEntityCellSize = 16.0;
+constexpr int kEntityCellLimitXZ = 1 << 23;
+constexpr int kEntityCellLimitY = 1 << 15;
+
+int entityCellCoord(double v, int limit)
+{
+    return static_cast<int>(qBound(-double(limit), std::floor(v / kEntityCellSize), double(limit - 1)));
+}
+
+quint64 entityCellKey(int cx, int cy, int cz)
+{
+    return (quint64(quint32(cx) & 0xFFFFFF) << 40) | (quint64(quint32(cz) & 0xFFFFFF) << 16)
+        | quint64(quint16(cy));
+}
+
+quint64 entityCellKey(const EntityData& e)
+{
+    return entityCellKey(entityCellCoord(e.x, kEntityCellLimitXZ), entityCellCoord(e.y, kEntityCellLimitY),
+                         entityCellCoord(e.z, kEntityCellLimitXZ));
+}
+
+void entityCellCoords(quint64 key, int& cx, int& cy, int& cz)
+{
+    auto signExtend = [](quint64 bits, int width) {
+        const qint64 value = static_cast<qint64>(bits);
+        return static_cast<int>(value >= (qint64(1) << (width - 1)) ? value - (qint64(1) << width) : value);
+    };
+    cx = signExtend((key >> 40) & 0xFFFFFF, 24);
+    cz = signExtend((key >> 16) & 0xFFFFFF, 24);
+    cy = signExtend(key & 0xFFFF, 16);
+}
+
+// Key of a block entity within its chunk's bucket
+qint64 blockEntitySlot(int x, int y, int z)
+{
+    return qint64(y) * 256 + ((z & 15) << 4) + (x & 15);
+}
+
+} // namespace
+
+uint32_t ChunkSection::getStateId(int localX, int localY, int localZ) const
 {
     // Validate coordinates
     if (localX < 0 || localX >= 16 || localY < 0 || localY >= 16 || localZ < 0 || localZ >= 16) {
         LogManager::log(QString("ChunkSection: Invalid local coordinates: (%1, %2, %3)")
                        .arg(localX).arg(localY).arg(localZ), LogManager::Warning);
-        return "minecraft:air";
+        return BlockRegistry::AIR_STATE_ID;
     }
 
     // If uniform, entire section is the same block
     if (uniform) {
-        return palette.isEmpty() ? "minecraft:air" : palette[0];
+        return palette.isEmpty() ? BlockRegistry::AIR_STATE_ID : palette[0];
+    }
+
+    if (packedIndices.isEmpty()) {
+        LogManager::log("ChunkSection: Non-uniform section has no block indices", LogManager::Warning);
+        return BlockRegistry::AIR_STATE_ID;
     }
 
     // Calculate index using YZX order: y*256 + z*16 + x
     int index = localY * 256 + localZ * 16 + localX;
 
-    // Validate index
-    if (index < 0 || index >= blockIndices.size()) {
-        LogManager::log(QString("ChunkSection: Block index out of range: %1 (size: %2)")
-                       .arg(index).arg(blockIndices.size()), LogManager::Warning);
-        return "minecraft:air";
-    }
-
     // Get palette index
-    uint32_t paletteIndex = blockIndices[index];
+    uint32_t paletteIndex = PackedIndices::get(reinterpret_cast<const uchar*>(packedIndices.constData()),
+                                               bitsPerEntry, index);
     if (paletteIndex >= static_cast<uint32_t>(palette.size())) {
         LogManager::log(QString("ChunkSection: Palette index out of range: %1 (palette size: %2)")
                        .arg(paletteIndex).arg(palette.size()), LogManager::Warning);
-        return "minecraft:air";
+        return BlockRegistry::AIR_STATE_ID;
     }
 
     return palette[paletteIndex];
 }
 
-void ChunkSection::setBlock(int localX, int localY, int localZ, const QString& blockState)
+void ChunkSection::setStateId(int localX, int localY, int localZ, uint32_t stateId)
 {
     // Validate coordinates
     if (localX < 0 || localX >= 16 || localY < 0 || localY >= 16 || localZ < 0 || localZ >= 16) {
-        LogManager::log(QString("ChunkSection::setBlock: Invalid local coordinates: (%1, %2, %3)")
+        LogManager::log(QString("ChunkSection::setStateId: Invalid local coordinates: (%1, %2, %3)")
                        .arg(localX).arg(localY).arg(localZ), LogManager::Warning);
         return;
     }
 
-    // If currently uniform, we may need to expand
-    if (uniform && !palette.isEmpty() && palette[0] != blockState) {
-        // Expand uniform section to full palette
+    if (uniform || packedIndices.isEmpty()) {
+        if (palette.isEmpty()) {
+            palette.append(stateId);
+            uniform = true;
+            return;
+        }
+        if (uniform && palette[0] == stateId) {
+            return;
+        }
+        // Expand to indices; every block points at palette[0]
         uniform = false;
-        blockIndices.resize(4096);
-        blockIndices.fill(0); // All blocks point to palette[0]
+        bitsPerEntry = PackedIndices::bitsForPaletteSize(palette.size() + 1);
+        packedIndices = QByteArray(PackedIndices::packedSize(kSectionBlocks, bitsPerEntry), '\0');
     }
 
-    // Find or add block state to palette
-    int paletteIndex = palette.indexOf(blockState);
+    // Find or add block state to palette, widening the indices when it outgrows them
+    int paletteIndex = palette.indexOf(stateId);
     if (paletteIndex == -1) {
         paletteIndex = palette.size();
-        palette.append(blockState);
+        palette.append(stateId);
+        if (PackedIndices::bitsForPaletteSize(palette.size()) > bitsPerEntry) {
+            uint32_t indices[kSectionBlocks];
+            unpackIndices(indices);
+            setIndices(indices);
+        }
     }
 
-    // If not uniform, update the block index
-    if (!uniform) {
-        int index = localY * 256 + localZ * 16 + localX;
-        if (index >= blockIndices.size()) {
-            blockIndices.resize(4096);
-        }
-        blockIndices[index] = paletteIndex;
+    int index = localY * 256 + localZ * 16 + localX;
+    PackedIndices::set(reinterpret_cast<uchar*>(packedIndices.data()), bitsPerEntry, index,
+                       static_cast<uint32_t>(paletteIndex));
+}
+
+void ChunkSection::setIndices(const uint32_t* indices)
+{
+    bitsPerEntry = PackedIndices::bitsForPaletteSize(palette.size());
+    packedIndices = PackedIndices::pack(indices, kSectionBlocks, bitsPerEntry);
+}
+
+void ChunkSection::unpackIndices(uint32_t* out) const
+{
+    if (uniform || !PackedIndices::unpack(packedIndices, bitsPerEntry, out, kSectionBlocks)) {
+        std::fill(out, out + kSectionBlocks, 0u);
     }
 }
 
@@ -92,53 +219,197 @@ ChunkSection::LightLevels ChunkSection::getLight(int localX, int localY, int loc
 
 size_t ChunkSection::memoryUsage() const
 {
+    auto lightUsage = [](const QByteArray& light) -> size_t {
+        // The shared arrays from shareLight cost nothing per section
+        bool shared = light.isSharedWith(darkLight()) || light.isSharedWith(brightLight());
+        return shared ? 0 : light.size();
+    };
+
     size_t total = sizeof(ChunkSection);
 
-    // Palette strings
-    for (const QString& str : palette) {
-        total += str.size() * sizeof(QChar);
+    total += palette.size() * sizeof(uint32_t);
+    total += packedIndices.size();
+    total += biomePalette.size() * sizeof(quint32);
+    total += biomeIndices.size();
+    total += lightUsage(blockLight) + lightUsage(skyLight);
+
+    return total;
+}
+
+std::shared_ptr<const ChunkSection> ChunkSection::compacted() const
+{
+    if (uniform || palette.isEmpty()) {
+        return nullptr;
     }
 
-    // Block indices
-    total += blockIndices.size() * sizeof(uint32_t);
+    uint32_t indices[kSectionBlocks];
+    unpackIndices(indices);
 
-    return total;
+    // Renumber the palette in order of first use, dropping entries no block points at
+    QVector<int> remap(palette.size(), -1);
+    QVector<uint32_t> used;
+    for (uint32_t& index : indices) {
+        if (index >= static_cast<uint32_t>(palette.size())) {
+            index = 0;  // Out of range reads as air; keep it in range rather than guess
+        }
+        if (remap[index] < 0) {
+            remap[index] = used.size();
+            used.append(palette[index]);
+        }
+        index = static_cast<uint32_t>(remap[index]);
+    }
+
+    const int bits = PackedIndices::bitsForPaletteSize(used.size());
+    if (used.size() == palette.size() && bits >= bitsPerEntry) {
+        return nullptr;
+    }
+
+    auto result = std::make_shared<ChunkSection>(*this);
+    result->palette = used;
+    if (used.size() == 1) {
+        result->uniform = true;
+        result->packedIndices.clear();
+        result->bitsPerEntry = 0;
+        return shareUniform(result);
+    }
+    result->setIndices(indices);
+    return result;
+}
+
+std::shared_ptr<const ChunkSection> ChunkSection::shareUniform(std::shared_ptr<const ChunkSection> section)
+{
+    if (!section || !section->uniform) {
+        return section;
+    }
+
+    const size_t hash = uniformHash(*section);
+    UniformSectionPool& pool = uniformPool();
+    QMutexLocker locker(&pool.mutex);
+
+    for (auto it = pool.sections.constFind(hash); it != pool.sections.constEnd() && it.key() == hash; ++it) {
+        if (**it == *section) {
+            return *it;
+        }
+    }
+
+    if (++pool.insertsSinceSweep >= UniformSectionPool::kPoolSweepInterval) {
+        pool.insertsSinceSweep = 0;
+        for (auto it = pool.sections.begin(); it != pool.sections.end();) {
+            it = it.value().use_count() == 1 ? pool.sections.erase(it) : std::next(it);
+        }
+    }
+    pool.sections.insert(hash, section);
+    return section;
+}
+
+void ChunkSection::shareLight(QByteArray& light)
+{
+    if (light.size() != kLightBytes || light.isSharedWith(darkLight()) || light.isSharedWith(brightLight())) {
+        return;
+    }
+    const char first = light.at(0);
+    if (first != '\0' && first != '\xFF') {
+        return;
+    }
+    if (light.count(first) == kLightBytes) {
+        light = first == '\0' ? darkLight() : brightLight();
+    }
+}
+
+bool ChunkSection::operator==(const ChunkSection& other) const
+{
+    return uniform == other.uniform && bitsPerEntry == other.bitsPerEntry
+        && biomeUniform == other.biomeUniform && palette == other.palette
+        && packedIndices == other.packedIndices && biomePalette == other.biomePalette
+        && biomeIndices == other.biomeIndices && blockLight == other.blockLight
+        && skyLight == other.skyLight;
 }
 
 // ============================================================================
 // ChunkData Implementation
 // ============================================================================
 
-std::optional<QString> ChunkData::getBlock(int localX, int localY, int localZ) const
+const ChunkSection* ChunkData::section(int sectionY) const
+{
+    const int slot = sectionY - minSectionY();
+    return slot >= 0 && slot < sections.size() ? sections[slot].get() : nullptr;
+}
+
+std::shared_ptr<const ChunkSection> ChunkData::sectionRef(int sectionY) const
+{
+    const int slot = sectionY - minSectionY();
+    return slot >= 0 && slot < sections.size() ? sections[slot] : nullptr;
+}
+
+void ChunkData::setSection(int sectionY, std::shared_ptr<const ChunkSection> section)
+{
+    const int slot = sectionY - minSectionY();
+    const int slotCount = (maxY - minY + 15) >> 4;
+    if (slot < 0 || slot >= slotCount) {
+        return;
+    }
+    if (sections.size() < slotCount) {
+        sections.resize(slotCount);
+    }
+    sections[slot] = std::move(section);
+}
+
+ChunkSection* ChunkData::mutableSection(int sectionY)
+{
+    const int slot = sectionY - minSectionY();
+    if (slot < 0 || slot >= sections.size() || !sections[slot]) {
+        return nullptr;
+    }
+    std::shared_ptr<const ChunkSection>& ref = sections[slot];
+    // Another chunk, the uniform pool or a reader's copy still sees this version
+    if (ref.use_count() > 1) {
+        ref = std::make_shared<ChunkSection>(*ref);
+    }
+    // Every section is created non-const (make_shared<ChunkSection>), so this is well defined
+    return const_cast<ChunkSection*>(ref.get());
+}
+
+std::optional<uint32_t> ChunkData::getStateId(int localX, int localY, int localZ) const
 {
     // Validate coordinates
     if (localX < 0 || localX >= 16 || localZ < 0 || localZ >= 16 || localY < minY || localY >= maxY) {
         return std::nullopt;
     }
 
-    int sectionY = localY >> 4;  // Absolute section Y (e.g., -56 >> 4 = -4)
-
-    // Check if section exists
-    auto it = sections.find(sectionY);
-    if (it == sections.end()) {
-        return "minecraft:air";  // Non-existent sections are air
+    // Absolute section Y (e.g., -56 >> 4 = -4); non-existent sections are air
+    const ChunkSection* sec = section(localY >> 4);
+    if (!sec) {
+        return BlockRegistry::AIR_STATE_ID;
     }
 
-    // Get local Y within section (0-15)
-    int localSectionY = localY & 15;
+    return sec->getStateId(localX, localY & 15, localZ);
+}
+
+std::optional<QString> ChunkData::getBlock(int localX, int localY, int localZ) const
+{
+    auto stateId = getStateId(localX, localY, localZ);
+    if (!stateId) {
+        return std::nullopt;
+    }
+    return blockStateName(*stateId);
+}
 
-    return it.value().getBlock(localX, localSectionY, localZ);
+QString ChunkData::blockStateName(uint32_t stateId) const
+{
+    if (!blockRegistry) {
+        return "minecraft:air";
+    }
+    return blockRegistry->getBlockState(stateId).value_or("minecraft:air");
 }
 
 ChunkSection::LightLevels ChunkData::getLight(int localX, int localY, int localZ) const
 {
-    int sectionY = localY >> 4;
-    auto it = sections.find(sectionY);
-    if (it == sections.end()) return {};
-    return it.value().getLight(localX, localY & 15, localZ);
+    const ChunkSection* sec = section(localY >> 4);
+    if (!sec) return {};
+    return sec->getLight(localX, localY & 15, localZ);
 }
 
-void ChunkData::setBlock(int localX, int localY, int localZ, const QString& blockState)
+void ChunkData::setStateId(int localX, int localY, int localZ, uint32_t stateId)
 {
     // Validate coordinates
     if (localX < 0 || localX >= 16 || localZ < 0 || localZ >= 16) {
@@ -150,39 +421,83 @@ void ChunkData::setBlock(int localX, int localY, int localZ, const QString& bloc
 
     int sectionY = localY >> 4;
 
-    // Get local Y within section (0-15)
-    int localSectionY = localY & 15;
-
     // Create section if it doesn't exist
-    if (!sections.contains(sectionY)) {
-        ChunkSection newSection;
-        newSection.sectionY = sectionY;
-        newSection.uniform = true;
-        newSection.palette.append("minecraft:air");
-        sections[sectionY] = newSection;
+    if (!section(sectionY)) {
+        auto newSection = std::make_shared<ChunkSection>();
+        newSection->uniform = true;
+        newSection->palette.append(BlockRegistry::AIR_STATE_ID);
+        setSection(sectionY, std::move(newSection));
     }
 
-    // Set block in section
-    sections[sectionY].setBlock(localX, localSectionY, localZ, blockState);
+    // Set block in section; local Y within section is 0-15
+    mutableSection(sectionY)->setStateId(localX, localY & 15, localZ, stateId);
 }
 
 size_t ChunkData::memoryUsage() const
 {
     size_t total = sizeof(ChunkData);
     total += dimension.size() * sizeof(QChar);
+    total += sections.size() * sizeof(std::shared_ptr<const ChunkSection>);
 
-    for (const ChunkSection& section : sections) {
-        total += section.memoryUsage();
+    for (const auto& sec : sections) {
+        if (sec) {
+            total += sec->memoryUsage() / static_cast<size_t>(std::max<long>(1, sec.use_count()));
+        }
     }
 
     return total;
 }
 
+int ChunkData::sectionCount() const
+{
+    return static_cast<int>(std::count_if(sections.begin(), sections.end(),
+                                          [](const auto& sec) { return sec != nullptr; }));
+}
+
+// ============================================================================
+// WorldSnapshot Implementation
+// ============================================================================
+
+const ChunkData* WorldSnapshot::chunk(int chunkX, int chunkZ) const
+{
+    const ChunkPos pos(chunkX, chunkZ);
+    auto region = regions.constFind(regionOf(pos));
+    if (region == regions.constEnd()) return nullptr;
+    auto it = (*region)->constFind(pos);
+    return it == (*region)->constEnd() ? nullptr : it->get();
+}
+
+QVector<ChunkPos> WorldSnapshot::chunkPositions() const
+{
+    QVector<ChunkPos> result;
+    result.reserve(chunkCount);
+    for (const auto& region : regions) {
+        for (auto it = region->constBegin(); it != region->constEnd(); ++it) {
+            result.append(it.key());
+        }
+    }
+    return result;
+}
+
+std::optional<QString> WorldSnapshot::getBlock(int x, int y, int z) const
+{
+    const ChunkData* loaded = chunk(x >> 4, z >> 4);
+    if (!loaded) return std::nullopt;
+    return loaded->getBlock(x & 15, y, z & 15);
+}
+
+std::optional<ChunkSection::LightLevels> WorldSnapshot::getLight(int x, int y, int z) const
+{
+    const ChunkData* loaded = chunk(x >> 4, z >> 4);
+    if (!loaded) return std::nullopt;
+    return loaded->getLight(x & 15, y, z & 15);
+}
+
 // ============================================================================
 // BotWorldData Implementation
 // ============================================================================
 
-std::optional<QString> BotWorldData::getBlock(int x, int y, int z) const
+std::optional<uint32_t> BotWorldData::getStateId(int x, int y, int z) const
 {
     // Calculate chunk position
     ChunkPos chunkPos(x >> 4, z >> 4);
@@ -197,7 +512,16 @@ std::optional<QString> BotWorldData::getBlock(int x, int y, int z) const
     int localX = x & 15;  // Modulo 16
     int localZ = z & 15;
 
-    return it.value().getBlock(localX, y, localZ);
+    return it.value().getStateId(localX, y, localZ);
+}
+
+std::optional<QString> BotWorldData::getBlock(int x, int y, int z) const
+{
+    auto it = chunks.find(ChunkPos(x >> 4, z >> 4));
+    if (it == chunks.end()) {
+        return std::nullopt;
+    }
+    return it.value().getBlock(x & 15, y, z & 15);
 }
 
 std::optional<ChunkSection::LightLevels> BotWorldData::getLight(int x, int y, int z) const
@@ -206,15 +530,13 @@ std::optional<ChunkSection::LightLevels> BotWorldData::getLight(int x, int y, in
     auto it = chunks.find(chunkPos);
     if (it == chunks.end()) return std::nullopt;
 
-    const ChunkData& chunk = it.value();
-    int sectionY = y >> 4;
-    auto sit = chunk.sections.find(sectionY);
-    if (sit == chunk.sections.end()) return ChunkSection::LightLevels{};
+    const ChunkSection* section = it.value().section(y >> 4);
+    if (!section) return ChunkSection::LightLevels{};
 
     int localX = x & 15;
     int localY = y & 15;
     int localZ = z & 15;
-    return sit.value().getLight(localX, localY, localZ);
+    return section->getLight(localX, localY, localZ);
 }
 
 void BotWorldData::updateSectionBlockLight(int chunkX, int chunkZ, int sectionY, const QByteArray& data)
@@ -222,9 +544,12 @@ void BotWorldData::updateSectionBlockLight(int chunkX, int chunkZ, int sectionY,
     ChunkPos pos(chunkX, chunkZ);
     auto it = chunks.find(pos);
     if (it == chunks.end()) return;
-    auto sit = it->sections.find(sectionY);
-    if (sit == it->sections.end()) return;
-    sit->blockLight = data;
+    const ChunkSection* current = it->section(sectionY);
+    if (!current || current->blockLight == data) return;  // Another bot sharing the chunk already applied it
+    ChunkSection* section = it->mutableSection(sectionY);
+    section->blockLight = data;
+    ChunkSection::shareLight(section->blockLight);
+    unpublished.insert(pos);
 }
 
 void BotWorldData::updateSectionSkyLight(int chunkX, int chunkZ, int sectionY, const QByteArray& data)
@@ -232,13 +557,19 @@ void BotWorldData::updateSectionSkyLight(int chunkX, int chunkZ, int sectionY, c
     ChunkPos pos(chunkX, chunkZ);
     auto it = chunks.find(pos);
     if (it == chunks.end()) return;
-    auto sit = it->sections.find(sectionY);
-    if (sit == it->sections.end()) return;
-    sit->skyLight = data;
+    const ChunkSection* current = it->section(sectionY);
+    if (!current || current->skyLight == data) return;
+    ChunkSection* section = it->mutableSection(sectionY);
+    section->skyLight = data;
+    ChunkSection::shareLight(section->skyLight);
+    unpublished.insert(pos);
 }
 
-void BotWorldData::setBlock(int x, int y, int z, const QString& blockState)
+void BotWorldData::setStateId(int x, int y, int z, uint32_t stateId)
 {
+    // Already there, e.g. applied through a bot sharing the chunk; don't unshare the section
+    if (getStateId(x, y, z) == stateId) return;
+
     // Calculate chunk position
     ChunkPos chunkPos(x >> 4, z >> 4);
 
@@ -248,6 +579,7 @@ void BotWorldData::setBlock(int x, int y, int z, const QString& blockState)
         newChunk.chunkX = chunkPos.x;
         newChunk.chunkZ = chunkPos.z;
         newChunk.dimension = currentDimension;
+        newChunk.blockRegistry = blockRegistry;
         chunks[chunkPos] = newChunk;
     }
 
@@ -255,31 +587,78 @@ void BotWorldData::setBlock(int x, int y, int z, const QString& blockState)
     int localX = x & 15;
     int localZ = z & 15;
 
-    chunks[chunkPos].setBlock(localX, y, localZ, blockState);
+    chunks[chunkPos].setStateId(localX, y, localZ, stateId);
+    editedSections[chunkPos].insert(y >> 4);
+    unpublished.insert(chunkPos);
 }
 
 void BotWorldData::loadChunk(const ChunkData& chunk)
 {
     ChunkPos pos(chunk.chunkX, chunk.chunkZ);
+    // Same position in another dimension; the client never unloads those on a dimension change
+    auto existing = chunks.find(pos);
+    if (existing != chunks.end() && existing->dimension != chunk.dimension) {
+        retainChunk(std::move(existing.value()));
+    }
+    dropRetained(chunk.dimension, pos);
     chunks[pos] = chunk;
+    editedSections.remove(pos);
+    unpublished.insert(pos);
+}
+
+QVector<SectionRef> BotWorldData::takeEditedSections()
+{
+    QVector<SectionRef> result;
+    for (auto it = editedSections.constBegin(); it != editedSections.constEnd(); ++it) {
+        auto chunkIt = chunks.constFind(it.key());
+        if (chunkIt == chunks.constEnd()) continue;
+        for (int sectionY : it.value()) {
+            if (auto section = chunkIt->sectionRef(sectionY)) {
+                result.append({it.key().x, it.key().z, sectionY, std::move(section)});
+            }
+        }
+    }
+    editedSections.clear();
+    return result;
+}
+
+SectionRef BotWorldData::sectionRef(int chunkX, int chunkZ, int sectionY) const
+{
+    SectionRef ref{chunkX, chunkZ, sectionY, nullptr};
+    auto it = chunks.constFind(ChunkPos(chunkX, chunkZ));
+    if (it != chunks.constEnd()) {
+        ref.section = it->sectionRef(sectionY);
+    }
+    return ref;
+}
+
+bool BotWorldData::replaceSection(const SectionRef& expected, std::shared_ptr<const ChunkSection> replacement)
+{
+    auto it = chunks.find(ChunkPos(expected.chunkX, expected.chunkZ));
+    if (it == chunks.end() || it->section(expected.sectionY) != expected.section.get()) {
+        return false;
+    }
+    it->setSection(expected.sectionY, std::move(replacement));
+    unpublished.insert(it.key());
+    return true;
 }
 
 void BotWorldData::unloadChunk(int chunkX, int chunkZ)
 {
     ChunkPos pos(chunkX, chunkZ);
-    chunks.remove(pos);
+    auto it = chunks.find(pos);
+    if (it != chunks.end()) {
+        ChunkData chunk = std::move(it.value());
+        chunks.erase(it);
+        retainChunk(std::move(chunk));
+        unpublished.insert(pos);
+    }
+    editedSections.remove(pos);
 
     // Remove block entities belonging to this chunk
-    int minX = chunkX * 16, maxX = minX + 15;
-    int minZ = chunkZ * 16, maxZ = minZ + 15;
-    auto it = blockEntities.begin();
-    while (it != blockEntities.end()) {
-        const BlockEntityData& be = it.value();
-        if (be.x >= minX && be.x <= maxX && be.z >= minZ && be.z <= maxZ) {
-            it = blockEntities.erase(it);
-        } else {
-            ++it;
-        }
+    for (auto dim = blockEntities.begin(); dim != blockEntities.end();) {
+        dim->remove(pos);
+        dim = dim->isEmpty() ? blockEntities.erase(dim) : std::next(dim);
     }
 }
 
@@ -304,152 +683,356 @@ QVector<ChunkPos> BotWorldData::getLoadedChunks() const
     return chunks.keys();
 }
 
-QVector<QVector3D> BotWorldData::findBlocks(const QString& blockType, const QVector3D& center, int radius) const
+QVector<QVector3D> BotWorldData::findBlocks(const QString& blockType, const QVector3D& center, int radius,
+                                            const ChunkSection::LightRange& light) const
 {
-    QVector<QVector3D> results;
+    return searchBlocks(chunksInRange(center, radius), QStringList{blockType}, center, radius, light);
+}
 
-    const double radiusSq = static_cast<double>(radius) * radius;
+std::optional<QVector3D> BotWorldData::findNearestBlock(const QStringList& blockTypes, const QVector3D& start, int maxDistance) const
+{
+    return searchNearestBlock(chunksInRange(start, maxDistance), blockTypes, start, maxDistance);
+}
 
-    // Calculate chunk bounds
+QVector<ChunkData> BotWorldData::chunksInRange(const QVector3D& center, int radius) const
+{
+    QVector<ChunkData> result;
     int minChunkX = static_cast<int>(qFloor((center.x() - radius) / 16.0));
     int maxChunkX = static_cast<int>(qFloor((center.x() + radius) / 16.0));
     int minChunkZ = static_cast<int>(qFloor((center.z() - radius) / 16.0));
     int maxChunkZ = static_cast<int>(qFloor((center.z() + radius) / 16.0));
-
-    int minY = qMax(static_cast<int>(center.y() - radius), -64);
-    int maxY = qMin(static_cast<int>(center.y() + radius), 320);
-
-    // Search all chunks in range (only loaded ones!)
     for (int chunkX = minChunkX; chunkX <= maxChunkX; ++chunkX) {
         for (int chunkZ = minChunkZ; chunkZ <= maxChunkZ; ++chunkZ) {
-            // Skip unloaded chunks immediately
-            const ChunkData* chunk = getChunk(chunkX, chunkZ);
-            if (!chunk) continue;
-
-            int chunkMinX = chunkX * 16;
-            int chunkMaxX = chunkMinX + 15;
-            int chunkMinZ = chunkZ * 16;
-            int chunkMaxZ = chunkMinZ + 15;
-
-            double closestX = qBound(chunkMinX, static_cast<int>(center.x()), chunkMaxX);
-            double closestZ = qBound(chunkMinZ, static_cast<int>(center.z()), chunkMaxZ);
-            double closestY = qBound(minY, static_cast<int>(center.y()), maxY);
-
-            double dx = closestX - center.x();
-            double dy = closestY - center.y();
-            double dz = closestZ - center.z();
-
-            if (dx*dx + dy*dy + dz*dz > radiusSq) {
-                continue;  // Entire chunk is outside radius
+            if (const ChunkData* chunk = getChunk(chunkX, chunkZ)) {
+                result.append(*chunk);
             }
+        }
+    }
+    return result;
+}
 
-            // Search all blocks in this chunk within radius
-            for (int x = 0; x < 16; ++x) {
-                int worldX = chunkX * 16 + x;
-                double dx = worldX - center.x();
-                double dxSq = dx * dx;
-
-                for (int z = 0; z < 16; ++z) {
-                    int worldZ = chunkZ * 16 + z;
-                    double dz = worldZ - center.z();
-                    double dzSq = dz * dz;
-                    double horizDistSq = dxSq + dzSq;
+QVector<QVector3D> BotWorldData::searchBlocks(const QVector<ChunkData>& chunks, const QStringList& blockTypes,
+                                              const QVector3D& center, int radius,
+                                              const ChunkSection::LightRange& light)
+{
+    if (chunks.isEmpty()) return {};
+    const BlockPredicate predicate(blockTypes, chunks.first().blockRegistry);
+    const double radiusSq = static_cast<double>(radius) * radius;
+    const int minY = static_cast<int>(center.y() - radius);
+    const int maxY = static_cast<int>(center.y() + radius);
+
+    const QList<QVector<QVector3D>> perChunk = QtConcurrent::blockingMapped(chunks,
+        [&](const ChunkData& chunk) {
+            QVector<QVector3D> found;
+            BlockPredicate local;
+            const BlockPredicate& matcher = predicateFor(chunk, predicate, local);
+            if (matcher.matchesNothing()) return found;
+            scanChunk(chunk, matcher, center, minY, maxY, radiusSq, light, [&](int x, int y, int z, double) {
+                found.append(QVector3D(x, y, z));
+            });
+            return found;
+        });
 
-                    // Early-exit if horizontal distance alone exceeds radius
-                    if (horizDistSq > radiusSq) continue;
+    QVector<QVector3D> results;
+    for (const QVector<QVector3D>& found : perChunk) {
+        results += found;
+    }
+    return results;
+}
 
-                    for (int y = minY; y <= maxY; ++y) {
-                        double dy = y - center.y();
-                        double distSq = horizDistSq + dy*dy;
+std::optional<QVector3D> BotWorldData::searchNearestBlock(const QVector<ChunkData>& chunks, const QStringList& blockTypes,
+                                                          const QVector3D& start, int maxDistance)
+{
+    if (chunks.isEmpty()) return std::nullopt;
+    const BlockPredicate predicate(blockTypes, chunks.first().blockRegistry);
+    const double maxDistSq = static_cast<double>(maxDistance) * maxDistance;
+    const int minY = static_cast<int>(start.y() - maxDistance);
+    const int maxY = static_cast<int>(start.y() + maxDistance);
+
+    // Closest chunks first, so an early hit lets the pool skip the far ones
+    QVector<double> chunkDistSq(chunks.size());
+    QVector<int> order(chunks.size());
+    for (int i = 0; i < chunks.size(); ++i) {
+        const double dx = qBound(chunks[i].chunkX * 16.0, static_cast<double>(start.x()), chunks[i].chunkX * 16.0 + 15.0) - start.x();
+        const double dz = qBound(chunks[i].chunkZ * 16.0, static_cast<double>(start.z()), chunks[i].chunkZ * 16.0 + 15.0) - start.z();
+        chunkDistSq[i] = dx * dx + dz * dz;
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](int a, int b) { return chunkDistSq[a] < chunkDistSq[b]; });
+
+    // Best distance found by any worker. Chunks only prune what is strictly farther, so a
+    // tie is still found and settled below by chunk order, whichever worker finishes first.
+    std::atomic<double> bestDistSq(maxDistSq);
+
+    struct Hit {
+        double distSq = 0;
+        int chunk = 0;
+        QVector3D pos;
+    };
+    const QList<std::optional<Hit>> perChunk = QtConcurrent::blockingMapped(order,
+        [&](int index) -> std::optional<Hit> {
+            const ChunkData& chunk = chunks[index];
+            double limitSq = bestDistSq.load(std::memory_order_relaxed);
+            if (chunkDistSq[index] > limitSq) return std::nullopt;
+
+            BlockPredicate local;
+            const BlockPredicate& matcher = predicateFor(chunk, predicate, local);
+            if (matcher.matchesNothing()) return std::nullopt;
+
+            std::optional<Hit> hit;
+            scanChunk(chunk, matcher, start, minY, maxY, limitSq, {}, [&](int x, int y, int z, double distSq) {
+                if (distSq < maxDistSq && (!hit || distSq < hit->distSq)) {
+                    hit = Hit{distSq, index, QVector3D(x, y, z)};
+                    limitSq = distSq;
+                }
+            });
+            if (hit) {
+                double best = bestDistSq.load(std::memory_order_relaxed);
+                while (hit->distSq < best && !bestDistSq.compare_exchange_weak(best, hit->distSq)) {}
+            }
+            return hit;
+        });
+
+    std::optional<Hit> nearest;
+    for (const std::optional<Hit>& hit : perChunk) {
+        if (hit && (!nearest || hit->distSq < nearest->distSq ||
+                    (hit->distSq == nearest->distSq && hit->chunk < nearest->chunk))) {
+            nearest = hit;
+        }
+    }
+    return nearest ? std::optional<QVector3D>(nearest->pos) : std::nullopt;
+}
 
-                        if (distSq > radiusSq) continue;
+void BotWorldData::scanChunk(const ChunkData& chunk, const BlockPredicate& predicate, const QVector3D& center,
+                             int minY, int maxY, const double& limitSq, const ChunkSection::LightRange& light,
+                             const std::function<void(int, int, int, double)>& visit)
+{
+    minY = qMax(minY, chunk.minY);
+    maxY = qMin(maxY, chunk.maxY - 1);
+    if (minY > maxY) return;
+
+    const int baseX = chunk.chunkX * 16;
+    const int baseZ = chunk.chunkZ * 16;
+    const double closestDx = qBound(static_cast<double>(baseX), static_cast<double>(center.x()), baseX + 15.0) - center.x();
+    const double closestDz = qBound(static_cast<double>(baseZ), static_cast<double>(center.z()), baseZ + 15.0) - center.z();
+    const double closestHorizSq = closestDx * closestDx + closestDz * closestDz;
+
+    auto lightData = [](const QByteArray& nibbles) {
+        return nibbles.size() == kLightBytes ? reinterpret_cast<const uint8_t*>(nibbles.constData()) : nullptr;
+    };
+
+    uint32_t indices[kSectionBlocks];
+    uint64_t bits[BlockScan::kWords];
+    for (int sectionY = minY >> 4; sectionY <= maxY >> 4; ++sectionY) {
+        const int baseY = sectionY * 16;
+        const int sectionMinY = qMax(minY, baseY);
+        const int sectionMaxY = qMin(maxY, baseY + 15);
+        const double closestDy = qBound(static_cast<double>(sectionMinY), static_cast<double>(center.y()),
+                                        static_cast<double>(sectionMaxY)) - center.y();
+        if (closestHorizSq + closestDy * closestDy > limitSq) continue;
+
+        // Absent sections, uniform sections and sections without indices read as one slot;
+        // SectionMask treats slots past the palette (UINT32_MAX here) as air
+        const ChunkSection* section = chunk.section(sectionY);
+        BlockPredicate::SectionMask mask = section ? predicate.sectionMask(*section)
+                                                   : predicate.sectionMask(ChunkSection());
+        if (!mask.any()) continue;
+
+        std::optional<uint32_t> onlySlot;
+        if (!section) {
+            onlySlot = UINT32_MAX;
+        } else if (section->uniform) {
+            onlySlot = 0;
+        } else if (section->packedIndices.isEmpty() ||
+                   !PackedIndices::unpack(section->packedIndices, section->bitsPerEntry, indices, kSectionBlocks)) {
+            onlySlot = UINT32_MAX;
+        }
+        if (onlySlot) {
+            if (!mask.test(*onlySlot)) continue;
+            std::fill(std::begin(bits), std::end(bits), ~uint64_t(0));
+        } else {
+            BlockScan::matchSlots(indices, mask.slotBits(), mask.slotCount(), mask.pastEndMatches(), bits);
+        }
 
-                        // Check block type
-                        auto block = chunk->getBlock(x, y, z);
-                        if (block && blockMatches(*block, QStringList{blockType})) {
-                            results.append(QVector3D(worldX, y, worldZ));
-                        }
-                    }
+        // 256 blocks, four words, per layer
+        for (int y = 0; y < 16; ++y) {
+            if (baseY + y < sectionMinY || baseY + y > sectionMaxY) {
+                std::fill(bits + y * 4, bits + y * 4 + 4, 0);
+            }
+        }
+        BlockScan::clipToSphere(baseX - static_cast<double>(center.x()), baseY - static_cast<double>(center.y()),
+                                baseZ - static_cast<double>(center.z()), limitSq, bits);
+        BlockScan::filterLight(section ? lightData(section->blockLight) : nullptr, light.minBlock, light.maxBlock, bits);
+        BlockScan::filterLight(section ? lightData(section->skyLight) : nullptr, light.minSky, light.maxSky, bits);
+
+        for (int word = 0; word < BlockScan::kWords; ++word) {
+            for (uint64_t remaining = bits[word]; remaining; remaining &= remaining - 1) {
+                const int index = word * 64 + qCountTrailingZeroBits(static_cast<quint64>(remaining));
+                const int x = baseX + (index & 15);
+                const int y = baseY + (index >> 8);
+                const int z = baseZ + ((index >> 4) & 15);
+                const double dx = x - static_cast<double>(center.x());
+                const double dy = y - static_cast<double>(center.y());
+                const double dz = z - static_cast<double>(center.z());
+                const double distSq = dx * dx + dy * dy + dz * dz;
+                // visit may have lowered the limit since the section was clipped
+                if (distSq <= limitSq) {
+                    visit(x, y, z, distSq);
                 }
             }
         }
     }
+}
 
-    return results;
+void BotWorldData::setCurrentDimension(const QString& dimension)
+{
+    currentDimension = dimension;
+    for (auto it = chunks.begin(); it != chunks.end();) {
+        if (it->dimension != dimension) {
+            unpublished.insert(it.key());
+            ChunkData chunk = std::move(it.value());
+            it = chunks.erase(it);
+            retainChunk(std::move(chunk));
+        } else {
+            ++it;
+        }
+    }
 }
 
-std::optional<QVector3D> BotWorldData::findNearestBlock(const QStringList& blockTypes, const QVector3D& start, int maxDistance) const
+void BotWorldData::retainChunk(ChunkData chunk)
 {
-    std::optional<QVector3D> nearest;
-    double nearestDistSq = static_cast<double>(maxDistance) * maxDistance;
+    const ChunkPos pos(chunk.chunkX, chunk.chunkZ);
+
+    // Retained chunks don't change again, so edited sections are compacted now rather than later
+    auto edited = editedSections.find(pos);
+    if (edited != editedSections.end()) {
+        for (int sectionY : std::as_const(edited.value())) {
+            const ChunkSection* section = chunk.section(sectionY);
+            if (!section) continue;
+            if (auto compact = section->compacted()) {
+                chunk.setSection(sectionY, std::move(compact));
+            }
+        }
+        editedSections.erase(edited);
+    }
 
-    // Calculate chunk bounds
-    int minChunkX = static_cast<int>(qFloor((start.x() - maxDistance) / 16.0));
-    int maxChunkX = static_cast<int>(qFloor((start.x() + maxDistance) / 16.0));
-    int minChunkZ = static_cast<int>(qFloor((start.z() - maxDistance) / 16.0));
-    int maxChunkZ = static_cast<int>(qFloor((start.z() + maxDistance) / 16.0));
+    const QString dimension = chunk.dimension;
+    dropRetained(dimension, pos);
+    RetainedChunk& entry = retained[dimension][pos];
+    entry.bytes = chunk.memoryUsage();
+    entry.queuedUse = nextRetainedUse();
+    entry.lastUse.storeRelaxed(entry.queuedUse);
+    entry.chunk = std::move(chunk);
+    retainedOrder.insert(entry.queuedUse, RetainedKey{dimension, pos});
+    retainedBytes += entry.bytes;
+}
 
-    int minY = qMax(static_cast<int>(start.y() - maxDistance), -64);
-    int maxY = qMin(static_cast<int>(start.y() + maxDistance), 320);
+void BotWorldData::dropRetained(const QString& dimension, const ChunkPos& pos)
+{
+    auto dimIt = retained.find(dimension);
+    if (dimIt == retained.end()) return;
+    auto it = dimIt->find(pos);
+    if (it == dimIt->end()) return;
+
+    retainedOrder.remove(it->queuedUse);
+    retainedBytes -= it->bytes;
+    dimIt->erase(it);
+    if (dimIt->isEmpty()) {
+        retained.erase(dimIt);
+    }
+}
 
-    // Search all chunks in range (spiral from center for early-exit potential)
-    for (int chunkX = minChunkX; chunkX <= maxChunkX; ++chunkX) {
-        for (int chunkZ = minChunkZ; chunkZ <= maxChunkZ; ++chunkZ) {
-            // Skip unloaded chunks
-            const ChunkData* chunk = getChunk(chunkX, chunkZ);
-            if (!chunk) continue;
+const ChunkData* BotWorldData::getRetainedChunk(const QString& dimension, int chunkX, int chunkZ) const
+{
+    auto dimIt = retained.constFind(dimension);
+    if (dimIt == retained.constEnd()) return nullptr;
+    auto it = dimIt->constFind(ChunkPos(chunkX, chunkZ));
+    if (it == dimIt->constEnd()) return nullptr;
+    it->lastUse.storeRelaxed(nextRetainedUse());
+    return &it->chunk;
+}
 
-            int chunkMinX = chunkX * 16;
-            int chunkMaxX = chunkMinX + 15;
-            int chunkMinZ = chunkZ * 16;
-            int chunkMaxZ = chunkMinZ + 15;
+QVector<ChunkPos> BotWorldData::getRetainedChunks(const QString& dimension) const
+{
+    return retained.value(dimension).keys();
+}
 
-            double closestX = qBound(chunkMinX, static_cast<int>(start.x()), chunkMaxX);
-            double closestZ = qBound(chunkMinZ, static_cast<int>(start.z()), chunkMaxZ);
-            double closestY = qBound(minY, static_cast<int>(start.y()), maxY);
+void BotWorldData::settleRetainedOrder()
+{
+    while (!retainedOrder.isEmpty()) {
+        auto front = retainedOrder.begin();
+        const RetainedKey key = front.value();
+        auto dimIt = retained.find(key.dimension);
+        if (dimIt == retained.end() || !dimIt->contains(key.pos)) {
+            retainedOrder.erase(front);  // Not expected; drop the stale entry rather than loop on it
+            continue;
+        }
+        RetainedChunk& entry = (*dimIt)[key.pos];
+        const quint64 used = entry.lastUse.loadRelaxed();
+        if (used == front.key()) return;
+        retainedOrder.erase(front);
+        entry.queuedUse = used;
+        retainedOrder.insert(used, key);
+    }
+}
 
-            double dx = closestX - start.x();
-            double dy = closestY - start.y();
-            double dz = closestZ - start.z();
+std::optional<quint64> BotWorldData::oldestRetainedUseBound() const
+{
+    // Reads only move entries later, so the unsettled front is never past the true oldest
+    if (retainedOrder.isEmpty()) return std::nullopt;
+    return retainedOrder.firstKey();
+}
 
-            if (dx*dx + dy*dy + dz*dz >= nearestDistSq) {
-                continue;  // Entire chunk is farther than current best
-            }
+bool BotWorldData::evictOldestRetained(quint64 notAfter)
+{
+    settleRetainedOrder();
+    if (retainedOrder.isEmpty() || retainedOrder.firstKey() > notAfter) return false;
+    const RetainedKey key = retainedOrder.first();
+    dropRetained(key.dimension, key.pos);
+    return true;
+}
 
-            // Search all blocks in this chunk
-            for (int x = 0; x < 16; ++x) {
-                int worldX = chunkX * 16 + x;
-                double dx = worldX - start.x();
-                double dxSq = dx * dx;
-
-                for (int z = 0; z < 16; ++z) {
-                    int worldZ = chunkZ * 16 + z;
-                    double dz = worldZ - start.z();
-                    double dzSq = dz * dz;
-                    double horizDistSq = dxSq + dzSq;
-
-                    // Early-exit if horizontal distance alone exceeds current best
-                    if (horizDistSq >= nearestDistSq) continue;
-
-                    for (int y = minY; y <= maxY; ++y) {
-                        double dy = y - start.y();
-                        double distSq = horizDistSq + dy*dy;
-
-                        if (distSq >= nearestDistSq) continue;
-
-                        // Check block type
-                        auto block = chunk->getBlock(x, y, z);
-                        if (block && blockMatches(*block, blockTypes)) {
-                            nearest = QVector3D(worldX, y, worldZ);
-                            nearestDistSq = distSq;
-                        }
-                    }
-                }
-            }
-        }
+void BotWorldData::trimRetained(size_t budgetBytes)
+{
+    while (retainedBytes > budgetBytes && evictOldestRetained()) {
     }
+}
 
-    return nearest;
+void BotWorldData::publishSnapshot()
+{
+    const std::shared_ptr<const WorldSnapshot> current = snapshot();
+    if (unpublished.isEmpty() && current->dimension == currentDimension) {
+        return;
+    }
+    // Only the region table and the regions holding a changed chunk are copied; chunk
+    // handles are shallow ChunkData copies sharing their sections with the live world.
+    auto next = std::make_shared<WorldSnapshot>(*current);
+    next->dimension = currentDimension;
+    next->chunkCount = static_cast<int>(chunks.size());
+    QHash<ChunkPos, WorldSnapshot::Region> changed;
+    for (const ChunkPos& pos : std::as_const(unpublished)) {
+        const ChunkPos regionPos = WorldSnapshot::regionOf(pos);
+        auto region = changed.find(regionPos);
+        if (region == changed.end()) {
+            const std::shared_ptr<const WorldSnapshot::Region> old = next->regions.value(regionPos);
+            region = changed.insert(regionPos, old ? *old : WorldSnapshot::Region());
+        }
+        auto live = chunks.constFind(pos);
+        if (live != chunks.constEnd()) {
+            region->insert(pos, std::make_shared<const ChunkData>(live.value()));
+        } else {
+            region->remove(pos);
+        }
+    }
+    unpublished.clear();
+    for (auto it = changed.begin(); it != changed.end(); ++it) {
+        if (it->isEmpty()) {
+            next->regions.remove(it.key());
+        } else {
+            next->regions.insert(it.key(), std::make_shared<const WorldSnapshot::Region>(std::move(it.value())));
+        }
+    }
+    std::atomic_store(&published, std::shared_ptr<const WorldSnapshot>(std::move(next)));
 }
 
 size_t BotWorldData::totalMemoryUsage() const
@@ -470,16 +1053,47 @@ size_t BotWorldData::totalMemoryUsage() const
 void BotWorldData::updateEntities(const QVector<EntityData>& upserted, const QVector<int>& removed)
 {
     for (const auto &e : upserted) {
-        entities[e.entityId] = e;
+        auto it = entities.find(e.entityId);
+        if (it != entities.end()) {
+            unindexEntity(it.value());
+            it.value() = e;
+        } else {
+            entities.insert(e.entityId, e);
+        }
+        indexEntity(e);
     }
     for (int id : removed) {
-        entities.remove(id);
+        auto it = entities.find(id);
+        if (it != entities.end()) {
+            unindexEntity(it.value());
+            entities.erase(it);
+        }
+    }
+}
+
+const EntityData* BotWorldData::findEntity(int entityId) const
+{
+    auto it = entities.constFind(entityId);
+    return it == entities.constEnd() ? nullptr : &it.value();
+}
+
+const EntityData* BotWorldData::patchEntity(int entityId, const std::function<void(EntityData&)>& patch)
+{
+    auto it = entities.find(entityId);
+    if (it == entities.end()) {
+        return nullptr;
     }
+    EntityData& entity = it.value();
+    unindexEntity(entity);
+    patch(entity);
+    entity.entityId = entityId;
+    indexEntity(entity);
+    return &entity;
 }
 
-QVector<EntityData> BotWorldData::getAllEntities() const
+QHash<int, EntityData> BotWorldData::getAllEntities() const
 {
-    return entities.values();
+    return entities;
 }
 
 QVector<EntityData> BotWorldData::findEntitiesNear(double x, double y, double z, double radius,
@@ -487,16 +1101,85 @@ QVector<EntityData> BotWorldData::findEntitiesNear(double x, double y, double z,
 {
     QVector<EntityData> result;
     const double radiusSq = radius * radius;
+    auto inRange = [&](const EntityData& e) {
+        const double dx = e.x - x;
+        const double dy = e.y - y;
+        const double dz = e.z - z;
+        return dx * dx + dy * dy + dz * dz <= radiusSq;
+    };
+
+    // Types the filter selects, and how many entities have them
+    QSet<quint32> typeIds;
+    qsizetype typedCount = 0;
+    if (!typeFilter.isEmpty()) {
+        for (auto it = entitiesByType.constBegin(); it != entitiesByType.constEnd(); ++it) {
+            if (it->type.startsWith(typeFilter)) {
+                typeIds.insert(it.key());
+                typedCount += it->ids.size();
+            }
+        }
+        if (typeIds.isEmpty()) {
+            return result;
+        }
+    }
 
-    for (const auto &e : entities) {
-        if (!typeFilter.isEmpty() && !e.type.startsWith(typeFilter)) {
-            continue;
+    // Cells overlapping the query's bounding box
+    const double reach = std::sqrt(radiusSq);
+    const int cx0 = entityCellCoord(x - reach, kEntityCellLimitXZ), cx1 = entityCellCoord(x + reach, kEntityCellLimitXZ);
+    const int cy0 = entityCellCoord(y - reach, kEntityCellLimitY), cy1 = entityCellCoord(y + reach, kEntityCellLimitY);
+    const int cz0 = entityCellCoord(z - reach, kEntityCellLimitXZ), cz1 = entityCellCoord(z + reach, kEntityCellLimitXZ);
+    const double boxCells = (double(cx1) - cx0 + 1) * (double(cy1) - cy0 + 1) * (double(cz1) - cz0 + 1);
+
+    QVector<const QHash<int, quint32>*> cells;
+    if (boxCells <= entityCells.size()) {
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cz = cz0; cz <= cz1; ++cz) {
+                for (int cx = cx0; cx <= cx1; ++cx) {
+                    auto it = entityCells.constFind(entityCellKey(cx, cy, cz));
+                    if (it != entityCells.constEnd()) {
+                        cells.append(&it.value());
+                    }
+                }
+            }
+        }
+    } else {
+        // Large radius: cheaper to walk the occupied cells
+        for (auto it = entityCells.constBegin(); it != entityCells.constEnd(); ++it) {
+            int cx, cy, cz;
+            entityCellCoords(it.key(), cx, cy, cz);
+            if (cx >= cx0 && cx <= cx1 && cy >= cy0 && cy <= cy1 && cz >= cz0 && cz <= cz1) {
+                cells.append(&it.value());
+            }
+        }
+    }
+
+    qsizetype cellCount = 0;
+    for (const auto* cell : std::as_const(cells)) {
+        cellCount += cell->size();
+    }
+
+    // Rare types near a crowd: go through the type buckets instead of the cells
+    if (!typeIds.isEmpty() && typedCount < cellCount) {
+        for (quint32 typeId : std::as_const(typeIds)) {
+            for (int id : entitiesByType.constFind(typeId)->ids) {
+                const EntityData& e = *entities.constFind(id);
+                if (inRange(e)) {
+                    result.append(e);
+                }
+            }
         }
-        double dx = e.x - x;
-        double dy = e.y - y;
-        double dz = e.z - z;
-        if (dx * dx + dy * dy + dz * dz <= radiusSq) {
-            result.append(e);
+        return result;
+    }
+
+    for (const auto* cell : std::as_const(cells)) {
+        for (auto it = cell->constBegin(); it != cell->constEnd(); ++it) {
+            if (!typeIds.isEmpty() && !typeIds.contains(it.value())) {
+                continue;
+            }
+            const EntityData& e = *entities.constFind(it.key());
+            if (inRange(e)) {
+                result.append(e);
+            }
         }
     }
     return result;
@@ -505,89 +1188,109 @@ QVector<EntityData> BotWorldData::findEntitiesNear(double x, double y, double z,
 void BotWorldData::clearEntities()
 {
     entities.clear();
+    entityCells.clear();
+    entitiesByType.clear();
+}
+
+void BotWorldData::indexEntity(const EntityData& entity)
+{
+    const quint32 typeId = StringInterner::idFor(entity.type);
+    entityCells[entityCellKey(entity)].insert(entity.entityId, typeId);
+    EntityTypeBucket& bucket = entitiesByType[typeId];
+    if (bucket.ids.isEmpty()) {
+        bucket.type = entity.type;
+    }
+    bucket.ids.insert(entity.entityId);
+}
+
+void BotWorldData::unindexEntity(const EntityData& entity)
+{
+    auto cell = entityCells.find(entityCellKey(entity));
+    if (cell == entityCells.end()) {
+        return;
+    }
+    auto slot = cell->find(entity.entityId);
+    if (slot == cell->end()) {
+        return;
+    }
+    const quint32 typeId = slot.value();
+    cell->erase(slot);
+    if (cell->isEmpty()) {
+        entityCells.erase(cell);
+    }
+    auto bucket = entitiesByType.find(typeId);
+    if (bucket != entitiesByType.end()) {
+        bucket->ids.remove(entity.entityId);
+        if (bucket->ids.isEmpty()) {
+            entitiesByType.erase(bucket);
+        }
+    }
 }
 
 void BotWorldData::clearWorldState()
 {
+    for (auto it = chunks.constBegin(); it != chunks.constEnd(); ++it) {
+        unpublished.insert(it.key());
+    }
     chunks.clear();
-    entities.clear();
+    editedSections.clear();
+    retained.clear();
+    retainedOrder.clear();
+    retainedBytes = 0;
+    clearEntities();
     blockEntities.clear();
 }
 
 void BotWorldData::updateBlockEntity(const BlockEntityData& be)
 {
-    BlockEntityPos key{be.dimension, be.x, be.y, be.z};
+    BlockEntityData& stored = blockEntities[be.dimension][ChunkPos(be.x >> 4, be.z >> 4)]
+                                           [blockEntitySlot(be.x, be.y, be.z)];
 
     // When a container is opened we get items but no rawNbt. Preserve the rawNbt that
     // arrived with the chunk load so blockEntityToNBT can patch items into it rather
     // than falling back to the stripped structured path.
-    if (!be.items.isEmpty() && be.rawNbt.isEmpty()) {
-        auto it = blockEntities.find(key);
-        if (it != blockEntities.end() && !it->rawNbt.isEmpty()) {
-            BlockEntityData merged = be;
-            merged.rawNbt = it->rawNbt;
-            blockEntities[key] = merged;
-            return;
-        }
+    if (!be.items.isEmpty() && be.rawNbt.isEmpty() && !stored.rawNbt.isEmpty()) {
+        QByteArray rawNbt = stored.rawNbt;
+        stored = be;
+        stored.rawNbt = rawNbt;
+        return;
     }
 
-    blockEntities[key] = be;
+    stored = be;
 }
 
 void BotWorldData::removeBlockEntity(int x, int y, int z, const QString& dimension)
 {
-    blockEntities.remove({dimension, x, y, z});
+    auto dim = blockEntities.find(dimension);
+    if (dim == blockEntities.end()) return;
+    auto chunk = dim->find(ChunkPos(x >> 4, z >> 4));
+    if (chunk == dim->end()) return;
+
+    chunk->remove(blockEntitySlot(x, y, z));
+    if (chunk->isEmpty()) {
+        dim->erase(chunk);
+        if (dim->isEmpty()) {
+            blockEntities.erase(dim);
+        }
+    }
 }
 
 std::optional<BlockEntityData> BotWorldData::getBlockEntity(int x, int y, int z, const QString& dimension) const
 {
-    auto it = blockEntities.find({dimension, x, y, z});
-    if (it == blockEntities.end()) return std::nullopt;
+    auto dim = blockEntities.constFind(dimension);
+    if (dim == blockEntities.constEnd()) return std::nullopt;
+    auto chunk = dim->constFind(ChunkPos(x >> 4, z >> 4));
+    if (chunk == dim->constEnd()) return std::nullopt;
+    auto it = chunk->constFind(blockEntitySlot(x, y, z));
+    if (it == chunk->constEnd()) return std::nullopt;
     return it.value();
 }
 
 QVector<BlockEntityData> BotWorldData::getBlockEntitiesInChunk(int chunkX, int chunkZ, const QString& dimension) const
 {
-    QVector<BlockEntityData> result;
-    int minX = chunkX * 16;
-    int maxX = minX + 15;
-    int minZ = chunkZ * 16;
-    int maxZ = minZ + 15;
-
-    for (const auto& be : blockEntities) {
-        if (be.dimension == dimension &&
-            be.x >= minX && be.x <= maxX &&
-            be.z >= minZ && be.z <= maxZ)
-        {
-            result.append(be);
-        }
-    }
-    return result;
-}
-
-bool BotWorldData::blockMatches(const QString& blockState, const QStringList& blockTypes) const
-{
-    for (const QString& type : blockTypes) {
-        // Exact match
-        if (blockState == type) {
-            return true;
-        }
-
-        // Match without properties (e.g., "minecraft:chest" matches "minecraft:chest[facing=north]")
-        if (blockState.startsWith(type + "[")) {
-            return true;
-        }
-
-        // Wildcard match (e.g., "*:chest" or "minecraft:*_ore")
-        if (type.contains('*')) {
-            QString pattern = QRegularExpression::escape(type);
-            pattern.replace("\\*", ".*");
-            QRegularExpression regex("^" + pattern);
-            if (regex.match(blockState).hasMatch()) {
-                return true;
-            }
-        }
-    }
-
-    return false;
+    auto dim = blockEntities.constFind(dimension);
+    if (dim == blockEntities.constEnd()) return {};
+    auto chunk = dim->constFind(ChunkPos(chunkX, chunkZ));
+    if (chunk == dim->constEnd()) return {};
+    return chunk->values();
 }
@@ -2,14 +2,22 @@
 #define WORLDDATA_H
 
 #include <QHash>
+#include <QAtomicInteger>
 #include <QMap>
+#include <QSet>
 #include <QByteArray>
 #include <QString>
 #include <QVector3D>
 #include <QVector>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <qobject.h>
 #include "common.qpb.h"
+#include "world/BlockRegistry.h"
+
+class BlockPredicate;
 
 struct BlockEntityData {
     int x = 0, y = 0, z = 0;
@@ -89,24 +97,52 @@ inline size_t qHash(const BlockEntityPos& pos, size_t seed = 0) {
 }
 
 // 16x16x16 chunk section with palette-based block storage (matches Minecraft format).
+// Palettes hold global block state ids; names are only resolved through the chunk's BlockRegistry.
+// Indices stay bit-packed in the PackedIndices layout, at the width the client sent or the
+// smallest one that fits the palette. Chunks hold sections as shared_ptr<const ChunkSection>
+// and copy a section before writing to it if anything else still references it.
 struct ChunkSection {
-    int32_t sectionY = 0;
-    QVector<QString> palette;          // Block state strings (e.g., "minecraft:stone")
-    QVector<uint32_t> blockIndices;    // 4096 entries in YZX order
+    QVector<uint32_t> palette;         // Global block state ids (BlockRegistry)
+    QByteArray packedIndices;          // 4096 palette indices in YZX order; empty if uniform
+    int bitsPerEntry = 0;              // Width of each entry in packedIndices
     bool uniform = false;              // If true, entire section is palette[0]
-    QVector<QString> biomePalette;     // Biome resource IDs (e.g., "minecraft:plains")
-    QVector<uint32_t> biomeIndices;    // 64 entries in 4x4x4 grid (index = y*16 + z*4 + x); empty if biomeUniform
+    QVector<quint32> biomePalette;     // Biome ids from StringInterner::idFor (e.g., "minecraft:plains")
+    QByteArray biomeIndices;           // 64 one-byte entries in 4x4x4 grid (index = y*16 + z*4 + x); empty if biomeUniform
     bool biomeUniform = false;         // If true, entire section is biomePalette[0]
     QByteArray blockLight;             // 2048-byte nibble array; empty if not present
     QByteArray skyLight;               // 2048-byte nibble array; empty in nether/end or if not present
 
-    QString getBlock(int localX, int localY, int localZ) const;  // localX/Y/Z: 0-15; index order: y*256 + z*16 + x
-    void setBlock(int localX, int localY, int localZ, const QString& blockState);
+    uint32_t getStateId(int localX, int localY, int localZ) const;  // localX/Y/Z: 0-15; index order: y*256 + z*16 + x
+    void setStateId(int localX, int localY, int localZ, uint32_t stateId);
+
+    void setIndices(const uint32_t* indices);  // 4096 palette indices, packed at the width the palette needs
+    void unpackIndices(uint32_t* out) const;   // 4096 palette indices; all 0 if uniform
 
     struct LightLevels { int block = 0; int sky = 0; };
+    struct LightRange {  // Inclusive bounds on LightLevels
+        int minBlock = 0, maxBlock = 15;
+        int minSky = 0, maxSky = 15;
+    };
     LightLevels getLight(int localX, int localY, int localZ) const;  // localX/Y/Z: 0-15; returns 0 for absent light
 
     size_t memoryUsage() const;
+
+    // Copy without unused palette entries, packed at the smallest width; nullptr if that saves nothing
+    std::shared_ptr<const ChunkSection> compacted() const;
+    // An identical uniform section already in use elsewhere, or `section` itself. Safe from any thread.
+    static std::shared_ptr<const ChunkSection> shareUniform(std::shared_ptr<const ChunkSection> section);
+    // Swaps an all-dark or all-bright nibble array for one shared instance
+    static void shareLight(QByteArray& light);
+
+    bool operator==(const ChunkSection& other) const;
+};
+
+// A section handed out for work off the GUI thread (see BotWorldData::takeEditedSections)
+struct SectionRef {
+    int32_t chunkX = 0;
+    int32_t chunkZ = 0;
+    int32_t sectionY = 0;
+    std::shared_ptr<const ChunkSection> section;
 };
 
 // Full chunk (16x16 columns, multiple sections vertically).
@@ -116,60 +152,145 @@ struct ChunkData {
     QString dimension;
     int32_t minY = -64;
     int32_t maxY = 320;
-    QMap<int32_t, ChunkSection> sections;
+    // Indexed by sectionY - minSectionY(); null entries are all air. Copying a chunk only copies pointers.
+    QVector<std::shared_ptr<const ChunkSection>> sections;
+    std::shared_ptr<const BlockRegistry> blockRegistry;  // Resolves palette ids; null reads as all air
+
+    int minSectionY() const { return minY >> 4; }
+    const ChunkSection* section(int sectionY) const;  // nullptr if absent
+    std::shared_ptr<const ChunkSection> sectionRef(int sectionY) const;
+    void setSection(int sectionY, std::shared_ptr<const ChunkSection> section);  // Ignored outside minY-maxY
+    ChunkSection* mutableSection(int sectionY);  // Unshares the section first; nullptr if absent
 
-    std::optional<QString> getBlock(int localX, int localY, int localZ) const;  // localX/Z: 0-15, localY: minY-maxY
+    std::optional<uint32_t> getStateId(int localX, int localY, int localZ) const;  // localX/Z: 0-15, localY: minY-maxY
+    std::optional<QString> getBlock(int localX, int localY, int localZ) const;  // getStateId resolved to a name
     ChunkSection::LightLevels getLight(int localX, int localY, int localZ) const;  // returns {0,0} if section missing
-    void setBlock(int localX, int localY, int localZ, const QString& blockState);
-    size_t memoryUsage() const;
-    int sectionCount() const { return sections.size(); }
+    void setStateId(int localX, int localY, int localZ, uint32_t stateId);
+    QString blockStateName(uint32_t stateId) const;  // "minecraft:air" for unknown ids
+    size_t memoryUsage() const;  // Shared sections are split between the chunks holding them
+    int sectionCount() const;
 };
 
 Q_DECLARE_METATYPE(ChunkData);
+Q_DECLARE_METATYPE(std::shared_ptr<const ChunkData>);
 Q_DECLARE_METATYPE(BlockEntityData);
 Q_DECLARE_METATYPE(PlayerSaveData);
 Q_DECLARE_METATYPE(MapData);
 Q_DECLARE_METATYPE(QVector<EntityData>);
 Q_DECLARE_METATYPE(QVector<BlockEntityData>);
 
+// Loaded chunks of a bot as of one BotWorldData::publishSnapshot call. Never modified once
+// published, and its sections are shared with the live world, so script threads can read it
+// without worldDataLock while the GUI thread keeps writing. It is freed when the last reader
+// drops it.
+struct WorldSnapshot {
+    // Chunks of one 32x32-chunk region. Regions are shared between consecutive snapshots,
+    // so publishing only copies the ones holding a changed chunk.
+    using Region = QHash<ChunkPos, std::shared_ptr<const ChunkData>>;
+    static ChunkPos regionOf(const ChunkPos& chunk) { return ChunkPos(chunk.x >> 5, chunk.z >> 5); }
+
+    QHash<ChunkPos, std::shared_ptr<const Region>> regions;  // Region position -> chunks
+    QString dimension;
+    int chunkCount = 0;
+
+    const ChunkData* chunk(int chunkX, int chunkZ) const;  // nullptr if not loaded
+    QVector<ChunkPos> chunkPositions() const;
+    std::optional<QString> getBlock(int x, int y, int z) const;  // nullopt if chunk not loaded
+    std::optional<ChunkSection::LightLevels> getLight(int x, int y, int z) const;
+};
+
 // Stores world data for a bot
 class BotWorldData {
 public:
     BotWorldData() = default;
 
-    std::optional<QString> getBlock(int x, int y, int z) const;  // Returns nullopt if chunk not loaded
-    void setBlock(int x, int y, int z, const QString& blockState);  // Creates chunk/section if needed
+    std::optional<uint32_t> getStateId(int x, int y, int z) const;  // Returns nullopt if chunk not loaded
+    std::optional<QString> getBlock(int x, int y, int z) const;     // Same, resolved to a block state name
+    void setStateId(int x, int y, int z, uint32_t stateId);         // Creates chunk/section if needed; no-op if unchanged
+    // Registry given to chunks created by setStateId
+    void setBlockRegistry(std::shared_ptr<const BlockRegistry> registry) { blockRegistry = std::move(registry); }
 
     // Returns nullopt if chunk not loaded; block/sky are 0-15 (sky is 0 in nether/end)
     std::optional<ChunkSection::LightLevels> getLight(int x, int y, int z) const;
-    // Apply incremental light updates for one section (empty data = clear to zero)
+    // Apply incremental light updates for one section (empty data = clear to zero); no-op if unchanged
     void updateSectionBlockLight(int chunkX, int chunkZ, int sectionY, const QByteArray& data);
     void updateSectionSkyLight(int chunkX, int chunkZ, int sectionY, const QByteArray& data);
 
-    void loadChunk(const ChunkData& chunk);
-    void unloadChunk(int chunkX, int chunkZ);
+    void loadChunk(const ChunkData& chunk);  // Any other version of it, loaded or retained, is dropped
+    // Sections written by setStateId since the last call, for background compaction
+    QVector<SectionRef> takeEditedSections();
+    // Current version of a section; section is null if it or its chunk is absent
+    SectionRef sectionRef(int chunkX, int chunkZ, int sectionY) const;
+    // Puts `replacement` in place of `expected` if the section has not changed since
+    bool replaceSection(const SectionRef& expected, std::shared_ptr<const ChunkSection> replacement);
+    void unloadChunk(int chunkX, int chunkZ);  // Moves the chunk to retention
     bool isChunkLoaded(int chunkX, int chunkZ) const;
     const ChunkData* getChunk(int chunkX, int chunkZ) const;  // Returns nullptr if not loaded
     QVector<ChunkPos> getLoadedChunks() const;
 
-    // Only searches loaded chunks
-    QVector<QVector3D> findBlocks(const QString& blockType, const QVector3D& center, int radius) const;
+    // Only searches loaded chunks. Types are BlockPredicate patterns.
+    QVector<QVector3D> findBlocks(const QString& blockType, const QVector3D& center, int radius,
+                                  const ChunkSection::LightRange& light = {}) const;
     std::optional<QVector3D> findNearestBlock(const QStringList& blockTypes, const QVector3D& start, int maxDistance = 128) const;
+    // The same over chunk snapshots, without the world lock: copies of ChunkData share their
+    // sections, which writers never change in place. Chunks are scanned in parallel on the
+    // global thread pool. Results are in `chunks` order, and ties for the nearest block go to
+    // the earlier chunk, so the outcome does not depend on scheduling.
+    static QVector<QVector3D> searchBlocks(const QVector<ChunkData>& chunks, const QStringList& blockTypes,
+                                           const QVector3D& center, int radius,
+                                           const ChunkSection::LightRange& light = {});
+    static std::optional<QVector3D> searchNearestBlock(const QVector<ChunkData>& chunks, const QStringList& blockTypes,
+                                                       const QVector3D& start, int maxDistance);
+    // Calls visit(x, y, z, distSq) in world coordinates for each block of `chunk` matching `predicate`,
+    // with y in minY-maxY, light within `light` and distSq to `center` at most limitSq, in YZX order.
+    // Sections with no matching palette entry or wholly beyond limitSq are skipped; the rest go
+    // through the BlockScan kernels. `visit` may lower limitSq to narrow the rest of the scan.
+    static void scanChunk(const ChunkData& chunk, const BlockPredicate& predicate, const QVector3D& center,
+                          int minY, int maxY, const double& limitSq, const ChunkSection::LightRange& light,
+                          const std::function<void(int, int, int, double)>& visit);
+
+    // Lock-free view for readers on other threads; lags the live data until the next publish
+    std::shared_ptr<const WorldSnapshot> snapshot() const { return std::atomic_load(&published); }
+    // Makes the current loaded chunks the snapshot. Call with the write lock held, before
+    // releasing it. Costs one chunk handle per chunk changed since the last call, plus a copy
+    // of the regions they are in; nothing if none changed.
+    void publishSnapshot();
 
     size_t totalMemoryUsage() const;
     int chunkCount() const { return chunks.size(); }
     QString getCurrentDimension() const { return currentDimension; }
-    void setCurrentDimension(const QString& dimension) { currentDimension = dimension; }
+    // Loaded chunks of other dimensions are moved to retention
+    void setCurrentDimension(const QString& dimension);
+
+    // Retention: unloaded chunks stay readable, per dimension, until trimRetained evicts
+    // them, least recently read first. Edited sections are compacted on the way in.
+    const ChunkData* getRetainedChunk(const QString& dimension, int chunkX, int chunkZ) const;  // Counts as a read
+    QVector<ChunkPos> getRetainedChunks(const QString& dimension) const;
+    void trimRetained(size_t budgetBytes);
+    // Lower bound on the last read of the least recently read retained chunk, comparable
+    // across bots; exact after a call to evictOldestRetained. nullopt if none. Only changed by
+    // the thread that writes this world, so that thread can call it without the lock.
+    std::optional<quint64> oldestRetainedUseBound() const;
+    // Evicts the least recently read retained chunk if it was last read at or before `notAfter`
+    bool evictOldestRetained(quint64 notAfter = std::numeric_limits<quint64>::max());
+    size_t retainedMemoryUsage() const { return retainedBytes; }
+    int retainedChunkCount() const { return retainedOrder.size(); }
 
-    // Entity tracking
+    // Entity tracking. Entities are bucketed into 16-block cells and by type, so radius and
+    // type queries only visit nearby cells or the matching types, whichever holds fewer.
     void updateEntities(const QVector<EntityData>& upserted, const QVector<int>& removed);
-    QVector<EntityData> getAllEntities() const;
+    const EntityData* findEntity(int entityId) const;  // nullptr if not tracked
+    // Applies `patch` to a tracked entity and reindexes it; returns the result, or nullptr if not tracked
+    const EntityData* patchEntity(int entityId, const std::function<void(EntityData&)>& patch);
+    QHash<int, EntityData> getAllEntities() const;  // Shared until the next entity update
+    // typeFilter matches types starting with it
     QVector<EntityData> findEntitiesNear(double x, double y, double z, double radius,
                                          const QString& typeFilter = "") const;
     void clearEntities();
     void clearWorldState();
 
-    // Block entity tracking
+    // Block entity tracking. Stored in per-chunk buckets, so chunk and position lookups
+    // don't depend on how many block entities are tracked in total.
     void updateBlockEntity(const BlockEntityData& be);
     void removeBlockEntity(int x, int y, int z, const QString& dimension);
     std::optional<BlockEntityData> getBlockEntity(int x, int y, int z, const QString& dimension) const;
@@ -178,10 +299,46 @@ public:
 private:
     QHash<ChunkPos, ChunkData> chunks;
     QString currentDimension;
+    // Shares sections with chunks until a write copies them. Accessed with std::atomic_load/store.
+    std::shared_ptr<const WorldSnapshot> published = std::make_shared<WorldSnapshot>();
+    QSet<ChunkPos> unpublished;  // Chunks written, loaded or unloaded since the last publish
     QHash<int, EntityData> entities;
-    QHash<BlockEntityPos, BlockEntityData> blockEntities;
+    // Cell key (entityCellKey) -> entity id -> type id (StringInterner::idFor)
+    QHash<quint64, QHash<int, quint32>> entityCells;
+    struct EntityTypeBucket {
+        QString type;
+        QSet<int> ids;
+    };
+    QHash<quint32, EntityTypeBucket> entitiesByType;  // Type id -> entities of that type
+    // Dimension -> chunk -> block entities of the chunk by blockEntitySlot
+    QHash<QString, QHash<ChunkPos, QHash<qint64, BlockEntityData>>> blockEntities;
+    std::shared_ptr<const BlockRegistry> blockRegistry;
+    QHash<ChunkPos, QSet<int>> editedSections;  // Chunk -> section Ys written since takeEditedSections
+
+    struct RetainedChunk {
+        ChunkData chunk;
+        size_t bytes = 0;
+        quint64 queuedUse = 0;                    // Key of this chunk in retainedOrder
+        mutable QAtomicInteger<quint64> lastUse;  // Bumped by readers holding only the read lock
+    };
+    struct RetainedKey {
+        QString dimension;
+        ChunkPos pos;
+    };
+    QHash<QString, QHash<ChunkPos, RetainedChunk>> retained;  // Dimension -> unloaded chunks
+    // Oldest first. Reads only bump lastUse; an entry read since it was queued is
+    // moved back when it reaches the front (settleRetainedOrder).
+    QMap<quint64, RetainedKey> retainedOrder;
+    size_t retainedBytes = 0;
+
+    QVector<ChunkData> chunksInRange(const QVector3D& center, int radius) const;  // Loaded chunks, as snapshots
+
+    void indexEntity(const EntityData& entity);
+    void unindexEntity(const EntityData& entity);
 
-    bool blockMatches(const QString& blockState, const QStringList& blockTypes) const;  // Handles exact matches and wildcards
+    void retainChunk(ChunkData chunk);
+    void dropRetained(const QString& dimension, const ChunkPos& pos);
+    void settleRetainedOrder();
 };
 
 #endif // WORLDDATA_H
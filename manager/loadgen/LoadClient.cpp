@@ -0,0 +1,277 @@
+#include "LoadClient.h"
+#include "loadgen/LoadConfig.h"
+#include "connection.qpb.h"
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QUuid>
+#include <QtEndian>
+#include <cmath>
+
+namespace {
+
+using ProtocolFeature = mankool::mcbot::protocol::ProtocolFeatureGadget::ProtocolFeature;
+
+constexpr quint32 kHeartbeatAck = static_cast<quint32>(ProtocolFeature::HEARTBEAT_ACK);
+constexpr quint32 kPackedBlockIndices = static_cast<quint32>(ProtocolFeature::PACKED_BLOCK_INDICES);
+
+// Stop queueing bulk frames once this much is waiting in a socket's write
+// buffer; past that point the manager isn't reading and queueing more only
+// measures how much memory the generator has
+constexpr qint64 kMaxBufferedBytes = 16 * 1024 * 1024;
+constexpr quint32 kMaxInboundFrame = 64 * 1024 * 1024;
+
+// Fake player uuids are derived from the name, so reruns reuse the same test bots
+const QUuid kUuidNamespace("{6c6f6164-6765-6e2d-6d63-626f74000000}");
+
+} // namespace
+
+LoadClient::LoadClient(int index, const LoadConfig &config, SyntheticWorld &world, LoadStats &stats, QObject *parent)
+    : QObject(parent)
+    , config(config)
+    , world(world)
+    , stats(stats)
+    , playerName(config.namePrefix + QString::number(index))
+    , playerUuid(QUuid::createUuidV5(kUuidNamespace, playerName).toString(QUuid::WithoutBraces))
+    , bot(playerName, playerUuid, config.viewDistance, static_cast<quint32>(index) + 1)
+    , nextChunk(index % world.chunkCount())
+{
+}
+
+void LoadClient::connectToManager(const QString &socketPath)
+{
+    socket = std::make_unique<QLocalSocket>();
+    connect(socket.get(), &QLocalSocket::connected, this, &LoadClient::onConnected);
+    connect(socket.get(), &QLocalSocket::readyRead, this, &LoadClient::onReadyRead);
+    connect(socket.get(), &QLocalSocket::disconnected, this, &LoadClient::onDisconnected);
+    connect(socket.get(), &QLocalSocket::errorOccurred, this, &LoadClient::onError);
+
+    currentState = State::Connecting;
+    handshakeTimer.start();
+    socket->connectToServer(socketPath);
+}
+
+void LoadClient::onConnected()
+{
+    mankool::mcbot::protocol::ConnectionInfo info;
+    info.setClientVersion("loadgen");
+    info.setModVersion(QCoreApplication::applicationVersion());
+    info.setPlayerName(playerName);
+    info.setPlayerUuid(playerUuid);
+    info.setStartupTime(QDateTime::currentMSecsSinceEpoch());
+    info.setProcessId(static_cast<int>(QCoreApplication::applicationPid()));
+    info.setDataVersion(config.dataVersion);
+    info.setVersionSeries("main");
+    info.setFeatureFlags(kHeartbeatAck | (config.packedIndices ? kPackedBlockIndices : 0));
+
+    mankool::mcbot::protocol::ClientToManagerMessage msg;
+    msg.setTimestamp(QDateTime::currentMSecsSinceEpoch());
+    msg.setConnectionInfo(info);
+    sendControl(msg);
+    currentState = State::AwaitFeatures;
+}
+
+void LoadClient::onReadyRead()
+{
+    readBuffer.append(socket->readAll());
+
+    qsizetype offset = 0;
+    while (readBuffer.size() - offset >= 4) {
+        const quint32 length = qFromLittleEndian<quint32>(readBuffer.constData() + offset);
+        if (length > kMaxInboundFrame) {
+            fail(QString("manager sent a %1 byte frame").arg(length));
+            return;
+        }
+        if (readBuffer.size() - offset - 4 < qsizetype(length)) {
+            break;
+        }
+
+        mankool::mcbot::protocol::ManagerToClientMessage msg;
+        const QByteArray payload = readBuffer.mid(offset + 4, length);
+        offset += 4 + length;
+        if (serializer.deserialize(&msg, payload)) {
+            handleMessage(msg);
+            if (currentState == State::Failed) {
+                return;
+            }
+        }
+    }
+    readBuffer.remove(0, offset);
+}
+
+void LoadClient::handleMessage(const mankool::mcbot::protocol::ManagerToClientMessage &msg)
+{
+    using Fields = mankool::mcbot::protocol::ManagerToClientMessage::PayloadFields;
+
+    switch (msg.payloadField()) {
+    case Fields::ProtocolFeatures: {
+        features = msg.protocolFeatures().featureFlags();
+        if (!(features & kHeartbeatAck)) {
+            fail("manager doesn't support HEARTBEAT_ACK; it needs to be the same version as mcbot-loadgen");
+            return;
+        }
+        mankool::mcbot::protocol::QueryBlockRegistryMessage query;
+        query.setDataVersion(config.dataVersion);
+        mankool::mcbot::protocol::ClientToManagerMessage reply;
+        reply.setQueryRegistry(query);
+        sendControl(reply);
+        currentState = State::AwaitRegistry;
+        break;
+    }
+    case Fields::RegistryResponse:
+        if (currentState != State::AwaitRegistry) {
+            break;
+        }
+        if (msg.registryResponse().status() == mankool::mcbot::protocol::RegistryStatusGadget::RegistryStatus::NEED_IT) {
+            mankool::mcbot::protocol::ClientToManagerMessage reply;
+            reply.setBlockRegistry(SyntheticWorld::blockRegistry(config.dataVersion));
+            sendBulk(serializer.serialize(&reply), -1);
+        }
+        currentState = State::Streaming;
+        break;
+    case Fields::Heartbeat:
+        handleHeartbeatAck(msg);
+        break;
+    default:
+        // Commands the manager sends every new bot (module lists, proxy config) go unanswered
+        break;
+    }
+}
+
+void LoadClient::handleHeartbeatAck(const mankool::mcbot::protocol::ManagerToClientMessage &msg)
+{
+    const qint64 now = stats.clock.nsecsElapsed();
+
+    auto inFlight = heartbeatsInFlight.find(msg.messageId());
+    if (inFlight != heartbeatsInFlight.end()) {
+        if (PhaseStats *phase = stats.phase(inFlight->phase)) {
+            phase->heartbeatRttNs.append(now - inFlight->sentNs);
+        }
+        heartbeatsInFlight.erase(inFlight);
+    }
+
+    const quint64 handled = msg.heartbeat().bulkMessagesHandled();
+    while (bulkFramesAcked < handled && !unacked.empty()) {
+        const SentFrame &frame = unacked.front();
+        if (PhaseStats *phase = stats.phase(frame.phase)) {
+            ++phase->framesAcked;
+            phase->dataLatencyNs.append(now - frame.sentNs);
+        }
+        unacked.pop_front();
+        ++bulkFramesAcked;
+    }
+}
+
+void LoadClient::tick(double elapsedSec, double rateScale, int phase)
+{
+    if (currentState != State::Streaming) {
+        if (currentState != State::Failed && currentState != State::Idle
+            && handshakeTimer.elapsed() > config.handshakeTimeoutMs) {
+            fail("handshake timed out; is the manager running with --accept-test-clients?");
+        }
+        return;
+    }
+    if (phase < 0) {
+        return;
+    }
+
+    // Owed messages are sent now; if the socket is backed up they are dropped, not carried over
+    auto take = [elapsedSec, rateScale](double &credit, double rate) {
+        credit += rate * rateScale * elapsedSec;
+        const double whole = std::floor(credit);
+        credit -= whole;
+        return static_cast<int>(whole);
+    };
+
+    for (int n = take(playerCredit, config.playerRate); n > 0; --n) {
+        mankool::mcbot::protocol::ClientToManagerMessage msg;
+        msg.setPlayerState(bot.playerState());
+        sendBulk(serializer.serialize(&msg), phase);
+    }
+    for (int n = take(entityCredit, config.entityRate); n > 0; --n) {
+        mankool::mcbot::protocol::ClientToManagerMessage msg;
+        msg.setEntityUpdate(bot.entityUpdate(config.entitiesPerUpdate));
+        sendBulk(serializer.serialize(&msg), phase);
+    }
+    for (int n = take(multiBlockCredit, config.multiBlockRate); n > 0; --n) {
+        mankool::mcbot::protocol::ClientToManagerMessage msg;
+        msg.setMultiBlockUpdate(bot.multiBlockUpdate(config.blocksPerUpdate));
+        sendBulk(serializer.serialize(&msg), phase);
+    }
+    const bool packed = (features & kPackedBlockIndices) != 0;
+    for (int n = take(chunkCredit, config.chunkRate); n > 0; --n) {
+        sendBulk(world.chunkFrame(nextChunk, packed), phase);
+        nextChunk = (nextChunk + 1) % world.chunkCount();
+    }
+}
+
+void LoadClient::sendHeartbeat(int phase)
+{
+    if (currentState != State::Streaming) {
+        return;
+    }
+
+    const QString messageId = QString("hb-%1").arg(nextHeartbeatId++);
+    mankool::mcbot::protocol::HeartbeatMessage heartbeat;
+    heartbeat.setBulkQueueDepth(static_cast<quint32>(unacked.size()));
+
+    mankool::mcbot::protocol::ClientToManagerMessage msg;
+    msg.setMessageId(messageId);
+    msg.setTimestamp(QDateTime::currentMSecsSinceEpoch());
+    msg.setHeartbeat(heartbeat);
+    heartbeatsInFlight.insert(messageId, SentFrame{stats.clock.nsecsElapsed(), phase});
+    sendControl(msg);
+}
+
+void LoadClient::sendControl(mankool::mcbot::protocol::ClientToManagerMessage &msg)
+{
+    writeFrame(serializer.serialize(&msg));
+}
+
+bool LoadClient::sendBulk(const QByteArray &payload, int phase)
+{
+    PhaseStats *phaseStats = stats.phase(phase);
+    if (socket->bytesToWrite() > kMaxBufferedBytes) {
+        if (phaseStats) {
+            ++phaseStats->framesSkipped;
+        }
+        return false;
+    }
+
+    writeFrame(payload);
+    unacked.push_back(SentFrame{stats.clock.nsecsElapsed(), phase});
+    ++bulkFramesSent;
+    if (phaseStats) {
+        ++phaseStats->framesSent;
+        phaseStats->bytesSent += payload.size() + 4;
+    }
+    return true;
+}
+
+void LoadClient::writeFrame(const QByteArray &payload)
+{
+    char prefix[4];
+    qToLittleEndian<quint32>(static_cast<quint32>(payload.size()), prefix);
+    socket->write(prefix, sizeof(prefix));
+    socket->write(payload);
+}
+
+void LoadClient::onDisconnected()
+{
+    fail("manager closed the connection");
+}
+
+void LoadClient::onError(QLocalSocket::LocalSocketError)
+{
+    fail(socket->errorString());
+}
+
+void LoadClient::fail(const QString &reason)
+{
+    if (currentState == State::Failed) {
+        return;
+    }
+    error = reason;
+    socket->disconnect(this);
+    socket->abort();
+    currentState = State::Failed;
+}
@@ -0,0 +1,93 @@
+#ifndef LOADCLIENT_H
+#define LOADCLIENT_H
+
+#include <QObject>
+#include <QLocalSocket>
+#include <QElapsedTimer>
+#include <QHash>
+#include <deque>
+#include <memory>
+#include <QtProtobuf/QProtobufSerializer>
+#include "protocol.qpb.h"
+#include "loadgen/LoadStats.h"
+#include "loadgen/SyntheticTraffic.h"
+
+struct LoadConfig;
+
+// One fake bot: a socket to the manager that does the client side of the
+// handshake, then sends whatever LoadRunner asks for each tick.
+//
+// End-to-end latency comes from HEARTBEAT_ACK. Every bulk lane frame's send
+// time is queued; each heartbeat reply says how many bulk frames the manager
+// has handled, and everything up to that count is acknowledged. Heartbeats
+// themselves travel in the control lane, so their round trip shows how
+// responsive the GUI thread is even when bulk data is backed up.
+class LoadClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class State { Idle, Connecting, AwaitFeatures, AwaitRegistry, Streaming, Failed };
+
+    LoadClient(int index, const LoadConfig &config, SyntheticWorld &world, LoadStats &stats, QObject *parent = nullptr);
+
+    void connectToManager(const QString &socketPath);
+    State state() const { return currentState; }
+    QString errorString() const { return error; }
+
+    // Sends this tick's share of each message type; rates are per second
+    void tick(double elapsedSec, double rateScale, int phase);
+    void sendHeartbeat(int phase);
+
+    quint64 bulkSent() const { return bulkFramesSent; }
+    quint64 bulkAcked() const { return bulkFramesAcked; }
+
+private slots:
+    void onConnected();
+    void onReadyRead();
+    void onDisconnected();
+    void onError(QLocalSocket::LocalSocketError socketError);
+
+private:
+    void handleMessage(const mankool::mcbot::protocol::ManagerToClientMessage &msg);
+    void handleHeartbeatAck(const mankool::mcbot::protocol::ManagerToClientMessage &msg);
+    void sendControl(mankool::mcbot::protocol::ClientToManagerMessage &msg);
+    bool sendBulk(const QByteArray &payload, int phase);
+    void writeFrame(const QByteArray &payload);
+    void fail(const QString &reason);
+
+    const LoadConfig &config;
+    SyntheticWorld &world;
+    LoadStats &stats;
+    const QString playerName;
+    const QString playerUuid;
+    SyntheticBot bot;
+
+    std::unique_ptr<QLocalSocket> socket;
+    QProtobufSerializer serializer;
+    QByteArray readBuffer;
+    State currentState = State::Idle;
+    QString error;
+    quint32 features = 0;
+    QElapsedTimer handshakeTimer;
+
+    // Fractional messages owed, carried between ticks
+    double chunkCredit = 0.0;
+    double entityCredit = 0.0;
+    double multiBlockCredit = 0.0;
+    double playerCredit = 0.0;
+    int nextChunk = 0;
+
+    struct SentFrame {
+        qint64 sentNs;
+        int phase;  // -1 for handshake traffic
+    };
+    std::deque<SentFrame> unacked;
+    quint64 bulkFramesSent = 0;
+    quint64 bulkFramesAcked = 0;
+
+    quint64 nextHeartbeatId = 1;
+    QHash<QString, SentFrame> heartbeatsInFlight;  // By message id
+};
+
+#endif // LOADCLIENT_H
@@ -0,0 +1,38 @@
+#ifndef LOADCONFIG_H
+#define LOADCONFIG_H
+
+#include <QString>
+
+// mcbot-loadgen settings; see main.cpp for the command line options
+struct LoadConfig {
+    QString socketPath;
+    int clients = 10;
+    QString namePrefix = "loadgen-";
+    int connectStaggerMs = 20;
+
+    // Per client, per second, before the phase's rate scale is applied
+    double chunkRate = 10.0;
+    double entityRate = 20.0;
+    double multiBlockRate = 10.0;
+    double playerRate = 20.0;
+
+    int entitiesPerUpdate = 8;
+    int blocksPerUpdate = 16;
+    int viewDistance = 8;       // Chunks are cycled through a (2 * viewDistance + 1)^2 grid
+    int dataVersion = 990001;   // Block registry version announced in the handshake; no release uses this one
+    bool packedIndices = true;  // Ask for PACKED_BLOCK_INDICES like the real client
+
+    int heartbeatMs = 100;      // Also the resolution of the data latency measurement
+    int phaseSeconds = 10;
+    double ramp = 1.0;          // Rate multiplier per phase; 1 runs a single phase
+    int maxPhases = 8;
+    int drainSeconds = 10;      // How long to wait for outstanding acks at the end
+
+    // A phase has fallen behind when either limit is exceeded
+    double maxLatencyMs = 250.0;
+    double maxBacklogGrowth = 0.10;  // Unacked growth over the phase, as a share of frames sent
+
+    int handshakeTimeoutMs = 10000;
+};
+
+#endif // LOADCONFIG_H
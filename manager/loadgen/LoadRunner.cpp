@@ -0,0 +1,286 @@
+#include "LoadRunner.h"
+#include "loadgen/LoadClient.h"
+#include <QTextStream>
+#include <algorithm>
+
+namespace {
+
+double percentileMs(QVector<qint64> samples, double p)
+{
+    if (samples.isEmpty()) {
+        return 0.0;
+    }
+    const int index = std::min<int>(samples.size() - 1, static_cast<int>(p * samples.size()));
+    std::nth_element(samples.begin(), samples.begin() + index, samples.end());
+    return samples[index] / 1e6;
+}
+
+double maxMs(const QVector<qint64> &samples)
+{
+    return samples.isEmpty() ? 0.0 : *std::max_element(samples.begin(), samples.end()) / 1e6;
+}
+
+double phaseSeconds(const PhaseStats &phase)
+{
+    return std::max<qint64>(1, phase.endNs - phase.startNs) / 1e9;
+}
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+} // namespace
+
+LoadRunner::LoadRunner(const LoadConfig &config, QObject *parent)
+    : QObject(parent)
+    , config(config)
+    , world(config.viewDistance)
+{
+    tickTimer.setTimerType(Qt::PreciseTimer);
+    tickTimer.setInterval(kTickMs);
+    connect(&tickTimer, &QTimer::timeout, this, &LoadRunner::tick);
+}
+
+void LoadRunner::start()
+{
+    stats.clock.start();
+    for (int i = 0; i < config.clients; ++i) {
+        clients.append(new LoadClient(i, config, world, stats, this));
+    }
+
+    out() << QString("Connecting %1 clients to %2").arg(config.clients).arg(config.socketPath) << Qt::endl;
+    connectNext();
+    lastTickNs = stats.clock.nsecsElapsed();
+    tickTimer.start();
+}
+
+void LoadRunner::connectNext()
+{
+    if (connectCursor >= clients.size()) {
+        return;
+    }
+    clients[connectCursor++]->connectToManager(config.socketPath);
+    // Staggered, so the manager sees a fleet starting up rather than a single burst
+    QTimer::singleShot(config.connectStaggerMs, this, &LoadRunner::connectNext);
+}
+
+void LoadRunner::tick()
+{
+    const qint64 now = stats.clock.nsecsElapsed();
+    const double elapsedSec = (now - lastTickNs) / 1e9;
+    if (PhaseStats *phase = stats.phase(currentPhase)) {
+        phase->maxTickLagNs = std::max(phase->maxTickLagNs, now - lastTickNs - qint64(kTickMs) * 1000000);
+    }
+    lastTickNs = now;
+
+    const int sendPhase = stage == Stage::Running ? currentPhase : -1;
+    for (LoadClient *client : std::as_const(clients)) {
+        client->tick(elapsedSec, rateScale, sendPhase);
+    }
+    // Heartbeats keep going while draining; their acks are what empties the backlog
+    if (now - lastHeartbeatNs >= qint64(config.heartbeatMs) * 1000000) {
+        lastHeartbeatNs = now;
+        for (LoadClient *client : std::as_const(clients)) {
+            client->sendHeartbeat(sendPhase);
+        }
+    }
+
+    switch (stage) {
+    case Stage::Connecting: {
+        if (connectCursor < clients.size()) {
+            break;
+        }
+        int streaming = 0;
+        int failed = 0;
+        for (const LoadClient *client : std::as_const(clients)) {
+            if (client->state() == LoadClient::State::Streaming) {
+                ++streaming;
+            } else if (client->state() == LoadClient::State::Failed) {
+                ++failed;
+            }
+        }
+        if (streaming + failed < clients.size()) {
+            break;
+        }
+
+        for (const LoadClient *client : std::as_const(clients)) {
+            if (client->state() == LoadClient::State::Failed) {
+                out() << "Client failed: " << client->errorString() << Qt::endl;
+                break;  // They usually all fail the same way
+            }
+        }
+        streamingClients = streaming;
+        if (streaming == 0) {
+            out() << "No client completed the handshake" << Qt::endl;
+            finish(1);
+            return;
+        }
+        out() << QString("%1 of %2 clients connected").arg(streaming).arg(clients.size()) << Qt::endl;
+        startPhase(0);
+        break;
+    }
+    case Stage::Running:
+        if (now - stats.phases[currentPhase].startNs >= qint64(config.phaseSeconds) * 1000000000) {
+            endPhase();
+        }
+        break;
+    case Stage::Draining:
+        if (backlog() == 0 || now - drainStartNs >= qint64(config.drainSeconds) * 1000000000) {
+            finish(0);
+        }
+        break;
+    case Stage::Done:
+        break;
+    }
+}
+
+void LoadRunner::startPhase(int index)
+{
+    PhaseStats phase;
+    phase.rateScale = rateScale;
+    phase.startNs = stats.clock.nsecsElapsed();
+    phase.backlogAtStart = backlog();
+    stats.phases.append(phase);
+    currentPhase = index;
+    stage = Stage::Running;
+}
+
+void LoadRunner::endPhase()
+{
+    PhaseStats &phase = stats.phases[currentPhase];
+    phase.endNs = stats.clock.nsecsElapsed();
+    phase.backlogAtEnd = backlog();
+
+    QString reason;
+    const bool behind = fellBehind(phase, &reason);
+    out() << QString("Phase %1 (x%2): %3 msg/s sent, p99 latency %4 ms so far%5")
+                 .arg(currentPhase + 1)
+                 .arg(phase.rateScale, 0, 'g', 3)
+                 .arg(phase.framesSent / phaseSeconds(phase), 0, 'f', 0)
+                 .arg(percentileMs(phase.dataLatencyNs, 0.99), 0, 'f', 1)
+                 .arg(behind ? QString(" - falling behind: %1").arg(reason) : QString())
+          << Qt::endl;
+
+    if (!behind && config.ramp > 1.0 && currentPhase + 1 < config.maxPhases) {
+        rateScale *= config.ramp;
+        startPhase(currentPhase + 1);
+        return;
+    }
+
+    stage = Stage::Draining;
+    drainStartNs = phase.endNs;
+}
+
+bool LoadRunner::fellBehind(const PhaseStats &phase, QString *reason) const
+{
+    if (phase.framesSkipped > 0) {
+        *reason = QString("%1 frames skipped with socket buffers full").arg(phase.framesSkipped);
+        return true;
+    }
+    const double p99 = percentileMs(phase.dataLatencyNs, 0.99);
+    if (p99 > config.maxLatencyMs) {
+        *reason = QString("p99 latency %1 ms over the %2 ms limit").arg(p99, 0, 'f', 1).arg(config.maxLatencyMs);
+        return true;
+    }
+    const double growth = phase.framesSent > 0
+        ? (double(phase.backlogAtEnd) - double(phase.backlogAtStart)) / phase.framesSent : 0.0;
+    if (growth > config.maxBacklogGrowth) {
+        *reason = QString("unacked backlog grew by %1 frames").arg(phase.backlogAtEnd - phase.backlogAtStart);
+        return true;
+    }
+    return false;
+}
+
+quint64 LoadRunner::backlog() const
+{
+    quint64 total = 0;
+    for (const LoadClient *client : clients) {
+        if (client->state() == LoadClient::State::Streaming) {
+            total += client->bulkSent() - client->bulkAcked();
+        }
+    }
+    return total;
+}
+
+void LoadRunner::finish(int exitCode)
+{
+    stage = Stage::Done;
+    tickTimer.stop();
+    if (!stats.phases.isEmpty()) {
+        report();
+    }
+    emit finished(exitCode);
+}
+
+void LoadRunner::report() const
+{
+    out() << Qt::endl
+          << QString("%1 clients; per client at x1: %2 chunks/s, %3 entity updates/s (%4 entities), "
+                     "%5 multi-block updates/s (%6 blocks), %7 player states/s")
+                 .arg(streamingClients)
+                 .arg(config.chunkRate).arg(config.entityRate).arg(config.entitiesPerUpdate)
+                 .arg(config.multiBlockRate).arg(config.blocksPerUpdate).arg(config.playerRate)
+          << Qt::endl
+          << QString("Latency runs from sending a frame to the first heartbeat ack covering it, so it reads up to %1 ms high")
+                 .arg(config.heartbeatMs)
+          << Qt::endl << Qt::endl;
+
+    out() << "phase  scale     msg/s     MB/s   acked   p50 ms   p99 ms   max ms   hb p99  status" << Qt::endl;
+
+    int lastGood = -1;
+    int firstBehind = -1;
+    QString behindReason;
+    for (int i = 0; i < stats.phases.size(); ++i) {
+        const PhaseStats &phase = stats.phases[i];
+        const double seconds = phaseSeconds(phase);
+        QString reason;
+        const bool behind = fellBehind(phase, &reason);
+        if (behind && firstBehind < 0) {
+            firstBehind = i;
+            behindReason = reason;
+        } else if (!behind && firstBehind < 0) {
+            lastGood = i;
+        }
+
+        QString status = behind ? QString("behind") : QString("ok");
+        if (phase.maxTickLagNs > qint64(kTickMs) * 2 * 1000000) {
+            // The generator itself couldn't keep its schedule, so the offered load is understated
+            status += QString(", generator lagged %1 ms").arg(phase.maxTickLagNs / 1e6, 0, 'f', 0);
+        }
+        out() << QString("%1 %2 %3 %4 %5 %6 %7 %8 %9  %10")
+                     .arg(i + 1, 5)
+                     .arg(phase.rateScale, 6, 'g', 3)
+                     .arg(phase.framesSent / seconds, 9, 'f', 0)
+                     .arg(phase.bytesSent / 1e6 / seconds, 8, 'f', 2)
+                     .arg(QString("%1%").arg(phase.framesSent > 0 ? 100.0 * phase.framesAcked / phase.framesSent : 100.0, 0, 'f', 1), 7)
+                     .arg(percentileMs(phase.dataLatencyNs, 0.50), 8, 'f', 1)
+                     .arg(percentileMs(phase.dataLatencyNs, 0.99), 8, 'f', 1)
+                     .arg(maxMs(phase.dataLatencyNs), 8, 'f', 1)
+                     .arg(percentileMs(phase.heartbeatRttNs, 0.99), 8, 'f', 1)
+                     .arg(status)
+              << Qt::endl;
+    }
+    out() << Qt::endl;
+
+    auto describe = [this](const PhaseStats &phase) {
+        const double seconds = phaseSeconds(phase);
+        return QString("x%1, %2 msg/s and %3 MB/s from %4 clients")
+            .arg(phase.rateScale, 0, 'g', 3)
+            .arg(phase.framesSent / seconds, 0, 'f', 0)
+            .arg(phase.bytesSent / 1e6 / seconds, 0, 'f', 2)
+            .arg(streamingClients);
+    };
+
+    if (firstBehind < 0) {
+        out() << "Kept up with every phase, up to " << describe(stats.phases.last())
+              << ". Raise --ramp, --max-phases or the rates to find the limit." << Qt::endl;
+    } else if (lastGood < 0) {
+        out() << "Fell behind in the first phase (" << behindReason
+              << "). Lower the rates or the client count." << Qt::endl;
+    } else {
+        out() << "Kept up through phase " << (lastGood + 1) << " (" << describe(stats.phases[lastGood])
+              << "); fell behind in phase " << (firstBehind + 1) << ": " << behindReason << "." << Qt::endl;
+    }
+}
@@ -0,0 +1,61 @@
+#ifndef LOADRUNNER_H
+#define LOADRUNNER_H
+
+#include <QObject>
+#include <QTimer>
+#include <QVector>
+#include "loadgen/LoadConfig.h"
+#include "loadgen/LoadStats.h"
+#include "loadgen/SyntheticTraffic.h"
+
+class LoadClient;
+
+// Connects the fake clients, then runs load phases, each at ramp times the
+// previous rate, until the manager falls behind or maxPhases is reached.
+// Afterwards it waits for outstanding acks and prints one line per phase
+// plus the highest load the manager kept up with.
+class LoadRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit LoadRunner(const LoadConfig &config, QObject *parent = nullptr);
+
+    void start();
+
+signals:
+    void finished(int exitCode);
+
+private slots:
+    void connectNext();
+    void tick();
+
+private:
+    enum class Stage { Connecting, Running, Draining, Done };
+
+    static constexpr int kTickMs = 50;
+
+    void startPhase(int index);
+    void endPhase();
+    bool fellBehind(const PhaseStats &phase, QString *reason) const;
+    quint64 backlog() const;
+    void finish(int exitCode);
+    void report() const;
+
+    LoadConfig config;
+    LoadStats stats;
+    SyntheticWorld world;
+    QVector<LoadClient*> clients;
+    int connectCursor = 0;
+    int streamingClients = 0;
+
+    QTimer tickTimer;
+    Stage stage = Stage::Connecting;
+    qint64 lastTickNs = 0;
+    qint64 lastHeartbeatNs = 0;
+    qint64 drainStartNs = 0;
+    int currentPhase = -1;
+    double rateScale = 1.0;
+};
+
+#endif // LOADRUNNER_H
@@ -0,0 +1,37 @@
+#ifndef LOADSTATS_H
+#define LOADSTATS_H
+
+#include <QVector>
+#include <QElapsedTimer>
+
+// What one load phase offered and how the manager kept up with it.
+// Samples are attributed to the phase their frame was sent in.
+struct PhaseStats {
+    double rateScale = 1.0;
+    qint64 startNs = 0;
+    qint64 endNs = 0;
+
+    quint64 framesSent = 0;     // Bulk lane frames
+    quint64 bytesSent = 0;
+    quint64 framesAcked = 0;
+    quint64 framesSkipped = 0;  // Not sent because a socket's write buffer was full
+    quint64 backlogAtStart = 0; // Unacked frames over all clients
+    quint64 backlogAtEnd = 0;
+    qint64 maxTickLagNs = 0;    // Generator falling behind its own schedule
+
+    QVector<qint64> dataLatencyNs;
+    QVector<qint64> heartbeatRttNs;
+};
+
+// Shared by LoadRunner and its clients; everything runs on one thread
+struct LoadStats {
+    QElapsedTimer clock;
+    QVector<PhaseStats> phases;
+
+    PhaseStats *phase(int index)
+    {
+        return index >= 0 && index < phases.size() ? &phases[index] : nullptr;
+    }
+};
+
+#endif // LOADSTATS_H
@@ -0,0 +1,220 @@
+#include "SyntheticTraffic.h"
+#include "world/PackedIndices.h"
+#include <QUuid>
+#include <cmath>
+
+namespace {
+
+const char *const kDimension = "minecraft:overworld";
+
+// Names for the synthetic registry. Real identifiers, so anything in the
+// manager that looks blocks up by name (solidity, scripts) behaves normally.
+const char *const kStateNames[SyntheticWorld::kStateCount] = {
+    "minecraft:air",
+    "minecraft:stone",
+    "minecraft:deepslate",
+    "minecraft:dirt",
+    "minecraft:grass_block[snowy=false]",
+    "minecraft:gravel",
+    "minecraft:andesite",
+    "minecraft:diorite",
+    "minecraft:granite",
+    "minecraft:coal_ore",
+    "minecraft:iron_ore",
+    "minecraft:copper_ore",
+    "minecraft:water[level=0]",
+    "minecraft:lava[level=0]",
+    "minecraft:cobblestone",
+    "minecraft:oak_planks",
+};
+
+// Sections below this absolute section Y are terrain, the rest is air
+constexpr int kTerrainTopSection = 4;
+constexpr int kSectionBlocks = 4096;
+constexpr double kPi = 3.14159265358979323846;
+
+} // namespace
+
+SyntheticWorld::SyntheticWorld(int viewDistance)
+    : viewDistance(viewDistance)
+    , gridSize(viewDistance * 2 + 1)
+{
+    plainFrames.resize(gridSize * gridSize);
+    packedFrames.resize(gridSize * gridSize);
+}
+
+const QByteArray &SyntheticWorld::chunkFrame(int index, bool packedIndices)
+{
+    QVector<QByteArray> &frames = packedIndices ? packedFrames : plainFrames;
+    QByteArray &frame = frames[index];
+    if (frame.isEmpty()) {
+        frame = buildChunk(index, packedIndices);
+    }
+    return frame;
+}
+
+QByteArray SyntheticWorld::buildChunk(int index, bool packedIndices)
+{
+    // Seeded by position, so both encodings of a chunk hold the same blocks
+    QRandomGenerator random(static_cast<quint32>(index) * 2654435761u + 1);
+
+    mankool::mcbot::protocol::ChunkDataMessage chunk;
+    chunk.setChunkX(index % gridSize - viewDistance);
+    chunk.setChunkZ(index / gridSize - viewDistance);
+    chunk.setDimension(kDimension);
+    chunk.setMinY(kMinY);
+    chunk.setMaxY(kMaxY);
+
+    const QByteArray darkness(2048, '\0');
+    const QByteArray daylight(2048, '\xff');
+
+    QList<mankool::mcbot::protocol::ChunkSection> sections;
+    for (int sectionY = kMinY / 16; sectionY < kMaxY / 16; ++sectionY) {
+        mankool::mcbot::protocol::ChunkSection section;
+        section.setSectionY(sectionY);
+        section.setBiomePalette({QStringLiteral("minecraft:plains")});
+        section.setBiomeUniform(true);
+
+        auto palette = section.palette();
+        if (sectionY >= kTerrainTopSection) {
+            palette.append(0);
+            section.setPalette(palette);
+            section.setUniform(true);
+            section.setSkyLight(daylight);
+            sections.append(section);
+            continue;
+        }
+
+        // Mostly one base block with a scattering of others, like real terrain
+        const int paletteSize = 4 + random.bounded(5);
+        palette.append(sectionY < 0 ? 2 : 1);
+        while (palette.size() < paletteSize) {
+            palette.append(static_cast<quint32>(3 + random.bounded(kStateCount - 3)));
+        }
+        section.setPalette(palette);
+
+        QVector<quint32> indices(kSectionBlocks);
+        for (quint32 &i : indices) {
+            i = random.bounded(8) == 0 ? static_cast<quint32>(random.bounded(paletteSize)) : 0;
+        }
+        if (packedIndices) {
+            const int bits = PackedIndices::bitsForPaletteSize(paletteSize);
+            section.setPackedBlockIndices(PackedIndices::pack(indices.constData(), indices.size(), bits));
+            section.setBitsPerEntry(static_cast<quint32>(bits));
+        } else {
+            auto blockIndices = section.blockIndices();
+            blockIndices.reserve(kSectionBlocks);
+            for (quint32 i : std::as_const(indices)) {
+                blockIndices.append(i);
+            }
+            section.setBlockIndices(blockIndices);
+        }
+        section.setSkyLight(darkness);
+        section.setBlockLight(darkness);
+        sections.append(section);
+    }
+    chunk.setSections(sections);
+
+    mankool::mcbot::protocol::ClientToManagerMessage msg;
+    msg.setChunkData(chunk);
+    return serializer.serialize(&msg);
+}
+
+mankool::mcbot::protocol::BlockRegistryMessage SyntheticWorld::blockRegistry(int dataVersion)
+{
+    mankool::mcbot::protocol::BlockRegistryMessage registry;
+    registry.setDataVersion(dataVersion);
+    auto states = registry.stateMap();
+    for (int id = 0; id < kStateCount; ++id) {
+        states.insert(static_cast<quint32>(id), QString::fromLatin1(kStateNames[id]));
+    }
+    registry.setStateMap(states);
+    return registry;
+}
+
+SyntheticBot::SyntheticBot(const QString &playerName, const QString &playerUuid, int viewDistance, quint32 seed)
+    : playerName(playerName)
+    , playerUuid(playerUuid)
+    , viewDistance(viewDistance)
+    , random(seed)
+{
+}
+
+mankool::mcbot::protocol::PlayerStateUpdate SyntheticBot::playerState()
+{
+    // Walks a slow circle around the origin so reachability caches see movement
+    const double angle = (ticks++ % 1200) * (2.0 * kPi / 1200.0);
+
+    mankool::mcbot::protocol::Vec3d position;
+    position.setX(8.0 + 24.0 * std::cos(angle));
+    position.setY(64.0);
+    position.setZ(8.0 + 24.0 * std::sin(angle));
+
+    mankool::mcbot::protocol::PlayerStateUpdate state;
+    state.setUuid(playerUuid);
+    state.setName(playerName);
+    state.setPosition(position);
+    state.setVelocity(mankool::mcbot::protocol::Vec3d());
+    state.setYaw(static_cast<float>(angle * 180.0 / kPi));
+    state.setOnGround(true);
+    state.setHealth(20.0f);
+    state.setFoodLevel(20);
+    state.setSaturation(5.0f);
+    state.setAir(300);
+    state.setDimension(kDimension);
+    return state;
+}
+
+mankool::mcbot::protocol::EntityUpdate SyntheticBot::entityUpdate(int entityCount)
+{
+    mankool::mcbot::protocol::EntityUpdate update;
+    update.setDimension(kDimension);
+
+    // Without ENTITY_DELTAS every change is a full record
+    QList<mankool::mcbot::protocol::EntityData> upserted;
+    upserted.reserve(entityCount);
+    const QUuid base = QUuid::fromString(playerUuid);
+    const double extent = 16.0 * viewDistance;
+    for (int i = 0; i < entityCount; ++i) {
+        mankool::mcbot::protocol::EntityData entity;
+        entity.setEntityId(1000 + i);
+        entity.setUuid(QUuid::createUuidV5(base, QString::number(i)).toString(QUuid::WithoutBraces));
+        entity.setType("minecraft:zombie");
+        entity.setX(random.bounded(2.0 * extent) - extent);
+        entity.setY(64.0);
+        entity.setZ(random.bounded(2.0 * extent) - extent);
+        entity.setYaw(static_cast<float>(random.bounded(360.0)));
+        entity.setIsLiving(true);
+        entity.setHealth(20.0f);
+        entity.setMaxHealth(20.0f);
+        upserted.append(entity);
+    }
+    update.setUpserted(upserted);
+    return update;
+}
+
+mankool::mcbot::protocol::MultiBlockUpdateMessage SyntheticBot::multiBlockUpdate(int blockCount)
+{
+    mankool::mcbot::protocol::MultiBlockUpdateMessage update;
+    update.setDimension(kDimension);
+
+    // One section of one loaded chunk, like the vanilla packet
+    const int chunkX = random.bounded(-viewDistance, viewDistance + 1);
+    const int chunkZ = random.bounded(-viewDistance, viewDistance + 1);
+    const int sectionY = random.bounded(SyntheticWorld::kMinY / 16, kTerrainTopSection);
+
+    QList<mankool::mcbot::protocol::BlockPos> positions;
+    auto stateIds = update.stateIds();
+    positions.reserve(blockCount);
+    for (int i = 0; i < blockCount; ++i) {
+        mankool::mcbot::protocol::BlockPos pos;
+        pos.setX(chunkX * 16 + random.bounded(16));
+        pos.setY(sectionY * 16 + random.bounded(16));
+        pos.setZ(chunkZ * 16 + random.bounded(16));
+        positions.append(pos);
+        stateIds.append(static_cast<quint32>(random.bounded(SyntheticWorld::kStateCount)));
+    }
+    update.setPositions(positions);
+    update.setStateIds(stateIds);
+    return update;
+}
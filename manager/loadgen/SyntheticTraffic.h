@@ -0,0 +1,61 @@
+#ifndef SYNTHETICTRAFFIC_H
+#define SYNTHETICTRAFFIC_H
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QRandomGenerator>
+#include <QtProtobuf/QProtobufSerializer>
+#include "protocol.qpb.h"
+
+// Made-up but realistically shaped client traffic for mcbot-loadgen.
+//
+// Chunks are the bulk of a real client's bytes and the most expensive to
+// build, so a grid of them is serialized once and shared by every fake
+// client; each bot's world is separate in the manager, so resending the same
+// chunks just replaces them. Everything else is small and built per message.
+class SyntheticWorld
+{
+public:
+    // Block states in the synthetic registry, ids 0..kStateCount-1
+    static constexpr int kStateCount = 16;
+    static constexpr int kMinY = -64;
+    static constexpr int kMaxY = 320;
+
+    explicit SyntheticWorld(int viewDistance);
+
+    // Serialized ClientToManagerMessage payloads (no length prefix)
+    const QByteArray &chunkFrame(int index, bool packedIndices);
+    int chunkCount() const { return gridSize * gridSize; }
+
+    static mankool::mcbot::protocol::BlockRegistryMessage blockRegistry(int dataVersion);
+
+private:
+    QByteArray buildChunk(int index, bool packedIndices);
+
+    int viewDistance;
+    int gridSize;
+    QVector<QByteArray> plainFrames;
+    QVector<QByteArray> packedFrames;
+    QProtobufSerializer serializer;
+};
+
+// Per-client generator for the small, frequently sent messages
+class SyntheticBot
+{
+public:
+    SyntheticBot(const QString &playerName, const QString &playerUuid, int viewDistance, quint32 seed);
+
+    mankool::mcbot::protocol::PlayerStateUpdate playerState();
+    mankool::mcbot::protocol::EntityUpdate entityUpdate(int entityCount);
+    mankool::mcbot::protocol::MultiBlockUpdateMessage multiBlockUpdate(int blockCount);
+
+private:
+    QString playerName;
+    QString playerUuid;
+    int viewDistance;
+    QRandomGenerator random;
+    quint64 ticks = 0;
+};
+
+#endif // SYNTHETICTRAFFIC_H
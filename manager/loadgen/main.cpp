@@ -0,0 +1,93 @@
+// mcbot-loadgen: connects many fake clients to a running manager and streams
+// synthetic world traffic at them, to find how many bots a machine can host.
+// The manager has to be started with --accept-test-clients.
+
+#include "loadgen/LoadConfig.h"
+#include "loadgen/LoadRunner.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <algorithm>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    app.setApplicationName("mcbot-loadgen");
+    app.setApplicationVersion(APP_VERSION);
+
+    LoadConfig config;
+    QByteArray xdgRuntime = qgetenv("XDG_RUNTIME_DIR");
+    config.socketPath = xdgRuntime.isEmpty() ? QString("/tmp/minecraft_manager")
+                                             : QString::fromUtf8(xdgRuntime) + "/minecraft_manager";
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(
+        "Connects fake clients to a running manager (started with --accept-test-clients) and\n"
+        "streams synthetic chunk, entity, multi-block and player traffic. Rates are per client\n"
+        "per second and are multiplied by --ramp every phase until the manager falls behind.");
+    parser.addHelpOption();
+    parser.addVersionOption();
+
+    QCommandLineOption socketOption("socket", "Manager socket path.", "path", config.socketPath);
+    QCommandLineOption clientsOption("clients", "Number of fake clients.", "n", QString::number(config.clients));
+    QCommandLineOption prefixOption("name-prefix", "Player name prefix; clients are <prefix>0, <prefix>1, ...",
+                                    "prefix", config.namePrefix);
+    QCommandLineOption chunksOption("chunks", "Chunk data messages.", "rate", QString::number(config.chunkRate));
+    QCommandLineOption entitiesOption("entities", "Entity update messages.", "rate", QString::number(config.entityRate));
+    QCommandLineOption entityCountOption("entity-count", "Entities per entity update.", "n",
+                                         QString::number(config.entitiesPerUpdate));
+    QCommandLineOption multiBlockOption("multiblock", "Multi-block update messages.", "rate",
+                                        QString::number(config.multiBlockRate));
+    QCommandLineOption blockCountOption("block-count", "Blocks per multi-block update.", "n",
+                                        QString::number(config.blocksPerUpdate));
+    QCommandLineOption playerOption("player", "Player state messages.", "rate", QString::number(config.playerRate));
+    QCommandLineOption viewDistanceOption("view-distance", "Radius in chunks of the synthetic world.", "chunks",
+                                          QString::number(config.viewDistance));
+    QCommandLineOption dataVersionOption("data-version", "Block registry data version to announce.", "version",
+                                         QString::number(config.dataVersion));
+    QCommandLineOption unpackedOption("unpacked", "Send chunk sections with unpacked block indices.");
+    QCommandLineOption heartbeatOption("heartbeat-ms", "Heartbeat (and ack) interval.", "ms",
+                                       QString::number(config.heartbeatMs));
+    QCommandLineOption phaseOption("phase-seconds", "Length of each load phase.", "s",
+                                   QString::number(config.phaseSeconds));
+    QCommandLineOption rampOption("ramp", "Rate multiplier per phase; 1 runs a single phase.", "factor",
+                                  QString::number(config.ramp));
+    QCommandLineOption maxPhasesOption("max-phases", "Most phases to run when ramping.", "n",
+                                       QString::number(config.maxPhases));
+    QCommandLineOption maxLatencyOption("max-latency-ms", "p99 latency at which the manager counts as behind.", "ms",
+                                        QString::number(config.maxLatencyMs));
+    QCommandLineOption drainOption("drain-seconds", "How long to wait for outstanding acks at the end.", "s",
+                                   QString::number(config.drainSeconds));
+
+    parser.addOptions({socketOption, clientsOption, prefixOption, chunksOption, entitiesOption, entityCountOption,
+                       multiBlockOption, blockCountOption, playerOption, viewDistanceOption, dataVersionOption,
+                       unpackedOption, heartbeatOption, phaseOption, rampOption, maxPhasesOption, maxLatencyOption,
+                       drainOption});
+    parser.process(app);
+
+    config.socketPath = parser.value(socketOption);
+    config.clients = std::max(1, parser.value(clientsOption).toInt());
+    config.namePrefix = parser.value(prefixOption);
+    config.chunkRate = std::max(0.0, parser.value(chunksOption).toDouble());
+    config.entityRate = std::max(0.0, parser.value(entitiesOption).toDouble());
+    config.entitiesPerUpdate = std::max(1, parser.value(entityCountOption).toInt());
+    config.multiBlockRate = std::max(0.0, parser.value(multiBlockOption).toDouble());
+    config.blocksPerUpdate = std::max(1, parser.value(blockCountOption).toInt());
+    config.playerRate = std::max(0.0, parser.value(playerOption).toDouble());
+    config.viewDistance = std::clamp(parser.value(viewDistanceOption).toInt(), 1, 32);
+    config.dataVersion = parser.value(dataVersionOption).toInt();
+    config.packedIndices = !parser.isSet(unpackedOption);
+    config.heartbeatMs = std::max(10, parser.value(heartbeatOption).toInt());
+    config.phaseSeconds = std::max(1, parser.value(phaseOption).toInt());
+    config.ramp = std::max(1.0, parser.value(rampOption).toDouble());
+    config.maxPhases = std::max(1, parser.value(maxPhasesOption).toInt());
+    config.maxLatencyMs = std::max(1.0, parser.value(maxLatencyOption).toDouble());
+    config.drainSeconds = std::max(0, parser.value(drainOption).toInt());
+
+    LoadRunner runner(config);
+    QObject::connect(&runner, &LoadRunner::finished, &app, [](int exitCode) {
+        QCoreApplication::exit(exitCode);
+    });
+    runner.start();
+    return app.exec();
+}
@@ -1,13 +1,18 @@
 #include "ui/ManagerMainWindow.h"
 #include "ui/GlobalSettingsDialog.h"
+#include "network/PipeServer.h"
+#include "network/PipeReplay.h"
 
 #include <QApplication>
+#include <QCommandLineParser>
 #include <QIcon>
+#include <QTimer>
 #include "bot/WorldData.h"
 
 int main(int argc, char *argv[])
 {
     qRegisterMetaType<ChunkData>();
+    qRegisterMetaType<std::shared_ptr<const ChunkData>>();
     qRegisterMetaType<BlockEntityData>();
     qRegisterMetaType<PlayerSaveData>();
     qRegisterMetaType<MapData>();
@@ -17,8 +22,55 @@ int main(int argc, char *argv[])
     a.setApplicationVersion(APP_VERSION);
     a.setDesktopFileName("mc-bot-manager");
     a.setWindowIcon(QIcon(":/icons/icons/mc-bot-manager.svg"));
+
+    QCommandLineParser parser;
+    parser.addHelpOption();
+    parser.addVersionOption();
+    QCommandLineOption captureOption("capture", "Record all inbound client traffic to <file>.", "file");
+    QCommandLineOption replayOption("replay", "Replay a capture <file> through the message handlers after startup.", "file");
+    QCommandLineOption replaySpeedOption("replay-speed",
+        "Replay speed: 1 is real time, 2 twice as fast, 0 as fast as possible (default: 1).", "factor", "1");
+    QCommandLineOption replayExitOption("replay-exit", "Quit once the replay has finished.");
+    QCommandLineOption testClientsOption("accept-test-clients",
+        "Give clients that match no configured bot a temporary one (for mcbot-loadgen).");
+    QCommandLineOption shareWorldOption("share-world-data",
+        "Let bots on the same server share decoded chunks instead of each keeping a copy.");
+    parser.addOptions({captureOption, replayOption, replaySpeedOption, replayExitOption, testClientsOption,
+                       shareWorldOption});
+    parser.process(a);
+
+    if (parser.isSet(testClientsOption)) {
+        BotManager::setAcceptUnlaunchedClients(true);
+        BotManager::setCreateTestBots(true);
+    }
+    if (parser.isSet(shareWorldOption)) {
+        BotManager::setShareWorldData(true);
+    }
+
     GlobalSettingsDialog::applyColorScheme();
     ManagerMainWindow w;
     w.show();
+
+    if (parser.isSet(captureOption)) {
+        PipeServer::startCapture(parser.value(captureOption));
+    }
+
+    if (parser.isSet(replayOption)) {
+        const QString path = parser.value(replayOption);
+        const double speed = parser.value(replaySpeedOption).toDouble();
+        const bool exitAfter = parser.isSet(replayExitOption);
+        // Once the event loop runs, so bots are loaded and the window is up
+        QTimer::singleShot(0, &a, [path, speed, exitAfter]() {
+            PipeReplay *replay = PipeServer::startReplay(path, speed);
+            if (exitAfter) {
+                if (replay) {
+                    QObject::connect(replay, &PipeReplay::finished, qApp, &QCoreApplication::quit);
+                } else {
+                    QCoreApplication::exit(1);
+                }
+            }
+        });
+    }
+
     return a.exec();
 }
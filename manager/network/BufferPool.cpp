@@ -0,0 +1,63 @@
+#include "BufferPool.h"
+#include <QMutexLocker>
+
+int BufferPool::classIndex(qsizetype size)
+{
+    int shift = kMinClassShift;
+    while (shift < kMaxClassShift && (qsizetype(1) << shift) < size) {
+        ++shift;
+    }
+    return shift - kMinClassShift;
+}
+
+qsizetype BufferPool::classSize(qsizetype size)
+{
+    if (size > (qsizetype(1) << kMaxClassShift)) {
+        return size;
+    }
+    return qsizetype(1) << (classIndex(size) + kMinClassShift);
+}
+
+QByteArray BufferPool::acquire(qsizetype size, bool *hit)
+{
+    const qsizetype rounded = classSize(size);
+    if (rounded <= (qsizetype(1) << kMaxClassShift)) {
+        QMutexLocker locker(&mutex);
+        QVector<QByteArray> &list = freeLists[classIndex(rounded)];
+        if (!list.isEmpty()) {
+            QByteArray buffer = list.takeLast();
+            locker.unlock();
+            hitCount.fetch_add(1, std::memory_order_relaxed);
+            if (hit) {
+                *hit = true;
+            }
+            return buffer;
+        }
+    }
+
+    missCount.fetch_add(1, std::memory_order_relaxed);
+    if (hit) {
+        *hit = false;
+    }
+    return QByteArray(rounded, Qt::Uninitialized);
+}
+
+void BufferPool::release(QByteArray &&buffer)
+{
+    const qsizetype size = buffer.size();
+    // Only exact class sizes that we handed out, and only if nobody else holds a reference
+    if (size < (qsizetype(1) << kMinClassShift) || size > (qsizetype(1) << kMaxClassShift)
+        || classSize(size) != size || !buffer.isDetached()) {
+        buffer = QByteArray();
+        return;
+    }
+
+    QMutexLocker locker(&mutex);
+    const int index = classIndex(size);
+    const int limit = (index + kMinClassShift >= 20) ? kMaxPerLargeClass : kMaxPerClass;
+    QVector<QByteArray> &list = freeLists[index];
+    if (list.size() < limit) {
+        list.append(std::move(buffer));
+    }
+    buffer = QByteArray();
+}
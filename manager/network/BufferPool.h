@@ -0,0 +1,42 @@
+#ifndef BUFFERPOOL_H
+#define BUFFERPOOL_H
+
+#include <QByteArray>
+#include <QMutex>
+#include <QVector>
+#include <array>
+#include <atomic>
+
+// Recycles large byte buffers by power-of-two size class so that hot paths
+// (frame reassembly, ring storage) don't allocate per message.
+class BufferPool
+{
+public:
+    static constexpr int kMinClassShift = 12;  // 4 KiB
+    static constexpr int kMaxClassShift = 26;  // 64 MiB
+    static constexpr int kMaxPerClass = 8;
+    static constexpr int kMaxPerLargeClass = 2;  // Classes of 1 MiB and up
+
+    BufferPool() = default;
+    BufferPool(const BufferPool&) = delete;
+    BufferPool& operator=(const BufferPool&) = delete;
+
+    // Returns a detached buffer of at least `size` bytes. `hit` reports whether it was recycled.
+    QByteArray acquire(qsizetype size, bool *hit = nullptr);
+    void release(QByteArray &&buffer);
+
+    quint64 hits() const { return hitCount.load(std::memory_order_relaxed); }
+    quint64 misses() const { return missCount.load(std::memory_order_relaxed); }
+
+    static qsizetype classSize(qsizetype size);
+
+private:
+    static int classIndex(qsizetype size);
+
+    QMutex mutex;
+    std::array<QVector<QByteArray>, kMaxClassShift - kMinClassShift + 1> freeLists;
+    std::atomic<quint64> hitCount{0};
+    std::atomic<quint64> missCount{0};
+};
+
+#endif // BUFFERPOOL_H
@@ -0,0 +1,155 @@
+#ifndef CONNECTIONSESSION_H
+#define CONNECTIONSESSION_H
+
+#include <QString>
+#include <QByteArray>
+#include <QMutex>
+#include <QLocalSocket>
+#include <array>
+#include <atomic>
+#include "protocol.qpb.h"
+#include "network/SpscQueue.h"
+#include "network/FrameReader.h"
+
+struct BotInstance;
+class BufferPool;
+
+// A decoded frame (or connection event) handed from the network thread to the GUI thread.
+struct PipeInboundMessage {
+    enum class Kind { Message, Disconnected };
+
+    Kind kind = Kind::Message;
+    mankool::mcbot::protocol::ClientToManagerMessage message;
+    quint32 wireSize = 0;  // Frame size including the length prefix
+    qint64 decodeNs = 0;
+};
+
+// Counters for one ClientToManagerMessage payload type. Updated from both the
+// network thread (decode) and the GUI thread (handler), read from anywhere.
+struct MessageTypeStats {
+    std::atomic<quint64> count{0};
+    std::atomic<quint64> bytes{0};
+    std::atomic<quint64> decodeNs{0};
+    std::atomic<quint64> handlerNs{0};
+};
+
+struct MessageTypeStatsSnapshot {
+    QString type;
+    quint64 count = 0;
+    quint64 bytes = 0;
+    quint64 decodeNs = 0;
+    quint64 handlerNs = 0;
+};
+
+struct LaneStats {
+    std::atomic<quint64> messages{0};
+    std::atomic<quint64> maxDepth{0};  // Deepest the queue has been
+};
+
+struct LaneStatsSnapshot {
+    quint64 messages = 0;
+    quint64 depth = 0;     // Currently queued (approximate)
+    quint64 maxDepth = 0;
+};
+
+struct InboundLanesSnapshot {
+    LaneStatsSnapshot control;
+    LaneStatsSnapshot bulk;
+};
+
+struct OutboundStatsSnapshot {
+    quint64 frames = 0;
+    quint64 writes = 0;
+};
+
+struct FrameReaderStatsSnapshot {
+    quint64 bytesRead = 0;
+    quint64 bytesCopied = 0;
+    quint64 frames = 0;
+    quint64 zeroCopyFrames = 0;
+    quint64 poolHits = 0;
+    quint64 poolMisses = 0;
+};
+
+// Everything the pipe layer knows about one client connection.
+// Fields are grouped by the thread that owns them.
+struct ConnectionSession {
+    // Indexed by the payload oneof field number
+    static constexpr int kPayloadSlots = 64;
+
+    ConnectionSession(int id, BufferPool *pool) : connectionId(id), reader(pool) {}
+
+    static int payloadSlot(const mankool::mcbot::protocol::ClientToManagerMessage &msg)
+    {
+        int field = static_cast<int>(msg.payloadField());
+        return (field > 0 && field < kPayloadSlots) ? field : 0;
+    }
+
+    // Inbound messages are split into two lanes. Control messages (handshake,
+    // heartbeats, command responses) are handled before any queued bulk world
+    // data, so a script waiting on a response isn't stuck behind a chunk flood.
+    // Everything whose order relative to world data matters stays in bulk,
+    // including string definitions, which must be handled before the world
+    // data that refers to them.
+    enum class Lane { Control, Bulk };
+
+    static Lane laneFor(int slot)
+    {
+        using Fields = mankool::mcbot::protocol::ClientToManagerMessage::PayloadFields;
+        static const std::array<bool, kPayloadSlots> control = [] {
+            std::array<bool, kPayloadSlots> table{};
+            for (Fields field : {Fields::ConnectionInfo, Fields::Heartbeat, Fields::Chat,
+                                 Fields::CommandResponse, Fields::ModulesResponse,
+                                 Fields::ModuleConfigResponse, Fields::BaritoneSettingsResponse,
+                                 Fields::BaritoneCommandsResponse, Fields::BaritoneSettingsSetResponse,
+                                 Fields::BaritoneCommandResponse, Fields::QueryRegistry,
+                                 Fields::QueryItemRegistry, Fields::CanReachBlockResponse,
+                                 Fields::CanReachBlocksResponse, Fields::HoldAttackStatusResponse}) {
+                table[static_cast<int>(field)] = true;
+            }
+            return table;
+        }();
+        return control[slot] ? Lane::Control : Lane::Bulk;
+    }
+
+    SpscQueue<PipeInboundMessage> &inboundQueue(Lane lane)
+    {
+        return lane == Lane::Control ? controlInbound : bulkInbound;
+    }
+
+    LaneStats &laneStats(Lane lane)
+    {
+        return lane == Lane::Control ? controlLaneStats : bulkLaneStats;
+    }
+
+    const int connectionId;
+
+    // Network thread only
+    QLocalSocket *socket = nullptr;
+    FrameReader reader;  // stats() may be read from any thread
+    bool continuationScheduled = false;
+
+    // Network thread -> GUI thread. The Disconnected item always goes through the bulk lane.
+    SpscQueue<PipeInboundMessage> controlInbound;
+    SpscQueue<PipeInboundMessage> bulkInbound;
+    LaneStats controlLaneStats;
+    LaneStats bulkLaneStats;
+    std::atomic<qint64> bytesSent{0};  // Written since the GUI thread last collected it
+
+    // Any thread -> network thread. Frames queued during one event loop turn are
+    // appended to outboundArena and written with a single socket write.
+    QMutex outboundMutex;
+    QByteArray outboundArena;
+    bool outboundFlushScheduled = false;
+    QByteArray outboundSpare;  // Network thread only; swapped with the arena on flush
+    std::atomic<quint64> outboundFrames{0};
+    std::atomic<quint64> outboundWrites{0};
+
+    // GUI thread only
+    BotInstance *bot = nullptr;
+    quint64 bulkHandled = 0;  // Bulk lane frames handled, reported back by HEARTBEAT_ACK
+
+    std::array<MessageTypeStats, kPayloadSlots> messageStats;
+};
+
+#endif // CONNECTIONSESSION_H
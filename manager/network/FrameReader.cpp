@@ -0,0 +1,151 @@
+#include "FrameReader.h"
+#include "network/BufferPool.h"
+#include <QtEndian>
+#include <algorithm>
+#include <cstring>
+
+FrameReader::FrameReader(BufferPool *pool)
+    : pool(pool)
+{
+}
+
+// Buffers are handed back in release(), which runs on the network thread. The
+// destructor may run elsewhere after the pool is gone, so it leaves the pool alone.
+FrameReader::~FrameReader() = default;
+
+QByteArray FrameReader::acquireBuffer(qsizetype size)
+{
+    bool hit = false;
+    QByteArray buffer = pool->acquire(size, &hit);
+    (hit ? counters.poolHits : counters.poolMisses).fetch_add(1, std::memory_order_relaxed);
+    return buffer;
+}
+
+void FrameReader::releaseScratch()
+{
+    if (!scratch.isEmpty()) {
+        pool->release(std::move(scratch));
+    }
+}
+
+void FrameReader::release()
+{
+    releaseScratch();
+    if (!ring.isEmpty()) {
+        pool->release(std::move(ring));
+    }
+    ring = QByteArray();
+    head = tail = 0;
+    pendingFrame = 0;
+}
+
+void FrameReader::copyOut(qint64 from, char *dst, qsizetype len) const
+{
+    const qsizetype start = static_cast<qsizetype>(from & (capacity() - 1));
+    const qsizetype first = std::min(len, capacity() - start);
+    std::memcpy(dst, ring.constData() + start, first);
+    if (len > first) {
+        std::memcpy(dst + first, ring.constData(), len - first);
+    }
+}
+
+void FrameReader::ensureCapacity(qsizetype needed)
+{
+    if (capacity() >= needed) {
+        return;
+    }
+
+    qsizetype newCapacity = std::max(capacity(), kInitialCapacity);
+    while (newCapacity < needed) {
+        newCapacity *= 2;
+    }
+
+    // Pool size classes are powers of two, so the buffer is exactly newCapacity
+    QByteArray grown = acquireBuffer(newCapacity);
+    const qsizetype used = buffered();
+    if (used > 0) {
+        copyOut(head, grown.data(), used);
+        counters.bytesCopied.fetch_add(used, std::memory_order_relaxed);
+    }
+    if (!ring.isEmpty()) {
+        pool->release(std::move(ring));
+    }
+    ring = std::move(grown);
+    head = 0;
+    tail = used;
+}
+
+qint64 FrameReader::fill(QIODevice *device)
+{
+    ensureCapacity(std::max(kInitialCapacity, pendingFrame));
+
+    qint64 total = 0;
+    char *base = ring.data();
+    const qsizetype mask = capacity() - 1;
+    while (true) {
+        const qint64 available = device->bytesAvailable();
+        const qsizetype free = capacity() - buffered();
+        if (available <= 0 || free == 0) {
+            break;
+        }
+
+        // Read straight into the contiguous free region at the write position
+        const qsizetype start = static_cast<qsizetype>(tail & mask);
+        const qint64 chunk = std::min<qint64>({available, free, capacity() - start});
+        const qint64 n = device->read(base + start, chunk);
+        if (n <= 0) {
+            break;
+        }
+        tail += n;
+        total += n;
+    }
+
+    counters.bytesRead.fetch_add(total, std::memory_order_relaxed);
+    return total;
+}
+
+FrameReader::Result FrameReader::next(Slice &slice, quint32 maxFrameSize)
+{
+    releaseScratch();
+
+    const qsizetype used = buffered();
+    if (used < 4) {
+        return Result::NeedMore;
+    }
+
+    char prefix[4];
+    copyOut(head, prefix, 4);
+    const quint32 length = qFromLittleEndian<quint32>(prefix);
+    slice.declaredSize = length;
+    if (length > maxFrameSize) {
+        return Result::Oversized;
+    }
+
+    const qsizetype total = 4 + static_cast<qsizetype>(length);
+    if (used < total) {
+        pendingFrame = total;
+        return Result::NeedMore;
+    }
+    pendingFrame = 0;
+
+    const qsizetype start = static_cast<qsizetype>((head + 4) & (capacity() - 1));
+    if (start + static_cast<qsizetype>(length) <= capacity()) {
+        slice.data = ring.constData() + start;
+        counters.zeroCopyFrames.fetch_add(1, std::memory_order_relaxed);
+    } else {
+        // Frame wraps around the end of the ring - stitch it together once
+        scratch = acquireBuffer(length);
+        copyOut(head + 4, scratch.data(), length);
+        slice.data = scratch.constData();
+        counters.bytesCopied.fetch_add(length, std::memory_order_relaxed);
+    }
+    slice.size = length;
+    counters.frames.fetch_add(1, std::memory_order_relaxed);
+
+    head += total;
+    if (head == tail) {
+        // Empty again: rewind so the next frame starts at the front and stays contiguous
+        head = tail = 0;
+    }
+    return Result::Frame;
+}
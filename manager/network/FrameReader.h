@@ -0,0 +1,74 @@
+#ifndef FRAMEREADER_H
+#define FRAMEREADER_H
+
+#include <QByteArray>
+#include <QIODevice>
+#include <atomic>
+
+class BufferPool;
+
+// Counters for one reader; written on the network thread, readable from anywhere.
+struct FrameReaderStats {
+    std::atomic<quint64> bytesRead{0};
+    std::atomic<quint64> bytesCopied{0};     // Bytes memcpy'd after leaving the socket (wrap/grow)
+    std::atomic<quint64> frames{0};
+    std::atomic<quint64> zeroCopyFrames{0};  // Frames decoded straight out of the ring
+    std::atomic<quint64> poolHits{0};
+    std::atomic<quint64> poolMisses{0};
+};
+
+// Reassembles length-prefixed frames (4-byte little-endian length + payload)
+// in a ring buffer. Socket data is read directly into the ring and complete
+// frames are handed out as slices of it; only frames that wrap around the end
+// of the ring are copied, into a pooled scratch buffer.
+//
+// Network thread only, apart from stats().
+class FrameReader
+{
+public:
+    enum class Result { Frame, NeedMore, Oversized };
+
+    struct Slice {
+        const char *data = nullptr;
+        quint32 size = 0;
+        quint32 declaredSize = 0;  // Length prefix, also set for Oversized
+    };
+
+    static constexpr qsizetype kInitialCapacity = 64 * 1024;
+
+    explicit FrameReader(BufferPool *pool);
+    ~FrameReader();
+
+    FrameReader(const FrameReader&) = delete;
+    FrameReader& operator=(const FrameReader&) = delete;
+
+    // Reads as much as fits from the device. Returns the number of bytes read.
+    qint64 fill(QIODevice *device);
+
+    // Pops the next complete frame. The slice stays valid until the next call
+    // to next(), fill() or release().
+    Result next(Slice &slice, quint32 maxFrameSize);
+
+    // Returns all buffers to the pool; the reader is empty afterwards.
+    void release();
+
+    qsizetype buffered() const { return static_cast<qsizetype>(tail - head); }
+    const FrameReaderStats &stats() const { return counters; }
+
+private:
+    qsizetype capacity() const { return ring.size(); }
+    void ensureCapacity(qsizetype needed);
+    void copyOut(qint64 from, char *dst, qsizetype len) const;
+    QByteArray acquireBuffer(qsizetype size);
+    void releaseScratch();
+
+    BufferPool *pool;
+    QByteArray ring;         // Capacity is always a power of two
+    qint64 head = 0;         // Absolute read position
+    qint64 tail = 0;         // Absolute write position
+    qsizetype pendingFrame = 0;  // Total size of the frame at head once its prefix is known
+    QByteArray scratch;      // Pooled buffer for a frame that wrapped
+    FrameReaderStats counters;
+};
+
+#endif // FRAMEREADER_H
@@ -0,0 +1,237 @@
+#include "PendingRequests.h"
+#include <QDeadlineTimer>
+#include <QMutexLocker>
+#include <QWaitCondition>
+#include <QList>
+#include <algorithm>
+
+struct PendingReply::State {
+    quint64 requestId = 0;
+    int connectionId = -1;
+    QDeadlineTimer deadline;
+    PendingRequestTable::CompletionHook onComplete;
+
+    QMutex mutex;
+    QWaitCondition settled;
+    Status status = Status::Pending;
+    QVariant value;
+    QList<std::function<void()>> settledCallbacks;
+
+    // Caller holds mutex
+    Status currentLocked()
+    {
+        if (status == Status::Pending && deadline.hasExpired()) {
+            status = Status::TimedOut;
+            settled.wakeAll();
+        }
+        return status;
+    }
+
+    bool settle(Status result, const QVariant &response = QVariant())
+    {
+        QList<std::function<void()>> callbacks;
+        {
+            QMutexLocker locker(&mutex);
+            if (currentLocked() != Status::Pending) {
+                return false;
+            }
+            status = result;
+            value = response;
+            settled.wakeAll();
+            callbacks.swap(settledCallbacks);
+        }
+        for (const auto &callback : std::as_const(callbacks)) {
+            callback();
+        }
+        return true;
+    }
+
+    bool isSettled()
+    {
+        QMutexLocker locker(&mutex);
+        return currentLocked() != Status::Pending;
+    }
+};
+
+PendingReply PendingReply::ready(const QVariant &value)
+{
+    auto state = std::make_shared<State>();
+    state->deadline = QDeadlineTimer(QDeadlineTimer::Forever);
+    state->status = Status::Completed;
+    state->value = value;
+    return PendingReply(state);
+}
+
+quint64 PendingReply::requestId() const
+{
+    return d ? d->requestId : 0;
+}
+
+PendingReply::Status PendingReply::status() const
+{
+    if (!d) {
+        return Status::SendFailed;
+    }
+    QMutexLocker locker(&d->mutex);
+    return d->currentLocked();
+}
+
+PendingReply::Status PendingReply::wait(int timeoutMs) const
+{
+    if (!d) {
+        return Status::SendFailed;
+    }
+
+    QDeadlineTimer limit = d->deadline;
+    if (timeoutMs >= 0) {
+        QDeadlineTimer requested(timeoutMs);
+        if (requested < limit) {
+            limit = requested;
+        }
+    }
+
+    QMutexLocker locker(&d->mutex);
+    while (d->currentLocked() == Status::Pending) {
+        if (!d->settled.wait(&d->mutex, limit)) {
+            break;
+        }
+    }
+    return d->currentLocked();
+}
+
+QVariant PendingReply::value() const
+{
+    if (!d) {
+        return QVariant();
+    }
+    QMutexLocker locker(&d->mutex);
+    return d->value;
+}
+
+void PendingReply::cancel() const
+{
+    if (d) {
+        d->settle(Status::Cancelled);
+    }
+}
+
+QDeadlineTimer PendingReply::deadline() const
+{
+    return d ? d->deadline : QDeadlineTimer();
+}
+
+void PendingReply::onSettled(std::function<void()> callback) const
+{
+    if (d) {
+        QMutexLocker locker(&d->mutex);
+        if (d->currentLocked() == Status::Pending) {
+            d->settledCallbacks.append(std::move(callback));
+            return;
+        }
+    }
+    callback();
+}
+
+QString PendingReply::statusName(Status status)
+{
+    switch (status) {
+    case Status::Pending:      return "pending";
+    case Status::Completed:    return "completed";
+    case Status::TimedOut:     return "timed out";
+    case Status::Cancelled:    return "cancelled";
+    case Status::Disconnected: return "disconnected";
+    case Status::SendFailed:   return "send failed";
+    }
+    return "unknown";
+}
+
+PendingReply PendingRequestTable::add(quint64 requestId, int connectionId, int timeoutMs, CompletionHook onComplete)
+{
+    auto state = std::make_shared<PendingReply::State>();
+    state->requestId = requestId;
+    state->connectionId = connectionId;
+    state->deadline = QDeadlineTimer(timeoutMs);
+    state->onComplete = std::move(onComplete);
+
+    QMutexLocker locker(&mutex);
+    if (pending.size() >= nextSweepSize) {
+        sweepLocked();
+    }
+    pending.insert(requestId, state);
+    return PendingReply(state);
+}
+
+bool PendingRequestTable::complete(quint64 requestId, int connectionId, const QVariant &value)
+{
+    std::shared_ptr<PendingReply::State> state;
+    {
+        QMutexLocker locker(&mutex);
+        auto it = pending.find(requestId);
+        if (it == pending.end() || it.value()->connectionId != connectionId) {
+            return false;
+        }
+        state = it.value();
+        pending.erase(it);
+    }
+    // Before settling, so whatever the hook records is in place by the time waiters wake
+    if (state->onComplete) {
+        state->onComplete(value);
+    }
+    return state->settle(PendingReply::Status::Completed, value);
+}
+
+void PendingRequestTable::fail(quint64 requestId, PendingReply::Status status)
+{
+    std::shared_ptr<PendingReply::State> state;
+    {
+        QMutexLocker locker(&mutex);
+        state = pending.take(requestId);
+    }
+    if (state) {
+        state->settle(status);
+    }
+}
+
+int PendingRequestTable::failConnection(int connectionId)
+{
+    QList<std::shared_ptr<PendingReply::State>> dropped;
+    {
+        QMutexLocker locker(&mutex);
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (it.value()->connectionId == connectionId) {
+                dropped.append(it.value());
+                it = pending.erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+
+    // Settle outside the table lock; waiters wake up holding only their own state
+    int failed = 0;
+    for (const auto &state : std::as_const(dropped)) {
+        if (state->settle(PendingReply::Status::Disconnected)) {
+            ++failed;
+        }
+    }
+    return failed;
+}
+
+int PendingRequestTable::size() const
+{
+    QMutexLocker locker(&mutex);
+    return pending.size();
+}
+
+void PendingRequestTable::sweepLocked()
+{
+    // Requests that timed out or were cancelled never get a response to remove them
+    for (auto it = pending.begin(); it != pending.end();) {
+        if (it.value()->isSettled()) {
+            it = pending.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    nextSweepSize = std::max<int>(kMinSweepSize, pending.size() * 2);
+}
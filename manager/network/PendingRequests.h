@@ -0,0 +1,79 @@
+#ifndef PENDINGREQUESTS_H
+#define PENDINGREQUESTS_H
+
+#include <QVariant>
+#include <QDeadlineTimer>
+#include <QList>
+#include <QMutex>
+#include <QHash>
+#include <memory>
+#include <functional>
+
+// Handle to the response of one request sent to a client. Copies share the
+// same state; the request is settled exactly once, by a response, its
+// deadline, cancel(), or the connection going away. Safe from any thread.
+class PendingReply
+{
+public:
+    enum class Status { Pending, Completed, TimedOut, Cancelled, Disconnected, SendFailed };
+
+    // An empty handle behaves like a request that could not be sent
+    PendingReply() = default;
+    // An already completed reply, for answers served without asking the client
+    static PendingReply ready(const QVariant &value);
+
+    quint64 requestId() const;
+    // Pending until settled. A request past its deadline reports TimedOut.
+    Status status() const;
+    bool isDone() const { return status() != Status::Pending; }
+    // Blocks until settled or timeoutMs elapses (-1 waits up to the request's deadline)
+    Status wait(int timeoutMs = -1) const;
+    // The response value; only meaningful once status() is Completed
+    QVariant value() const;
+    void cancel() const;
+    QDeadlineTimer deadline() const;
+    // Runs `callback` once on the thread that settles the request, or right away if it already
+    // is. A deadline passing is only noticed by status()/wait(), so it doesn't run callbacks;
+    // schedule a status() check at deadline() for that.
+    void onSettled(std::function<void()> callback) const;
+
+    static QString statusName(Status status);
+
+private:
+    friend class PendingRequestTable;
+    struct State;
+
+    explicit PendingReply(std::shared_ptr<State> state) : d(std::move(state)) {}
+
+    std::shared_ptr<State> d;
+};
+
+// Outstanding requests keyed by their numeric message id. Responses are
+// matched against the connection the request went out on, so a reconnecting
+// client can't answer for its previous session.
+class PendingRequestTable
+{
+public:
+    using CompletionHook = std::function<void(const QVariant &value)>;
+
+    // onComplete runs on the thread that delivers the response, even if the caller stopped waiting
+    PendingReply add(quint64 requestId, int connectionId, int timeoutMs, CompletionHook onComplete = {});
+    // False if the request is unknown, already settled, or from another connection
+    bool complete(quint64 requestId, int connectionId, const QVariant &value);
+    void fail(quint64 requestId, PendingReply::Status status);
+    // Settles everything outstanding on this connection as Disconnected
+    int failConnection(int connectionId);
+    int size() const;
+
+private:
+    // Settled and expired entries are dropped lazily, once the table doubles
+    static constexpr int kMinSweepSize = 64;
+
+    void sweepLocked();
+
+    mutable QMutex mutex;
+    QHash<quint64, std::shared_ptr<PendingReply::State>> pending;
+    int nextSweepSize = kMinSweepSize;
+};
+
+#endif // PENDINGREQUESTS_H
@@ -0,0 +1,114 @@
+#include "PipeCapture.h"
+#include "network/PipeIoWorker.h"
+#include <QtEndian>
+#include <cstring>
+
+namespace PipeCapture {
+
+bool Writer::open(const QString &path, QString *errorString)
+{
+    close();
+    file.setFileName(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+    file.write(kMagic, sizeof(kMagic));
+    clock.start();
+    frameCount = 0;
+    byteCount = 0;
+    return true;
+}
+
+void Writer::close()
+{
+    if (file.isOpen()) {
+        file.close();
+    }
+}
+
+void Writer::writeFrame(int connectionId, QByteArrayView payload)
+{
+    writeRecord(connectionId, static_cast<quint32>(payload.size()), payload);
+    ++frameCount;
+    byteCount += payload.size();
+}
+
+void Writer::writeDisconnect(int connectionId)
+{
+    writeRecord(connectionId, kDisconnectMarker, {});
+}
+
+void Writer::writeRecord(int connectionId, quint32 size, QByteArrayView payload)
+{
+    if (!file.isOpen()) {
+        return;
+    }
+
+    char header[kRecordHeaderSize];
+    qToLittleEndian<qint64>(clock.nsecsElapsed(), header);
+    qToLittleEndian<qint32>(connectionId, header + 8);
+    qToLittleEndian<quint32>(size, header + 12);
+    file.write(header, sizeof(header));
+    if (!payload.isEmpty()) {
+        file.write(payload.data(), payload.size());
+    }
+}
+
+bool Reader::open(const QString &path, QString *errorString)
+{
+    file.setFileName(path);
+    if (!file.open(QIODevice::ReadOnly)) {
+        if (errorString) {
+            *errorString = file.errorString();
+        }
+        return false;
+    }
+
+    char magic[sizeof(kMagic)];
+    if (file.read(magic, sizeof(magic)) != qint64(sizeof(magic)) || std::memcmp(magic, kMagic, sizeof(kMagic)) != 0) {
+        if (errorString) {
+            *errorString = "not a capture file";
+        }
+        file.close();
+        return false;
+    }
+    return true;
+}
+
+bool Reader::next(Record &record)
+{
+    char header[kRecordHeaderSize];
+    const qint64 got = file.read(header, sizeof(header));
+    if (got == 0) {
+        return false;
+    }
+    if (got != qint64(sizeof(header))) {
+        error = "truncated record header";
+        return false;
+    }
+
+    record.timestampNs = qFromLittleEndian<qint64>(header);
+    record.connectionId = qFromLittleEndian<qint32>(header + 8);
+    const quint32 size = qFromLittleEndian<quint32>(header + 12);
+    record.disconnect = size == kDisconnectMarker;
+    if (record.disconnect) {
+        record.payload.clear();
+        return true;
+    }
+    if (size > PipeIoWorker::kMaxFrameSize) {
+        error = QString("record of %1 bytes exceeds the frame limit").arg(size);
+        return false;
+    }
+
+    record.payload.resize(size);
+    if (file.read(record.payload.data(), size) != qint64(size)) {
+        error = "truncated record payload";
+        return false;
+    }
+    return true;
+}
+
+} // namespace PipeCapture
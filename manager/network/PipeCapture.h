@@ -0,0 +1,68 @@
+#ifndef PIPECAPTURE_H
+#define PIPECAPTURE_H
+
+#include <QString>
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QFile>
+#include <QElapsedTimer>
+
+// Capture file of inbound client traffic, for replaying ingest without a game.
+//
+// Layout (little endian): the 8 byte magic "MCBCAP01", then one record per
+// frame: qint64 nanoseconds since capture start, qint32 connection id,
+// quint32 payload size, payload. The payload is the frame as it came off the
+// wire minus its length prefix. A size of kDisconnectMarker with no payload
+// records the connection closing.
+namespace PipeCapture {
+
+inline constexpr char kMagic[8] = {'M', 'C', 'B', 'C', 'A', 'P', '0', '1'};
+inline constexpr quint32 kDisconnectMarker = 0xFFFFFFFFu;
+inline constexpr int kRecordHeaderSize = 16;
+
+struct Record {
+    qint64 timestampNs = 0;
+    int connectionId = 0;
+    bool disconnect = false;
+    QByteArray payload;
+};
+
+// Network thread only
+class Writer
+{
+public:
+    bool open(const QString &path, QString *errorString);
+    void close();
+    bool isOpen() const { return file.isOpen(); }
+
+    void writeFrame(int connectionId, QByteArrayView payload);
+    void writeDisconnect(int connectionId);
+
+    quint64 frames() const { return frameCount; }
+    quint64 bytes() const { return byteCount; }
+
+private:
+    void writeRecord(int connectionId, quint32 size, QByteArrayView payload);
+
+    QFile file;
+    QElapsedTimer clock;
+    quint64 frameCount = 0;
+    quint64 byteCount = 0;
+};
+
+class Reader
+{
+public:
+    bool open(const QString &path, QString *errorString);
+    // False at the end of the file or on a truncated record (see errorString())
+    bool next(Record &record);
+    QString errorString() const { return error; }
+
+private:
+    QFile file;
+    QString error;
+};
+
+} // namespace PipeCapture
+
+#endif // PIPECAPTURE_H
@@ -0,0 +1,314 @@
+#include "PipeIoWorker.h"
+#include "logging/LogManager.h"
+#include <QMutexLocker>
+#include <QtEndian>
+#include <QElapsedTimer>
+
+PipeIoWorker::PipeIoWorker(QObject *parent)
+    : QObject(parent)
+    , server(nullptr)
+    , nextConnectionId(1000)
+{
+}
+
+PipeIoWorker::~PipeIoWorker()
+{
+    close();
+}
+
+bool PipeIoWorker::listen(const QString &pipeName, QString *errorString)
+{
+    if (server) {
+        if (errorString) {
+            *errorString = "already listening";
+        }
+        return false;
+    }
+
+    server = new QLocalServer(this);
+    QLocalServer::removeServer(pipeName);
+
+    if (!server->listen(pipeName)) {
+        if (errorString) {
+            *errorString = server->errorString();
+        }
+        delete server;
+        server = nullptr;
+        return false;
+    }
+
+    connect(server, &QLocalServer::newConnection,
+            this, &PipeIoWorker::handleNewConnection);
+    return true;
+}
+
+void PipeIoWorker::close()
+{
+    stopCapture();
+
+    for (auto it = connections.begin(); it != connections.end(); ++it) {
+        ConnectionSession *session = it->get();
+        session->socket->disconnect(this);
+        session->socket->deleteLater();
+        session->socket = nullptr;
+        session->reader.release();
+    }
+    connections.clear();
+    socketSessions.clear();
+
+    {
+        QMutexLocker locker(&registryMutex);
+        registry.clear();
+        registryVersion.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    if (server) {
+        server->close();
+        delete server;
+        server = nullptr;
+    }
+}
+
+void PipeIoWorker::handleNewConnection()
+{
+    while (server->hasPendingConnections()) {
+        QLocalSocket *socket = server->nextPendingConnection();
+
+        if (!socket) {
+            continue;
+        }
+
+        int connectionId = nextConnectionId++;
+        auto session = std::make_shared<ConnectionSession>(connectionId, &bufferPool);
+        session->socket = socket;
+        connections.insert(connectionId, session);
+        socketSessions.insert(socket, session.get());
+
+        {
+            QMutexLocker locker(&registryMutex);
+            registry.insert(connectionId, session);
+            registryVersion.fetch_add(1, std::memory_order_acq_rel);
+        }
+
+        LogManager::log(QString("New client connected (Connection ID: %1)").arg(connectionId), LogManager::Info);
+
+        connect(socket, &QLocalSocket::readyRead,
+                this, &PipeIoWorker::handleReadyRead);
+
+        connect(socket, &QLocalSocket::disconnected,
+                this, &PipeIoWorker::handleDisconnected);
+    }
+}
+
+void PipeIoWorker::handleReadyRead()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    ConnectionSession *session = socketSessions.value(socket, nullptr);
+    if (!session) {
+        LogManager::log("Data from unknown connection", LogManager::Error);
+        return;
+    }
+    readFrames(session);
+}
+
+void PipeIoWorker::readFrames(ConnectionSession *session)
+{
+    QLocalSocket *socket = session->socket;
+    FrameReader &reader = session->reader;
+    reader.fill(socket);
+
+    int frames = 0;
+    bool queued = false;
+    QElapsedTimer decodeTimer;
+    FrameReader::Slice slice;
+
+    while (true) {
+        if (frames == kMaxFramesPerSlice) {
+            // Yield so other sockets get a turn; pick up the rest on the next pass
+            if (!session->continuationScheduled) {
+                session->continuationScheduled = true;
+                std::weak_ptr<ConnectionSession> weak = connections.value(session->connectionId);
+                QMetaObject::invokeMethod(this, [this, weak]() {
+                    std::shared_ptr<ConnectionSession> s = weak.lock();
+                    if (s && s->socket) {
+                        s->continuationScheduled = false;
+                        readFrames(s.get());
+                    }
+                }, Qt::QueuedConnection);
+            }
+            break;
+        }
+
+        FrameReader::Result result = reader.next(slice, kMaxFrameSize);
+        if (result == FrameReader::Result::NeedMore) {
+            // Ring may have been full; top it up and try again
+            if (reader.fill(socket) > 0) {
+                continue;
+            }
+            break;
+        }
+        if (result == FrameReader::Result::Oversized) {
+            LogManager::log(QString("Frame of %1 bytes exceeds limit on connection %2, dropping connection")
+                           .arg(slice.declaredSize).arg(session->connectionId), LogManager::Error);
+            reader.release();
+            socket->abort();
+            return;
+        }
+
+        if (capture) {
+            capture->writeFrame(session->connectionId, QByteArrayView(slice.data, slice.size));
+        }
+
+        PipeInboundMessage item;
+        item.wireSize = slice.size + 4;  // Include length prefix
+        // Decode straight from the reader's buffer without copying the payload
+        QByteArray frame = QByteArray::fromRawData(slice.data, slice.size);
+        decodeTimer.start();
+        if (serializer.deserialize(&item.message, frame)) {
+            item.decodeNs = decodeTimer.nsecsElapsed();
+            const int slot = ConnectionSession::payloadSlot(item.message);
+            MessageTypeStats &stats = session->messageStats[slot];
+            stats.count.fetch_add(1, std::memory_order_relaxed);
+            stats.bytes.fetch_add(item.wireSize, std::memory_order_relaxed);
+            stats.decodeNs.fetch_add(item.decodeNs, std::memory_order_relaxed);
+
+            const ConnectionSession::Lane lane = ConnectionSession::laneFor(slot);
+            SpscQueue<PipeInboundMessage> &queue = session->inboundQueue(lane);
+            queue.push(std::move(item));
+            LaneStats &laneStats = session->laneStats(lane);
+            laneStats.messages.fetch_add(1, std::memory_order_relaxed);
+            const quint64 depth = static_cast<quint64>(queue.size());
+            if (depth > laneStats.maxDepth.load(std::memory_order_relaxed)) {
+                laneStats.maxDepth.store(depth, std::memory_order_relaxed);  // Only written on this thread
+            }
+            queued = true;
+        } else {
+            LogManager::log(QString("Failed to parse message (%1 bytes)").arg(slice.size),
+                            LogManager::Error);
+        }
+        ++frames;
+    }
+
+    if (queued) {
+        notifyConsumer();
+    }
+}
+
+void PipeIoWorker::notifyConsumer()
+{
+    if (requestDrain()) {
+        emit inboundReady();
+    }
+}
+
+void PipeIoWorker::handleDisconnected()
+{
+    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
+    if (!socket) {
+        return;
+    }
+
+    ConnectionSession *session = socketSessions.take(socket);
+    if (session) {
+        int connectionId = session->connectionId;
+        LogManager::log(QString("Client disconnected (Connection ID: %1)").arg(connectionId), LogManager::Warning);
+        if (capture) {
+            capture->writeDisconnect(connectionId);
+        }
+
+        // The session stays registered until the GUI thread has seen the disconnect,
+        // so no decoded messages are lost.
+        PipeInboundMessage item;
+        item.kind = PipeInboundMessage::Kind::Disconnected;
+        session->bulkInbound.push(std::move(item));
+        session->socket = nullptr;
+        session->reader.release();
+        connections.remove(connectionId);
+        notifyConsumer();
+    }
+
+    socket->deleteLater();
+}
+
+void PipeIoWorker::flushOutbound(ConnectionSession *session)
+{
+    {
+        QMutexLocker locker(&session->outboundMutex);
+        session->outboundFlushScheduled = false;
+        std::swap(session->outboundArena, session->outboundSpare);
+    }
+
+    QByteArray &batch = session->outboundSpare;
+    if (batch.isEmpty()) {
+        return;
+    }
+
+    if (session->socket) {
+        // Raw write so the socket copies into its own buffer and we keep ours
+        session->socket->write(batch.constData(), batch.size());
+        session->socket->flush();
+        session->bytesSent.fetch_add(batch.size(), std::memory_order_relaxed);
+        session->outboundWrites.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (batch.capacity() > kMaxRetainedArena) {
+        batch = QByteArray();
+    } else {
+        batch.resize(0);
+    }
+}
+
+bool PipeIoWorker::startCapture(const QString &path, QString *errorString)
+{
+    auto writer = std::make_unique<PipeCapture::Writer>();
+    if (!writer->open(path, errorString)) {
+        return false;
+    }
+    stopCapture();
+    capture = std::move(writer);
+    return true;
+}
+
+void PipeIoWorker::stopCapture()
+{
+    if (!capture) {
+        return;
+    }
+    capture->close();
+    LogManager::log(QString("Capture stopped: %1 frames, %2 bytes")
+                   .arg(capture->frames()).arg(capture->bytes()), LogManager::Info);
+    capture.reset();
+}
+
+void PipeIoWorker::writeToAll(const QByteArray &data)
+{
+    for (auto it = connections.constBegin(); it != connections.constEnd(); ++it) {
+        ConnectionSession *session = it->get();
+        session->socket->write(data);
+        session->bytesSent.fetch_add(data.size(), std::memory_order_relaxed);
+    }
+
+    LogManager::log(QString("Broadcast %1 bytes to %2 connected clients").arg(data.size()).arg(connections.size()), LogManager::Info);
+}
+
+QList<std::shared_ptr<ConnectionSession>> PipeIoWorker::sessions(int *version) const
+{
+    QMutexLocker locker(&registryMutex);
+    if (version) {
+        *version = registryVersion.load(std::memory_order_acquire);
+    }
+    return registry.values();
+}
+
+std::shared_ptr<ConnectionSession> PipeIoWorker::session(int connectionId) const
+{
+    QMutexLocker locker(&registryMutex);
+    return registry.value(connectionId);
+}
+
+void PipeIoWorker::releaseSession(int connectionId)
+{
+    QMutexLocker locker(&registryMutex);
+    registry.remove(connectionId);
+    registryVersion.fetch_add(1, std::memory_order_acq_rel);
+}
@@ -0,0 +1,82 @@
+#ifndef PIPEIOWORKER_H
+#define PIPEIOWORKER_H
+
+#include <QObject>
+#include <QLocalServer>
+#include <QLocalSocket>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QtProtobuf/QProtobufSerializer>
+#include <atomic>
+#include <memory>
+#include "network/ConnectionSession.h"
+#include "network/BufferPool.h"
+#include "network/PipeCapture.h"
+
+// Lives on the network I/O thread. Owns the local server and all client sockets,
+// frames and decodes inbound messages and performs all socket writes.
+class PipeIoWorker : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit PipeIoWorker(QObject *parent = nullptr);
+    ~PipeIoWorker();
+
+    // Network thread only
+    bool listen(const QString &pipeName, QString *errorString);
+    void close();
+    void flushOutbound(ConnectionSession *session);
+    void writeToAll(const QByteArray &data);
+    // Records every inbound frame to a capture file until stopped
+    bool startCapture(const QString &path, QString *errorString);
+    void stopCapture();
+
+    // Any thread
+    QList<std::shared_ptr<ConnectionSession>> sessions(int *version = nullptr) const;
+    std::shared_ptr<ConnectionSession> session(int connectionId) const;
+    int sessionsVersion() const { return registryVersion.load(std::memory_order_acquire); }
+    void releaseSession(int connectionId);
+
+    // Drain handshake: requestDrain() returns true only for the caller that armed
+    // a new drain cycle. The consumer clears the request once its queues are empty.
+    bool requestDrain() { return !drainRequested.exchange(true, std::memory_order_acq_rel); }
+    void clearDrainRequest() { drainRequested.store(false, std::memory_order_release); }
+
+    // Frames decoded per socket before yielding to other sockets
+    static constexpr int kMaxFramesPerSlice = 64;
+    static constexpr quint32 kMaxFrameSize = 64 * 1024 * 1024;
+    // Outbound arenas larger than this are released after a flush instead of reused
+    static constexpr qsizetype kMaxRetainedArena = 4 * 1024 * 1024;
+
+signals:
+    // Emitted at most once per drain cycle when new inbound items are queued
+    void inboundReady();
+
+private slots:
+    void handleNewConnection();
+    void handleReadyRead();
+    void handleDisconnected();
+
+private:
+    void readFrames(ConnectionSession *session);
+    void notifyConsumer();
+
+    QLocalServer *server;
+    // Sessions with a live socket, owned by this thread
+    QHash<int, std::shared_ptr<ConnectionSession>> connections;
+    QHash<QLocalSocket*, ConnectionSession*> socketSessions;
+    QProtobufSerializer serializer;
+    BufferPool bufferPool;
+    int nextConnectionId;
+    std::unique_ptr<PipeCapture::Writer> capture;
+
+    // Sessions visible to other threads; kept until the GUI thread has seen the disconnect
+    mutable QMutex registryMutex;
+    QHash<int, std::shared_ptr<ConnectionSession>> registry;
+    std::atomic<int> registryVersion{0};
+    std::atomic<bool> drainRequested{false};
+};
+
+#endif // PIPEIOWORKER_H
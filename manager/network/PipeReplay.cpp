@@ -0,0 +1,169 @@
+#include "PipeReplay.h"
+#include "network/PipeServer.h"
+#include "logging/LogManager.h"
+#include <QTimer>
+#include <QDebug>
+#include <algorithm>
+
+PipeReplay::PipeReplay(double speed, QObject *parent)
+    : QObject(parent)
+    , speed(std::max(0.0, speed))
+{
+}
+
+bool PipeReplay::open(const QString &path, QString *errorString)
+{
+    capturePath = path;
+    return reader.open(path, errorString);
+}
+
+void PipeReplay::start()
+{
+    LogManager::log(QString("Replaying %1 at %2").arg(capturePath,
+                   speed > 0 ? QString("%1x real time").arg(speed) : QString("full speed")),
+                   LogManager::Info);
+    // Recorded clients weren't launched by this manager
+    acceptedUnlaunchedClients = BotManager::acceptsUnlaunchedClients();
+    BotManager::setAcceptUnlaunchedClients(true);
+    wallClock.start();
+    QMetaObject::invokeMethod(this, &PipeReplay::pump, Qt::QueuedConnection);
+}
+
+void PipeReplay::pump()
+{
+    QElapsedTimer budget;
+    budget.start();
+
+    while (budget.nsecsElapsed() < kPumpBudgetNs) {
+        if (!hasPending) {
+            if (!reader.next(pending)) {
+                finish();
+                return;
+            }
+            hasPending = true;
+            if (firstTimestampNs < 0) {
+                firstTimestampNs = pending.timestampNs;
+            }
+        }
+
+        if (speed > 0) {
+            const qint64 dueNs = static_cast<qint64>((pending.timestampNs - firstTimestampNs) / speed);
+            const qint64 nowNs = wallClock.nsecsElapsed();
+            if (dueNs > nowNs) {
+                const int waitMs = static_cast<int>((dueNs - nowNs + 999999) / 1000000);
+                QTimer::singleShot(waitMs, Qt::PreciseTimer, this, &PipeReplay::pump);
+                return;
+            }
+            maxLagNs = std::max(maxLagNs, nowNs - dueNs);
+        }
+
+        dispatch(pending);
+        hasPending = false;
+    }
+
+    // Out of budget - let the GUI paint, then continue
+    QMetaObject::invokeMethod(this, &PipeReplay::pump, Qt::QueuedConnection);
+}
+
+void PipeReplay::dispatch(const PipeCapture::Record &record)
+{
+    PipeServer &server = PipeServer::instance();
+    const int connectionId = record.connectionId + kConnectionIdOffset;
+    lastTimestampNs = record.timestampNs;
+
+    std::shared_ptr<ConnectionSession> &session = sessions[connectionId];
+    if (record.disconnect) {
+        if (session) {
+            server.endReplaySession(*session);
+        }
+        sessions.remove(connectionId);
+        return;
+    }
+    if (!session) {
+        // Never touches a socket or frame reader, so it needs no buffer pool
+        session = std::make_shared<ConnectionSession>(connectionId, nullptr);
+    }
+
+    mankool::mcbot::protocol::ClientToManagerMessage message;
+    QElapsedTimer timer;
+    timer.start();
+    if (!serializer.deserialize(&message, record.payload)) {
+        ++decodeFailures;
+        return;
+    }
+    decodeNs += timer.nsecsElapsed();
+
+    const quint32 wireSize = static_cast<quint32>(record.payload.size()) + 4;
+    const int slot = ConnectionSession::payloadSlot(message);
+    MessageTypeStats &stats = session->messageStats[slot];
+    stats.count.fetch_add(1, std::memory_order_relaxed);
+    stats.bytes.fetch_add(wireSize, std::memory_order_relaxed);
+
+    timer.restart();
+    server.processMessage(*session, message);
+    handlerNs.append(timer.nsecsElapsed());
+    server.accountTraffic(*session, wireSize);
+
+    ++messages;
+    bytes += wireSize;
+}
+
+void PipeReplay::finish()
+{
+    if (!reader.errorString().isEmpty()) {
+        LogManager::log(QString("Replay stopped early: %1").arg(reader.errorString()), LogManager::Error);
+    }
+
+    // Recordings usually end mid-session; let go of the bots they connected
+    PipeServer &server = PipeServer::instance();
+    for (const auto &session : std::as_const(sessions)) {
+        server.endReplaySession(*session);
+    }
+    sessions.clear();
+    BotManager::setAcceptUnlaunchedClients(acceptedUnlaunchedClients);
+
+    report();
+    emit finished();
+}
+
+void PipeReplay::report() const
+{
+    const double wallSec = wallClock.nsecsElapsed() / 1e9;
+    const double capturedSec = firstTimestampNs >= 0 ? (lastTimestampNs - firstTimestampNs) / 1e9 : 0.0;
+
+    QVector<qint64> sorted = handlerNs;
+    std::sort(sorted.begin(), sorted.end());
+    auto percentileUs = [&sorted](double p) {
+        if (sorted.isEmpty()) {
+            return 0.0;
+        }
+        const int index = std::min<int>(sorted.size() - 1, static_cast<int>(p * sorted.size()));
+        return sorted[index] / 1e3;
+    };
+
+    QStringList lines;
+    lines << QString("Replay finished: %1 messages, %2 MB in %3 s (captured span %4 s)")
+                 .arg(messages)
+                 .arg(bytes / 1e6, 0, 'f', 2)
+                 .arg(wallSec, 0, 'f', 3)
+                 .arg(capturedSec, 0, 'f', 3);
+    lines << QString("  throughput: %1 msg/s, %2 MB/s")
+                 .arg(wallSec > 0 ? messages / wallSec : 0.0, 0, 'f', 0)
+                 .arg(wallSec > 0 ? bytes / 1e6 / wallSec : 0.0, 0, 'f', 2);
+    lines << QString("  decode: %1 us avg, %2 failures")
+                 .arg(messages > 0 ? decodeNs / 1e3 / messages : 0.0, 0, 'f', 1)
+                 .arg(decodeFailures);
+    lines << QString("  handler: p50 %1 us, p99 %2 us, max %3 us")
+                 .arg(percentileUs(0.50), 0, 'f', 1)
+                 .arg(percentileUs(0.99), 0, 'f', 1)
+                 .arg(sorted.isEmpty() ? 0.0 : sorted.last() / 1e3, 0, 'f', 1);
+    if (speed > 0) {
+        lines << QString("  max lag behind schedule: %1 ms").arg(maxLagNs / 1e6, 0, 'f', 2);
+    }
+
+    for (const QString &line : std::as_const(lines)) {
+        LogManager::log(line, LogManager::Info);
+        // Also on stdout, for runs driven from a shell
+        qInfo().noquote() << line;
+    }
+}
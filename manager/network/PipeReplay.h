@@ -0,0 +1,68 @@
+#ifndef PIPEREPLAY_H
+#define PIPEREPLAY_H
+
+#include <QObject>
+#include <QHash>
+#include <QVector>
+#include <QElapsedTimer>
+#include <QtProtobuf/QProtobufSerializer>
+#include <memory>
+#include "network/ConnectionSession.h"
+#include "network/PipeCapture.h"
+
+// Feeds a capture file through PipeServer's message handlers on the GUI
+// thread, as if the recorded clients were connected, and reports decode and
+// handler latency and throughput when it runs out of records.
+//
+// Recorded bots are bound to offline bots with the same account id or name,
+// so they should be configured here and not currently running.
+class PipeReplay : public QObject
+{
+    Q_OBJECT
+
+public:
+    // speed: 1 replays in real time, 2 twice as fast, 0 as fast as possible
+    explicit PipeReplay(double speed, QObject *parent = nullptr);
+
+    bool open(const QString &path, QString *errorString);
+    void start();
+
+    // Recorded connection ids are shifted so they can't collide with live clients
+    static constexpr int kConnectionIdOffset = 1000000;
+
+signals:
+    void finished();
+
+private slots:
+    void pump();
+
+private:
+    // Upper bound for one pump() on the GUI thread, like PipeServer::drainInbound()
+    static constexpr qint64 kPumpBudgetNs = 8 * 1000 * 1000;
+
+    void dispatch(const PipeCapture::Record &record);
+    void finish();
+    void report() const;
+
+    double speed;
+    QString capturePath;
+    PipeCapture::Reader reader;
+    PipeCapture::Record pending;
+    bool hasPending = false;
+    QProtobufSerializer serializer;
+    QHash<int, std::shared_ptr<ConnectionSession>> sessions;
+    bool acceptedUnlaunchedClients = false;  // BotManager setting to restore when done
+
+    QElapsedTimer wallClock;
+    qint64 firstTimestampNs = -1;
+    qint64 lastTimestampNs = 0;
+
+    quint64 messages = 0;
+    quint64 bytes = 0;
+    quint64 decodeFailures = 0;
+    qint64 decodeNs = 0;
+    QVector<qint64> handlerNs;  // One sample per message, for percentiles
+    qint64 maxLagNs = 0;        // Furthest behind schedule a message was handled
+};
+
+#endif // PIPEREPLAY_H
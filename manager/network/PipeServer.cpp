@@ -1,15 +1,23 @@
 #include "PipeServer.h"
 #include "logging/LogManager.h"
 #include "bot/BotManager.h"
+#include "network/PipeReplay.h"
 #include "protocol.qpb.h"
 #include "connection.qpb.h"
-#include <QtProtobuf/QProtobufSerializer>
 #include <QThread>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QMutexLocker>
+#include <QtEndian>
+#include <QtProtobuf/QProtobufSerializer>
+#include <array>
 
 PipeServer::PipeServer()
     : QObject(nullptr)
-    , server(nullptr)
-    , nextConnectionId(1000)
+    , ioThread(nullptr)
+    , ioWorker(nullptr)
+    , drainSessionsVersion(-1)
+    , drainCursor(0)
 {
 }
 
@@ -31,29 +39,44 @@ bool PipeServer::start(const QString &pipeName)
 
 bool PipeServer::startImpl(const QString &pipeName)
 {
-    if (server) {
+    if (ioThread) {
         LogManager::log("Pipe server already running", LogManager::Warning);
         return false;
     }
 
     serverPipeName = pipeName;
-    server = new QLocalServer(this);
 
-    QLocalServer::removeServer(pipeName);
+    ioThread = new QThread();
+    ioThread->setObjectName("PipeServerIO");
+    ioWorker = new PipeIoWorker();
+    ioWorker->moveToThread(ioThread);
+
+    connect(ioThread, &QThread::finished, ioWorker, &QObject::deleteLater);
+    connect(ioWorker, &PipeIoWorker::inboundReady, this, &PipeServer::drainInbound, Qt::QueuedConnection);
+
+    ioThread->start();
 
-    if (!server->listen(pipeName)) {
+    // The server and its sockets must be created on the thread that uses them
+    bool listening = false;
+    QString errorString;
+    PipeIoWorker *worker = ioWorker;
+    QMetaObject::invokeMethod(worker, [worker, &pipeName, &listening, &errorString]() {
+        listening = worker->listen(pipeName, &errorString);
+    }, Qt::BlockingQueuedConnection);
+
+    if (!listening) {
         LogManager::log(QString("Failed to create pipe server '%1': %2")
-                       .arg(pipeName, server->errorString()), LogManager::Error);
-        delete server;
-        server = nullptr;
+                       .arg(pipeName, errorString), LogManager::Error);
+        ioThread->quit();
+        ioThread->wait();
+        delete ioThread;
+        ioThread = nullptr;
+        ioWorker = nullptr;
         return false;
     }
 
     LogManager::log(QString("Pipe server listening on '%1'").arg(pipeName), LogManager::Success);
 
-    connect(server, &QLocalServer::newConnection,
-            this, &PipeServer::handleNewConnection);
-
     return true;
 }
 
@@ -64,257 +87,524 @@ void PipeServer::stop()
 
 void PipeServer::stopImpl()
 {
-    if (!server) {
+    if (!ioThread) {
         return;
     }
 
-    for (auto it = connections.begin(); it != connections.end(); ++it) {
-        QLocalSocket *socket = it.value();
-        if (socket) {
-            socket->deleteLater();
-        }
-    }
-    for (auto stream : std::as_const(connectionStreams)) {
-        delete stream;
-    }
-    connections.clear();
-    connectionBotNames.clear();
-    connectionStreams.clear();
+    PipeIoWorker *worker = ioWorker;
+    QMetaObject::invokeMethod(worker, [worker]() {
+        worker->close();
+    }, Qt::BlockingQueuedConnection);
 
-    server->close();
-    delete server;
-    server = nullptr;
+    ioThread->quit();
+    ioThread->wait();
+    delete ioThread;
+    ioThread = nullptr;
+    ioWorker = nullptr;
+
+    drainSessions.clear();
+    drainSessionsVersion = -1;
+    connectionBotNames.clear();
 
     LogManager::log("Pipe server stopped", LogManager::Info);
 }
 
-void PipeServer::handleNewConnection()
+void PipeServer::refreshDrainSessions()
 {
-    while (server->hasPendingConnections()) {
-        QLocalSocket *socket = server->nextPendingConnection();
+    drainSessions = ioWorker->sessions(&drainSessionsVersion);
+    drainCursor = 0;
+}
 
-        if (!socket) {
-            continue;
-        }
+void PipeServer::drainInbound()
+{
+    if (!ioWorker) {
+        return;
+    }
+
+    if (ioWorker->sessionsVersion() != drainSessionsVersion) {
+        refreshDrainSessions();
+    }
 
-        int connectionId = nextConnectionId++;
-        connections[connectionId] = socket;
+    // Control messages of every connection go first. Then round-robin over
+    // connections, a few bulk messages each, until everything is drained or the
+    // time budget for this event loop turn runs out.
+    QElapsedTimer budget;
+    budget.start();
+    bool pending = true;
+    while (pending && budget.nsecsElapsed() < kDrainBudgetNs) {
+        pending = false;
+        for (const auto &session : std::as_const(drainSessions)) {
+            accountTraffic(*session, drainControlLane(*session));
+        }
 
-        // Create a data stream for this connection
-        QDataStream *stream = new QDataStream(socket);
-        stream->setByteOrder(QDataStream::LittleEndian);
-        stream->setVersion(QDataStream::Qt_5_0);
-        connectionStreams[connectionId] = stream;
+        const int count = drainSessions.size();
+        for (int n = 0; n < count; ++n) {
+            const std::shared_ptr<ConnectionSession> session = drainSessions[(drainCursor + n) % count];
+
+            qint64 bytesIn = 0;
+            bool disconnected = false;
+            PipeInboundMessage item;
+            for (int i = 0; i < kMessagesPerSlice && session->bulkInbound.tryPop(item); ++i) {
+                if (item.kind == PipeInboundMessage::Kind::Disconnected) {
+                    disconnected = true;
+                    break;
+                }
+                processMessage(*session, item.message);
+                ++session->bulkHandled;
+                bytesIn += item.wireSize;
+
+                // A response that arrived meanwhile doesn't wait for the rest of the slice
+                if (!session->controlInbound.isEmpty()) {
+                    bytesIn += drainControlLane(*session);
+                }
+            }
 
-        LogManager::log(QString("New client connected (Connection ID: %1)").arg(connectionId), LogManager::Info);
+            if (disconnected) {
+                // Everything the client sent before disconnecting is handled first
+                while (!session->controlInbound.isEmpty()) {
+                    bytesIn += drainControlLane(*session);
+                }
+            }
 
-        connect(socket, &QLocalSocket::readyRead,
-                this, &PipeServer::handleClientData);
+            accountTraffic(*session, bytesIn);
 
-        connect(socket, &QLocalSocket::disconnected,
-                this, &PipeServer::handleClientDisconnection);
+            if (disconnected) {
+                handleClientDisconnection(*session);
+            } else if (!session->bulkInbound.isEmpty() || !session->controlInbound.isEmpty()) {
+                pending = true;
+            }
+        }
+        if (count > 0) {
+            drainCursor = (drainCursor + 1) % count;
+        }
+        if (ioWorker->sessionsVersion() != drainSessionsVersion) {
+            refreshDrainSessions();
+        }
     }
-}
 
-void PipeServer::handleClientData()
-{
-    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
-    if (!socket) {
+    if (pending) {
+        // Out of budget - let the GUI paint, then continue where we left off
+        QMetaObject::invokeMethod(this, &PipeServer::drainInbound, Qt::QueuedConnection);
         return;
     }
 
-    int connectionId = -1;
-    for (auto it = connections.begin(); it != connections.end(); ++it) {
-        if (it.value() == socket) {
-            connectionId = it.key();
+    ioWorker->clearDrainRequest();
+
+    // A producer may have queued more between our last pop and the clear above
+    for (const auto &session : std::as_const(drainSessions)) {
+        if (!session->bulkInbound.isEmpty() || !session->controlInbound.isEmpty()) {
+            if (ioWorker->requestDrain()) {
+                QMetaObject::invokeMethod(this, &PipeServer::drainInbound, Qt::QueuedConnection);
+            }
             break;
         }
     }
+}
 
-    if (connectionId == -1) {
-        LogManager::log("Data from unknown connection", LogManager::Error);
+qint64 PipeServer::drainControlLane(ConnectionSession &session)
+{
+    // The control lane never carries the Disconnected item
+    qint64 bytesIn = 0;
+    PipeInboundMessage item;
+    for (int i = 0; i < kControlMessagesPerPass && session.controlInbound.tryPop(item); ++i) {
+        processMessage(session, item.message);
+        bytesIn += item.wireSize;
+    }
+    return bytesIn;
+}
+
+void PipeServer::accountTraffic(ConnectionSession &session, qint64 bytesIn)
+{
+    // Track bytes received and sent
+    qint64 bytesOut = session.bytesSent.exchange(0, std::memory_order_relaxed);
+    if (session.bot) {
+        session.bot->bytesReceived += bytesIn;
+        session.bot->bytesSent += bytesOut;
+    }
+}
+
+namespace {
+
+using ClientMessage = mankool::mcbot::protocol::ClientToManagerMessage;
+using PayloadFields = ClientMessage::PayloadFields;
+using PayloadHandler = void (*)(int connectionId, const ClientMessage &msg);
+
+struct PayloadRoute {
+    const char *name = nullptr;
+    PayloadHandler handler = nullptr;
+    bool writesWorld = false;  // Runs under the batch's world write lock inside a tick batch
+};
+
+using PayloadRouteTable = std::array<PayloadRoute, ConnectionSession::kPayloadSlots>;
+
+// Dispatch table indexed by the payload oneof field number
+const PayloadRouteTable &payloadRoutes()
+{
+    static const PayloadRouteTable routes = [] {
+        PayloadRouteTable table{};
+        auto route = [&table](PayloadFields field, const char *name, PayloadHandler handler,
+                              bool writesWorld = false) {
+            table[static_cast<int>(field)] = {name, handler, writesWorld};
+        };
+        route(PayloadFields::ConnectionInfo, "connection_info", [](int id, const ClientMessage &m) {
+            BotManager::handleConnectionInfo(id, m.connectionInfo());
+        });
+        route(PayloadFields::Heartbeat, "heartbeat", [](int id, const ClientMessage &m) {
+            BotManager::handleHeartbeat(id, m.heartbeat());
+        });
+        route(PayloadFields::ServerStatus, "server_status", [](int id, const ClientMessage &m) {
+            BotManager::handleServerStatus(id, m.serverStatus());
+        });
+        route(PayloadFields::PlayerState, "player_state", [](int id, const ClientMessage &m) {
+            BotManager::handlePlayerState(id, m.playerState());
+        });
+        route(PayloadFields::Inventory, "inventory", [](int id, const ClientMessage &m) {
+            BotManager::handleInventoryUpdate(id, m.inventory());
+        });
+        route(PayloadFields::Chat, "chat", [](int id, const ClientMessage &m) {
+            BotManager::handleChatMessage(id, m.chat());
+        });
+        route(PayloadFields::CommandResponse, "command_response", [](int id, const ClientMessage &m) {
+            BotManager::handleCommandResponse(id, m.commandResponse());
+        });
+        route(PayloadFields::ModulesResponse, "modules_response", [](int id, const ClientMessage &m) {
+            BotManager::handleModulesResponse(id, m.modulesResponse());
+        });
+        route(PayloadFields::ModuleConfigResponse, "module_config_response", [](int id, const ClientMessage &m) {
+            BotManager::handleModuleConfigResponse(id, m.moduleConfigResponse());
+        });
+        route(PayloadFields::ModuleStateChanged, "module_state_changed", [](int id, const ClientMessage &m) {
+            BotManager::handleModuleStateChanged(id, m.moduleStateChanged());
+        });
+        route(PayloadFields::BaritoneSettingsResponse, "baritone_settings_response", [](int id, const ClientMessage &m) {
+            BotManager::handleBaritoneSettingsResponse(id, m.baritoneSettingsResponse());
+        });
+        route(PayloadFields::BaritoneCommandsResponse, "baritone_commands_response", [](int id, const ClientMessage &m) {
+            BotManager::handleBaritoneCommandsResponse(id, m.baritoneCommandsResponse());
+        });
+        route(PayloadFields::BaritoneSettingsSetResponse, "baritone_settings_set_response", [](int id, const ClientMessage &m) {
+            BotManager::handleBaritoneSettingsSetResponse(id, m.baritoneSettingsSetResponse());
+        });
+        route(PayloadFields::BaritoneCommandResponse, "baritone_command_response", [](int id, const ClientMessage &m) {
+            BotManager::handleBaritoneCommandResponse(id, m.baritoneCommandResponse());
+        });
+        route(PayloadFields::BaritoneSettingUpdate, "baritone_setting_update", [](int id, const ClientMessage &m) {
+            BotManager::handleBaritoneSettingUpdate(id, m.baritoneSettingUpdate());
+        });
+        route(PayloadFields::BaritoneProcessStatus, "baritone_process_status", [](int id, const ClientMessage &m) {
+            BotManager::handleBaritoneProcessStatus(id, m.baritoneProcessStatus());
+        });
+        route(PayloadFields::ChunkData, "chunk_data", [](int id, const ClientMessage &m) {
+            BotManager::handleChunkData(id, m.chunkData());
+        });
+        route(PayloadFields::BlockUpdate, "block_update", [](int id, const ClientMessage &m) {
+            BotManager::handleBlockUpdate(id, m.blockUpdate());
+        }, true);
+        route(PayloadFields::MultiBlockUpdate, "multi_block_update", [](int id, const ClientMessage &m) {
+            BotManager::handleMultiBlockUpdate(id, m.multiBlockUpdate());
+        }, true);
+        route(PayloadFields::ChunkUnload, "chunk_unload", [](int id, const ClientMessage &m) {
+            BotManager::handleChunkUnload(id, m.chunkUnload());
+        }, true);
+        route(PayloadFields::Container, "container", [](int id, const ClientMessage &m) {
+            BotManager::handleContainerUpdate(id, m.container());
+        });
+        route(PayloadFields::Screen, "screen", [](int id, const ClientMessage &m) {
+            BotManager::handleScreenUpdate(id, m.screen());
+        });
+        route(PayloadFields::QueryRegistry, "query_registry", [](int id, const ClientMessage &m) {
+            BotManager::handleQueryRegistry(id, m.queryRegistry());
+        });
+        route(PayloadFields::BlockRegistry, "block_registry", [](int id, const ClientMessage &m) {
+            BotManager::handleBlockRegistry(id, m.blockRegistry());
+        });
+        route(PayloadFields::QueryItemRegistry, "query_item_registry", [](int id, const ClientMessage &m) {
+            BotManager::handleQueryItemRegistry(id, m.queryItemRegistry());
+        });
+        route(PayloadFields::ItemRegistry, "item_registry", [](int id, const ClientMessage &m) {
+            BotManager::handleItemRegistry(id, m.itemRegistry());
+        });
+        route(PayloadFields::CanReachBlockResponse, "can_reach_block_response", [](int id, const ClientMessage &m) {
+            BotManager::handleCanReachBlockResponse(id, m.canReachBlockResponse());
+        });
+        route(PayloadFields::CanReachBlocksResponse, "can_reach_blocks_response", [](int id, const ClientMessage &m) {
+            BotManager::handleCanReachBlocksResponse(id, m.canReachBlocksResponse());
+        });
+        route(PayloadFields::HoldAttackStatusResponse, "hold_attack_status_response", [](int id, const ClientMessage &m) {
+            BotManager::handleHoldAttackStatusResponse(id, m.holdAttackStatusResponse());
+        });
+        route(PayloadFields::EntityUpdate, "entity_update", [](int id, const ClientMessage &m) {
+            BotManager::handleEntityUpdate(id, m.entityUpdate());
+        }, true);
+        route(PayloadFields::WeatherUpdate, "weather_update", [](int id, const ClientMessage &m) {
+            BotManager::handleWeatherUpdate(id, m.weatherUpdate());
+        });
+        route(PayloadFields::LightUpdate, "light_update", [](int id, const ClientMessage &m) {
+            BotManager::handleLightUpdate(id, m.lightUpdate());
+        }, true);
+        route(PayloadFields::TabListUpdate, "tab_list_update", [](int id, const ClientMessage &m) {
+            BotManager::handleTabListUpdate(id, m.tabListUpdate());
+        });
+        route(PayloadFields::TabListRemove, "tab_list_remove", [](int id, const ClientMessage &m) {
+            BotManager::handleTabListRemove(id, m.tabListRemove());
+        });
+        route(PayloadFields::MapData, "map_data", [](int id, const ClientMessage &m) {
+            BotManager::handleMapData(id, m.mapData());
+        });
+        route(PayloadFields::StringDefinitions, "string_definitions", [](int id, const ClientMessage &m) {
+            BotManager::handleStringDefinitions(id, m.stringDefinitions());
+        });
+        // Unpacked by processTickBatch(); only named here for the stats
+        route(PayloadFields::TickBatch, "tick_batch", nullptr);
+        return table;
+    }();
+    return routes;
+}
+
+} // namespace
+
+void PipeServer::processMessage(ConnectionSession &session, const mankool::mcbot::protocol::ClientToManagerMessage &clientMsg)
+{
+    const int slot = ConnectionSession::payloadSlot(clientMsg);
+    if (slot == static_cast<int>(PayloadFields::TickBatch)) {
+        processTickBatch(session, clientMsg.tickBatch());
         return;
     }
 
-    QDataStream *stream = connectionStreams[connectionId];
-    if (!stream) {
-        LogManager::log("No data stream for connection", LogManager::Error);
+    const PayloadRoute &route = payloadRoutes()[slot];
+    if (!route.handler) {
         return;
     }
 
-    while (socket->bytesAvailable() >= 4) {
-        stream->startTransaction();
+    QElapsedTimer handlerTimer;
+    handlerTimer.start();
+    route.handler(session.connectionId, clientMsg);
+    session.messageStats[slot].handlerNs.fetch_add(handlerTimer.nsecsElapsed(), std::memory_order_relaxed);
+
+    if (slot == static_cast<int>(PayloadFields::Heartbeat)) {
+        acknowledgeHeartbeat(session, clientMsg);
+    } else if (slot == static_cast<int>(PayloadFields::ConnectionInfo)) {
+        session.bot = BotManager::getBotByConnectionId(session.connectionId);
+        QString botName = session.bot ? session.bot->name : clientMsg.connectionInfo().playerName();
+        connectionBotNames[session.connectionId] = botName;
+        emit clientConnected(session.connectionId, botName);
+    }
+}
 
-        quint32 messageLength;
-        *stream >> messageLength;
+void PipeServer::acknowledgeHeartbeat(ConnectionSession &session, const mankool::mcbot::protocol::ClientToManagerMessage &clientMsg)
+{
+    constexpr quint32 ackFeature = static_cast<quint32>(mankool::mcbot::protocol::ProtocolFeatureGadget::ProtocolFeature::HEARTBEAT_ACK);
+    if (!session.bot || !(session.bot->protocolFeatures & ackFeature)) {
+        return;
+    }
 
-        QByteArray messageData(messageLength, Qt::Uninitialized);
-        int bytesRead = stream->readRawData(messageData.data(), messageLength);
+    // Heartbeats overtake queued bulk data, so the count tells the client how far behind the manager is
+    mankool::mcbot::protocol::HeartbeatMessage ack;
+    ack.setBulkMessagesHandled(session.bulkHandled);
 
-        if (!stream->commitTransaction()) {
-            // Not enough data yet - wait for next readyRead
-            break;
-        }
+    mankool::mcbot::protocol::ManagerToClientMessage msg;
+    msg.setMessageId(clientMsg.messageId());
+    msg.setTimestamp(QDateTime::currentMSecsSinceEpoch());
+    msg.setHeartbeat(ack);
+    sendMessage(session.connectionId, msg);
+}
 
-        if (bytesRead != static_cast<int>(messageLength)) {
-            LogManager::log(QString("Read mismatch: expected %1, got %2").arg(messageLength).arg(bytesRead), LogManager::Error);
+void PipeServer::processTickBatch(ConnectionSession &session, const mankool::mcbot::protocol::ClientTickBatch &batch)
+{
+    const PayloadRouteTable &routes = payloadRoutes();
+
+    // Consecutive world updates share one write lock acquisition. Anything else
+    // runs with the lock released, since its handler may read the world itself.
+    WorldWriteBatch worldBatch(session.connectionId);
+    for (const ClientMessage &inner : batch.messages()) {
+        const int slot = ConnectionSession::payloadSlot(inner);
+        if (slot == static_cast<int>(PayloadFields::TickBatch)) {
+            LogManager::log(QString("Ignoring nested tick batch from connection %1")
+                           .arg(session.connectionId), LogManager::Warning);
             continue;
         }
 
-        processMessage(connectionId, messageData);
-
-        // Track bytes received
-        BotInstance *bot = BotManager::getBotByConnectionId(connectionId);
-        if (bot) {
-            bot->bytesReceived += messageLength + 4; // Include length prefix
+        if (routes[slot].writesWorld) {
+            worldBatch.acquire();
+        } else {
+            worldBatch.release();
         }
+
+        // Inner messages were decoded with the batch, so only their count is known here
+        session.messageStats[slot].count.fetch_add(1, std::memory_order_relaxed);
+        processMessage(session, inner);
     }
 }
 
-void PipeServer::processMessage(int connectionId, const QByteArray &data)
-{
-    QProtobufSerializer serializer;
-
-    mankool::mcbot::protocol::ClientToManagerMessage clientMsg;
-    if (serializer.deserialize(&clientMsg, data)) {
-        if (clientMsg.hasConnectionInfo()) {
-            BotManager::handleConnectionInfo(connectionId, clientMsg.connectionInfo());
-            BotInstance *connectedBot = BotManager::getBotByConnectionId(connectionId);
-            QString botName = connectedBot ? connectedBot->name : clientMsg.connectionInfo().playerName();
-            connectionBotNames[connectionId] = botName;
-            emit clientConnected(connectionId, botName);
-        } else if (clientMsg.hasHeartbeat()) {
-            BotManager::handleHeartbeat(connectionId, clientMsg.heartbeat());
-        } else if (clientMsg.hasServerStatus()) {
-            BotManager::handleServerStatus(connectionId, clientMsg.serverStatus());
-        } else if (clientMsg.hasPlayerState()) {
-            BotManager::handlePlayerState(connectionId, clientMsg.playerState());
-        } else if (clientMsg.hasInventory()) {
-            BotManager::handleInventoryUpdate(connectionId, clientMsg.inventory());
-        } else if (clientMsg.hasChat()) {
-            BotManager::handleChatMessage(connectionId, clientMsg.chat());
-        } else if (clientMsg.hasCommandResponse()) {
-            BotManager::handleCommandResponse(connectionId, clientMsg.commandResponse());
-        } else if (clientMsg.hasModulesResponse()) {
-            BotManager::handleModulesResponse(connectionId, clientMsg.modulesResponse());
-        } else if (clientMsg.hasModuleConfigResponse()) {
-            BotManager::handleModuleConfigResponse(connectionId, clientMsg.moduleConfigResponse());
-        } else if (clientMsg.hasModuleStateChanged()) {
-            BotManager::handleModuleStateChanged(connectionId, clientMsg.moduleStateChanged());
-        } else if (clientMsg.hasBaritoneSettingsResponse()) {
-            BotManager::handleBaritoneSettingsResponse(connectionId, clientMsg.baritoneSettingsResponse());
-        } else if (clientMsg.hasBaritoneCommandsResponse()) {
-            BotManager::handleBaritoneCommandsResponse(connectionId, clientMsg.baritoneCommandsResponse());
-        } else if (clientMsg.hasBaritoneSettingsSetResponse()) {
-            BotManager::handleBaritoneSettingsSetResponse(connectionId, clientMsg.baritoneSettingsSetResponse());
-        } else if (clientMsg.hasBaritoneCommandResponse()) {
-            BotManager::handleBaritoneCommandResponse(connectionId, clientMsg.baritoneCommandResponse());
-        } else if (clientMsg.hasBaritoneSettingUpdate()) {
-            BotManager::handleBaritoneSettingUpdate(connectionId, clientMsg.baritoneSettingUpdate());
-        } else if (clientMsg.hasBaritoneProcessStatus()) {
-            BotManager::handleBaritoneProcessStatus(connectionId, clientMsg.baritoneProcessStatus());
-        } else if (clientMsg.hasChunkData()) {
-            BotManager::handleChunkData(connectionId, clientMsg.chunkData());
-        } else if (clientMsg.hasBlockUpdate()) {
-            BotManager::handleBlockUpdate(connectionId, clientMsg.blockUpdate());
-        } else if (clientMsg.hasMultiBlockUpdate()) {
-            BotManager::handleMultiBlockUpdate(connectionId, clientMsg.multiBlockUpdate());
-        } else if (clientMsg.hasChunkUnload()) {
-            BotManager::handleChunkUnload(connectionId, clientMsg.chunkUnload());
-        } else if (clientMsg.hasContainer()) {
-            BotManager::handleContainerUpdate(connectionId, clientMsg.container());
-        } else if (clientMsg.hasScreen()) {
-            BotManager::handleScreenUpdate(connectionId, clientMsg.screen());
-        } else if (clientMsg.hasQueryRegistry()) {
-            BotManager::handleQueryRegistry(connectionId, clientMsg.queryRegistry());
-        } else if (clientMsg.hasBlockRegistry()) {
-            BotManager::handleBlockRegistry(connectionId, clientMsg.blockRegistry());
-        } else if (clientMsg.hasQueryItemRegistry()) {
-            BotManager::handleQueryItemRegistry(connectionId, clientMsg.queryItemRegistry());
-        } else if (clientMsg.hasItemRegistry()) {
-            BotManager::handleItemRegistry(connectionId, clientMsg.itemRegistry());
-        } else if (clientMsg.hasCanReachBlockResponse()) {
-            BotManager::handleCanReachBlockResponse(connectionId, clientMsg.canReachBlockResponse());
-        } else if (clientMsg.hasHoldAttackStatusResponse()) {
-            BotManager::handleHoldAttackStatusResponse(connectionId, clientMsg.holdAttackStatusResponse());
-        } else if (clientMsg.hasEntityUpdate()) {
-            BotManager::handleEntityUpdate(connectionId, clientMsg.entityUpdate());
-        } else if (clientMsg.hasWeatherUpdate()) {
-            BotManager::handleWeatherUpdate(connectionId, clientMsg.weatherUpdate());
-        } else if (clientMsg.hasLightUpdate()) {
-            BotManager::handleLightUpdate(connectionId, clientMsg.lightUpdate());
-        } else if (clientMsg.hasTabListUpdate()) {
-            BotManager::handleTabListUpdate(connectionId, clientMsg.tabListUpdate());
-        } else if (clientMsg.hasTabListRemove()) {
-            BotManager::handleTabListRemove(connectionId, clientMsg.tabListRemove());
-        } else if (clientMsg.hasMapData()) {
-            BotManager::handleMapData(connectionId, clientMsg.mapData());
-        }
-        return;
-    }
+void PipeServer::handleClientDisconnection(ConnectionSession &session)
+{
+    // Scripts waiting on this client get an answer now rather than at their deadline
+    BotManager::failPendingRequests(session.connectionId);
+    emit clientDisconnected(session.connectionId);
 
-    LogManager::log(QString("Failed to parse message (%1 bytes)").arg(data.size()),
-                    LogManager::Error);
+    session.bot = nullptr;
+    connectionBotNames.remove(session.connectionId);
+    ioWorker->releaseSession(session.connectionId);
 }
 
+void PipeServer::endReplaySession(ConnectionSession &session)
+{
+    // Unlike a real disconnect this doesn't emit clientDisconnected, so the
+    // window won't try to auto-restart a bot that was never launched
+    BotManager::failPendingRequests(session.connectionId);
+    BotInstance *bot = BotManager::getBotByConnectionId(session.connectionId);
+    if (bot) {
+        BotManager::clearConnectionId(bot);
+        bot->status = BotStatus::Offline;
+    }
+    session.bot = nullptr;
+    connectionBotNames.remove(session.connectionId);
+}
 
-void PipeServer::handleClientDisconnection()
+bool PipeServer::startCapture(const QString &path)
 {
-    QLocalSocket *socket = qobject_cast<QLocalSocket*>(sender());
-    if (!socket) {
-        return;
+    PipeIoWorker *worker = instance().ioWorker;
+    if (!worker) {
+        LogManager::log("Cannot start capture: pipe server is not running", LogManager::Error);
+        return false;
     }
 
-    for (auto it = connections.begin(); it != connections.end(); ++it) {
-        if (it.value() == socket) {
-            int connectionId = it.key();
+    bool started = false;
+    QString errorString;
+    QMetaObject::invokeMethod(worker, [worker, &path, &started, &errorString]() {
+        started = worker->startCapture(path, &errorString);
+    }, Qt::BlockingQueuedConnection);
 
-            LogManager::log(QString("Client disconnected (Connection ID: %1)").arg(connectionId), LogManager::Warning);
+    if (!started) {
+        LogManager::log(QString("Cannot start capture to '%1': %2").arg(path, errorString), LogManager::Error);
+        return false;
+    }
+    LogManager::log(QString("Capturing client traffic to '%1'").arg(path), LogManager::Info);
+    return true;
+}
 
-            emit clientDisconnected(connectionId);
+void PipeServer::stopCapture()
+{
+    PipeIoWorker *worker = instance().ioWorker;
+    if (worker) {
+        QMetaObject::invokeMethod(worker, [worker]() {
+            worker->stopCapture();
+        }, Qt::BlockingQueuedConnection);
+    }
+}
 
-            connections.remove(connectionId);
-            connectionBotNames.remove(connectionId);
+PipeReplay *PipeServer::startReplay(const QString &path, double speed)
+{
+    auto *replay = new PipeReplay(speed, &instance());
+    QString errorString;
+    if (!replay->open(path, &errorString)) {
+        LogManager::log(QString("Cannot replay '%1': %2").arg(path, errorString), LogManager::Error);
+        delete replay;
+        return nullptr;
+    }
+    connect(replay, &PipeReplay::finished, replay, &QObject::deleteLater);
+    replay->start();
+    return replay;
+}
 
-            if (connectionStreams.contains(connectionId)) {
-                delete connectionStreams[connectionId];
-                connectionStreams.remove(connectionId);
-            }
-            break;
+void PipeServer::unbindBot(const BotInstance *bot)
+{
+    PipeServer &inst = instance();
+    if (!inst.ioWorker) {
+        return;
+    }
+    const auto sessions = inst.ioWorker->sessions();
+    for (const auto &session : sessions) {
+        if (session->bot == bot) {
+            session->bot = nullptr;
         }
     }
+}
+
+QList<MessageTypeStatsSnapshot> PipeServer::getMessageStats(int connectionId)
+{
+    QList<MessageTypeStatsSnapshot> result;
+    PipeIoWorker *worker = instance().ioWorker;
+    std::shared_ptr<ConnectionSession> session = worker ? worker->session(connectionId) : nullptr;
+    if (!session) {
+        return result;
+    }
 
-    socket->deleteLater();
+    const PayloadRouteTable &routes = payloadRoutes();
+    for (int slot = 0; slot < ConnectionSession::kPayloadSlots; ++slot) {
+        const MessageTypeStats &stats = session->messageStats[slot];
+        quint64 count = stats.count.load(std::memory_order_relaxed);
+        if (count == 0 || !routes[slot].name) {
+            continue;
+        }
+        MessageTypeStatsSnapshot snapshot;
+        snapshot.type = QString::fromLatin1(routes[slot].name);
+        snapshot.count = count;
+        snapshot.bytes = stats.bytes.load(std::memory_order_relaxed);
+        snapshot.decodeNs = stats.decodeNs.load(std::memory_order_relaxed);
+        snapshot.handlerNs = stats.handlerNs.load(std::memory_order_relaxed);
+        result.append(snapshot);
+    }
+    return result;
 }
 
 void PipeServer::sendToClient(int connectionId, const QByteArray &data)
 {
-    PipeServer *inst = &instance();
-    if (QThread::currentThread() == inst->thread()) {
-        inst->sendToClientImpl(connectionId, data);
-    } else {
-        QMetaObject::invokeMethod(inst, [inst, connectionId, data]() {
-            inst->sendToClientImpl(connectionId, data);
-        }, Qt::QueuedConnection);
-    }
+    instance().enqueueOutbound(connectionId, data, false);
 }
 
-void PipeServer::sendToClientImpl(int connectionId, const QByteArray &data)
+bool PipeServer::sendMessage(int connectionId, const mankool::mcbot::protocol::ManagerToClientMessage &msg)
 {
-    if (!connections.contains(connectionId)) {
-        LogManager::log(QString("No connection found for ID: %1").arg(connectionId), LogManager::Error);
-        return;
+    thread_local QProtobufSerializer serializer;
+    QByteArray payload = serializer.serialize(&msg);
+    if (payload.isEmpty()) {
+        LogManager::log("Failed to serialize outbound message", LogManager::Error);
+        return false;
     }
+    return instance().enqueueOutbound(connectionId, payload, true);
+}
 
-    QLocalSocket *socket = connections[connectionId];
-    socket->write(data);
-    socket->flush();
+bool PipeServer::enqueueOutbound(int connectionId, QByteArrayView data, bool addLengthPrefix)
+{
+    // Safe from any thread; the write itself happens on the I/O thread
+    PipeIoWorker *worker = ioWorker;
+    std::shared_ptr<ConnectionSession> session = worker ? worker->session(connectionId) : nullptr;
+    if (!session) {
+        // Replayed connections have no client to answer, so their replies are expected to go nowhere
+        if (connectionId >= PipeReplay::kConnectionIdOffset) {
+            LogManager::log(QString("Dropped reply to replayed connection %1").arg(connectionId), LogManager::Debug);
+        } else {
+            LogManager::log(QString("No connection found for ID: %1").arg(connectionId), LogManager::Error);
+        }
+        return false;
+    }
 
-    // Track bytes sent
-    BotInstance *bot = BotManager::getBotByConnectionId(connectionId);
-    if (bot) {
-        bot->bytesSent += data.size();
+    bool scheduleFlush = false;
+    {
+        QMutexLocker locker(&session->outboundMutex);
+        if (addLengthPrefix) {
+            char prefix[4];
+            qToLittleEndian<quint32>(static_cast<quint32>(data.size()), prefix);
+            session->outboundArena.append(prefix, 4);
+        }
+        session->outboundArena.append(data.data(), data.size());
+        if (!session->outboundFlushScheduled) {
+            session->outboundFlushScheduled = true;
+            scheduleFlush = true;
+        }
+    }
+    session->outboundFrames.fetch_add(1, std::memory_order_relaxed);
+
+    // One flush per event loop turn of the I/O thread, however many frames were queued
+    if (scheduleFlush) {
+        std::weak_ptr<ConnectionSession> weak = session;
+        QMetaObject::invokeMethod(worker, [worker, weak]() {
+            if (std::shared_ptr<ConnectionSession> s = weak.lock()) {
+                worker->flushOutbound(s.get());
+            }
+        }, Qt::QueuedConnection);
     }
+    return true;
 }
 
 void PipeServer::broadcastToAll(const QByteArray &data)
@@ -324,11 +614,13 @@ void PipeServer::broadcastToAll(const QByteArray &data)
 
 void PipeServer::broadcastToAllImpl(const QByteArray &data)
 {
-    for (QLocalSocket *socket : std::as_const(connections)) {
-        socket->write(data);
+    PipeIoWorker *worker = ioWorker;
+    if (!worker) {
+        return;
     }
-
-    LogManager::log(QString("Broadcast %1 bytes to %2 connected clients").arg(data.size()).arg(connections.size()), LogManager::Info);
+    QMetaObject::invokeMethod(worker, [worker, data]() {
+        worker->writeToAll(data);
+    }, Qt::QueuedConnection);
 }
 
 int PipeServer::getConnectionId(const QString &botName)
@@ -353,5 +645,63 @@ QList<int> PipeServer::getAllConnectionIds()
 
 QList<int> PipeServer::getAllConnectionIdsImpl() const
 {
-    return connections.keys();
+    QList<int> ids;
+    if (ioWorker) {
+        const auto sessions = ioWorker->sessions();
+        for (const auto &session : sessions) {
+            ids.append(session->connectionId);
+        }
+    }
+    return ids;
+}
+
+FrameReaderStatsSnapshot PipeServer::getReaderStats(int connectionId)
+{
+    FrameReaderStatsSnapshot snapshot;
+    PipeIoWorker *worker = instance().ioWorker;
+    std::shared_ptr<ConnectionSession> session = worker ? worker->session(connectionId) : nullptr;
+    if (!session) {
+        return snapshot;
+    }
+
+    const FrameReaderStats &stats = session->reader.stats();
+    snapshot.bytesRead = stats.bytesRead.load(std::memory_order_relaxed);
+    snapshot.bytesCopied = stats.bytesCopied.load(std::memory_order_relaxed);
+    snapshot.frames = stats.frames.load(std::memory_order_relaxed);
+    snapshot.zeroCopyFrames = stats.zeroCopyFrames.load(std::memory_order_relaxed);
+    snapshot.poolHits = stats.poolHits.load(std::memory_order_relaxed);
+    snapshot.poolMisses = stats.poolMisses.load(std::memory_order_relaxed);
+    return snapshot;
+}
+
+InboundLanesSnapshot PipeServer::getLaneStats(int connectionId)
+{
+    InboundLanesSnapshot snapshot;
+    PipeIoWorker *worker = instance().ioWorker;
+    std::shared_ptr<ConnectionSession> session = worker ? worker->session(connectionId) : nullptr;
+    if (!session) {
+        return snapshot;
+    }
+
+    auto fill = [&session](ConnectionSession::Lane lane, LaneStatsSnapshot &out) {
+        const LaneStats &stats = session->laneStats(lane);
+        out.messages = stats.messages.load(std::memory_order_relaxed);
+        out.maxDepth = stats.maxDepth.load(std::memory_order_relaxed);
+        out.depth = static_cast<quint64>(session->inboundQueue(lane).size());
+    };
+    fill(ConnectionSession::Lane::Control, snapshot.control);
+    fill(ConnectionSession::Lane::Bulk, snapshot.bulk);
+    return snapshot;
+}
+
+OutboundStatsSnapshot PipeServer::getOutboundStats(int connectionId)
+{
+    OutboundStatsSnapshot snapshot;
+    PipeIoWorker *worker = instance().ioWorker;
+    std::shared_ptr<ConnectionSession> session = worker ? worker->session(connectionId) : nullptr;
+    if (session) {
+        snapshot.frames = session->outboundFrames.load(std::memory_order_relaxed);
+        snapshot.writes = session->outboundWrites.load(std::memory_order_relaxed);
+    }
+    return snapshot;
 }
@@ -8,11 +8,14 @@
 #include <QJsonDocument>
 #include <QMap>
 #include <QByteArray>
-#include <QDataStream>
+#include <QThread>
+#include <memory>
 #include "protocol.qpb.h"
 #include "bot/BotManager.h"
+#include "network/PipeIoWorker.h"
 
 class LogManager;
+class PipeReplay;
 
 class PipeServer : public QObject
 {
@@ -29,37 +32,71 @@ public:
     static void stop();
 
     static void sendToClient(int connectionId, const QByteArray &data);
+    // Serializes and frames msg into the connection's outbound arena; safe from any thread
+    static bool sendMessage(int connectionId, const mankool::mcbot::protocol::ManagerToClientMessage &msg);
     static void broadcastToAll(const QByteArray &data);
 
     static int getConnectionId(const QString &botName);
     static QList<int> getAllConnectionIds();
 
+    // Drops any session binding to this bot; call before the BotInstance is deleted
+    static void unbindBot(const BotInstance *bot);
+    // Per payload type counters for one connection; safe from any thread
+    static QList<MessageTypeStatsSnapshot> getMessageStats(int connectionId);
+    // Frame reader and buffer pool counters for one connection; safe from any thread
+    static FrameReaderStatsSnapshot getReaderStats(int connectionId);
+    static OutboundStatsSnapshot getOutboundStats(int connectionId);
+    // Inbound control/bulk lane counters and queue depths; safe from any thread
+    static InboundLanesSnapshot getLaneStats(int connectionId);
+
+    // Records every inbound client frame to a capture file (see PipeCapture.h)
+    static bool startCapture(const QString &path);
+    static void stopCapture();
+    // Feeds a capture through the message handlers. The replay deletes itself after finished().
+    static PipeReplay *startReplay(const QString &path, double speed);
+
 signals:
     void clientConnected(int connectionId, const QString &botName);
     void clientDisconnected(int connectionId);
 
 private slots:
-    void handleNewConnection();
-    void handleClientData();
-    void handleClientDisconnection();
+    void drainInbound();
 
 private:
+    friend class PipeReplay;
+
     explicit PipeServer();
     ~PipeServer();
 
     bool startImpl(const QString &pipeName);
     void stopImpl();
-    void sendToClientImpl(int connectionId, const QByteArray &data);
+    bool enqueueOutbound(int connectionId, QByteArrayView data, bool addLengthPrefix);
     void broadcastToAllImpl(const QByteArray &data);
     int getConnectionIdImpl(const QString &botName) const;
     QList<int> getAllConnectionIdsImpl() const;
 
-    void processMessage(int connectionId, const QByteArray &data);
-    QLocalServer *server;
-    QMap<int, QLocalSocket*> connections;
+    void processMessage(ConnectionSession &session, const mankool::mcbot::protocol::ClientToManagerMessage &clientMsg);
+    void processTickBatch(ConnectionSession &session, const mankool::mcbot::protocol::ClientTickBatch &batch);
+    void acknowledgeHeartbeat(ConnectionSession &session, const mankool::mcbot::protocol::ClientToManagerMessage &clientMsg);
+    void handleClientDisconnection(ConnectionSession &session);
+    void endReplaySession(ConnectionSession &session);
+    void refreshDrainSessions();
+    qint64 drainControlLane(ConnectionSession &session);
+    void accountTraffic(ConnectionSession &session, qint64 bytesIn);
+
+    // Upper bounds for one drainInbound() pass on the GUI thread
+    static constexpr int kMessagesPerSlice = 16;
+    static constexpr int kControlMessagesPerPass = 64;
+    static constexpr qint64 kDrainBudgetNs = 8 * 1000 * 1000;
+
+    // Socket I/O and protobuf decoding run on ioThread; handlers run here
+    QThread *ioThread;
+    PipeIoWorker *ioWorker;
+    QList<std::shared_ptr<ConnectionSession>> drainSessions;
+    int drainSessionsVersion;
+    int drainCursor;
+
     QMap<int, QString> connectionBotNames;
-    QMap<int, QDataStream*> connectionStreams;  // Data streams for each connection
-    int nextConnectionId;
     QString serverPipeName;
 };
 
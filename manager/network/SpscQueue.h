@@ -0,0 +1,79 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <optional>
+#include <utility>
+
+// Unbounded lock-free single-producer/single-consumer queue.
+// push() must only be called from one thread and tryPop()/isEmpty() from one
+// other thread. size() may be read from anywhere and is approximate.
+template <typename T>
+class SpscQueue
+{
+public:
+    SpscQueue()
+    {
+        head = tail = new Node();
+    }
+
+    ~SpscQueue()
+    {
+        Node *node = head;
+        while (node) {
+            Node *next = node->next.load(std::memory_order_relaxed);
+            delete node;
+            node = next;
+        }
+    }
+
+    SpscQueue(const SpscQueue&) = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side
+    void push(T value)
+    {
+        Node *node = new Node();
+        node->value.emplace(std::move(value));
+        depth.fetch_add(1, std::memory_order_relaxed);
+        tail->next.store(node, std::memory_order_release);
+        tail = node;
+    }
+
+    // Consumer side
+    bool tryPop(T &out)
+    {
+        Node *next = head->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        out = std::move(*next->value);
+        next->value.reset();
+        delete head;
+        head = next;
+        depth.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool isEmpty() const
+    {
+        return head->next.load(std::memory_order_acquire) == nullptr;
+    }
+
+    int size() const
+    {
+        return depth.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Node {
+        std::atomic<Node*> next{nullptr};
+        std::optional<T> value;
+    };
+
+    alignas(64) Node *head;  // Consumer only
+    alignas(64) Node *tail;  // Producer only
+    alignas(64) std::atomic<int> depth{0};
+};
+
+#endif // SPSCQUEUE_H
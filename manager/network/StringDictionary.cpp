@@ -0,0 +1,72 @@
+#include "StringDictionary.h"
+#include <QMutexLocker>
+#include <algorithm>
+
+StringInterner& StringInterner::instance()
+{
+    static StringInterner instance;
+    return instance;
+}
+
+QString StringInterner::intern(const QString &value)
+{
+    if (value.isEmpty()) {
+        return QString();
+    }
+
+    StringInterner &inst = instance();
+    QMutexLocker locker(&inst.mutex);
+    auto it = inst.strings.constFind(value);
+    if (it != inst.strings.constEnd()) {
+        return *it;
+    }
+    inst.strings.insert(value);
+    return value;
+}
+
+int StringInterner::size()
+{
+    StringInterner &inst = instance();
+    QMutexLocker locker(&inst.mutex);
+    return inst.strings.size();
+}
+
+quint32 StringInterner::idFor(const QString &value)
+{
+    if (value.isEmpty()) {
+        return 0;
+    }
+
+    StringInterner &inst = instance();
+    QMutexLocker locker(&inst.mutex);
+    auto it = inst.ids.constFind(value);
+    if (it != inst.ids.constEnd()) {
+        return *it;
+    }
+    auto sit = inst.strings.constFind(value);
+    const QString shared = sit != inst.strings.constEnd() ? *sit : *inst.strings.insert(value);
+    const quint32 id = static_cast<quint32>(inst.byId.size());
+    inst.byId.append(shared);
+    inst.ids.insert(shared, id);
+    return id;
+}
+
+QString StringInterner::stringFor(quint32 id)
+{
+    StringInterner &inst = instance();
+    QMutexLocker locker(&inst.mutex);
+    return id < static_cast<quint32>(inst.byId.size()) ? inst.byId[id] : QString();
+}
+
+bool SessionStringTable::define(quint32 id, const QString &value)
+{
+    const quint32 nextId = std::max<quint32>(1, static_cast<quint32>(strings.size()));
+    if (id == 0 || id > kMaxId || id >= nextId + kMaxIdGap) {
+        return false;
+    }
+    if (id >= static_cast<quint32>(strings.size())) {
+        strings.resize(id + 1);
+    }
+    strings[id] = StringInterner::intern(value);
+    return true;
+}
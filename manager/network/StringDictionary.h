@@ -0,0 +1,56 @@
+#ifndef STRINGDICTIONARY_H
+#define STRINGDICTIONARY_H
+
+#include <QString>
+#include <QSet>
+#include <QHash>
+#include <QVector>
+#include <QMutex>
+
+// Process-wide pool of identifier strings (dimensions, biomes, entity types).
+// Equal identifiers share one QString buffer no matter which bot or message
+// they came from. Safe from any thread.
+class StringInterner
+{
+public:
+    static QString intern(const QString &value);
+    static int size();
+
+    // Small stable id for an identifier, for compact storage such as biome
+    // palettes. 0 is the empty string; ids are never reused.
+    static quint32 idFor(const QString &value);
+    static QString stringFor(quint32 id);  // Empty for 0 and unknown ids
+
+private:
+    static StringInterner& instance();
+
+    QMutex mutex;
+    QSet<QString> strings;
+    QHash<QString, quint32> ids;
+    QVector<QString> byId{QString()};
+};
+
+// Per-connection id -> string table, filled from the client's
+// StringDefinitions messages (STRING_DICTIONARY feature). Values are interned.
+class SessionStringTable
+{
+public:
+    // Ids are assigned densely from 1 by the client, so a new id may only run a little
+    // past the ones already defined; anything further, or past kMaxId, is rejected
+    static constexpr quint32 kMaxId = 1 << 20;
+    static constexpr quint32 kMaxIdGap = 64;
+
+    bool define(quint32 id, const QString &value);
+    // Empty for 0 (no reference) and unknown ids
+    QString resolve(quint32 id) const
+    {
+        return id < static_cast<quint32>(strings.size()) ? strings[id] : QString();
+    }
+    void clear() { strings.clear(); }
+    int size() const { return strings.size(); }
+
+private:
+    QVector<QString> strings;
+};
+
+#endif // STRINGDICTIONARY_H
@@ -55,8 +55,11 @@ static std::optional<nbt::tag_list> readEnderItemsFromPlayerDat(const QString& f
 ChunkSavingWorker::ChunkSavingWorker(QObject *parent) : QObject(parent) {}
 ChunkSavingWorker::~ChunkSavingWorker() = default;
 
-void ChunkSavingWorker::processChunk(const ChunkData& chunk, const QVector<BlockEntityData>& blockEntities,
+void ChunkSavingWorker::processChunk(std::shared_ptr<const ChunkData> chunkRef, const QVector<BlockEntityData>& blockEntities,
                                       const QString& worldPath, int dataVersion) {
+    if (!chunkRef) return;
+    const ChunkData& chunk = *chunkRef;
+
     // Determine dimension path (version-aware: 26.1+ uses dimensions/ subdirectory)
     QString dimensionPath = WorldExporter::getDimensionPath(worldPath, chunk.dimension, dataVersion);
     QString dimensionName;
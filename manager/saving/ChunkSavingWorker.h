@@ -11,7 +11,7 @@ public:
     ~ChunkSavingWorker();
 
 public slots:
-    void processChunk(const ChunkData& chunk, const QVector<BlockEntityData>& blockEntities,
+    void processChunk(std::shared_ptr<const ChunkData> chunkRef, const QVector<BlockEntityData>& blockEntities,
                       const QString& worldPath, int dataVersion);
     void processEntityChunk(int chunkX, int chunkZ, const QString& dimension,
                             const QVector<EntityData>& entities,
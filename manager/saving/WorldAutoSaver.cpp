@@ -90,10 +90,11 @@ WorldAutoSaver::~WorldAutoSaver() {
     }
 }
 
-void WorldAutoSaver::saveChunkAsync(const ChunkData& chunk, const QVector<BlockEntityData>& blockEntities) {
+void WorldAutoSaver::saveChunkAsync(std::shared_ptr<const ChunkData> chunk, const QVector<BlockEntityData>& blockEntities) {
+    if (!chunk) return;
     if (!m_isInitialized) {
         LogManager::log(QString("WorldAutoSaver not initialized, cannot save chunk (%1, %2)")
-                       .arg(chunk.chunkX).arg(chunk.chunkZ), LogManager::Warning);
+                       .arg(chunk->chunkX).arg(chunk->chunkZ), LogManager::Warning);
         return;
     }
 
@@ -102,7 +103,7 @@ void WorldAutoSaver::saveChunkAsync(const ChunkData& chunk, const QVector<BlockE
         filteredBEs = blockEntities;
     }
 
-    emit chunkReadyForSaving(chunk, filteredBEs, m_worldPath, m_version.dataVersion);
+    emit chunkReadyForSaving(std::move(chunk), filteredBEs, m_worldPath, m_version.dataVersion);
 }
 
 void WorldAutoSaver::setChunkProvider(ChunkProvider provider) {
@@ -217,7 +218,7 @@ void WorldAutoSaver::flushPeriodic() {
         for (const DimChunkPos& key : dirtyChunks) {
             auto result = m_chunkProvider(key.chunkX, key.chunkZ, key.dimension);
             if (result) {
-                saveChunkAsync(result->first, result->second);
+                saveChunkAsync(std::move(result->first), result->second);
             }
         }
     }
@@ -42,9 +42,10 @@ public:
     ~WorldAutoSaver();
 
     // Called with (chunkX, chunkZ, dimension) -> chunk + block entities, or nullopt if not loaded
-    using ChunkProvider = std::function<std::optional<std::pair<ChunkData, QVector<BlockEntityData>>>(int, int, const QString&)>;
+    using ChunkProvider = std::function<std::optional<std::pair<std::shared_ptr<const ChunkData>, QVector<BlockEntityData>>>(int, int, const QString&)>;
 
-    void saveChunkAsync(const ChunkData& chunk, const QVector<BlockEntityData>& blockEntities = {});
+    // The chunk is handed to the worker thread as is; callers must not modify it afterwards
+    void saveChunkAsync(std::shared_ptr<const ChunkData> chunk, const QVector<BlockEntityData>& blockEntities = {});
     void setChunkProvider(ChunkProvider provider);
     void markBlockChunkDirty(int chunkX, int chunkZ, const QString& dimension);
     void onEntitiesUpdated(const QVector<EntityData>& upserted, const QVector<int>& removed,
@@ -62,7 +63,7 @@ public:
     const WorldSaveSettings& getSaveSettings() const { return m_saveSettings; }
 
 signals:
-    void chunkReadyForSaving(const ChunkData& chunk, const QVector<BlockEntityData>& blockEntities,
+    void chunkReadyForSaving(std::shared_ptr<const ChunkData> chunk, const QVector<BlockEntityData>& blockEntities,
                              const QString& worldPath, int dataVersion);
     void entityChunkReadyForSaving(int chunkX, int chunkZ, const QString& dimension,
                                    const QVector<EntityData>& entities,
@@ -1,5 +1,6 @@
 #include "PythonAPI.h"
 #include "bot/BotManager.h"
+#include "network/PipeServer.h"
 #include "ui/BotConsoleWidget.h"
 #include "ui/AppColors.h"
 #include "prism/PrismLauncherManager.h"
@@ -13,8 +14,10 @@
 #include <QCoreApplication>
 #include <QThread>
 #include <QReadWriteLock>
+#include <QThreadPool>
 #include <QDateTime>
 #include <pybind11/stl.h>
+#include <algorithm>
 
 thread_local QString PythonAPI::currentBot;
 thread_local QString PythonAPI::currentScript;
@@ -832,11 +835,69 @@ py::dict PythonAPI::getNetworkStats(const std::string &botName)
         result["bytes_sent"] = static_cast<long long>(bot->bytesSent);
         result["data_rate_in"] = bot->dataRateIn;
         result["data_rate_out"] = bot->dataRateOut;
+
+        py::dict messages;
+        for (const MessageTypeStatsSnapshot &stats : PipeServer::getMessageStats(bot->connectionId)) {
+            py::dict entry;
+            entry["count"] = stats.count;
+            entry["bytes"] = stats.bytes;
+            entry["decode_ms"] = stats.decodeNs / 1e6;
+            entry["handler_ms"] = stats.handlerNs / 1e6;
+            messages[py::str(stats.type.toStdString())] = entry;
+        }
+        result["messages"] = messages;
+
+        FrameReaderStatsSnapshot readerStats = PipeServer::getReaderStats(bot->connectionId);
+        quint64 poolRequests = readerStats.poolHits + readerStats.poolMisses;
+        py::dict reader;
+        reader["bytes_read"] = readerStats.bytesRead;
+        reader["bytes_copied"] = readerStats.bytesCopied;
+        reader["frames"] = readerStats.frames;
+        reader["zero_copy_frames"] = readerStats.zeroCopyFrames;
+        reader["pool_hits"] = readerStats.poolHits;
+        reader["pool_misses"] = readerStats.poolMisses;
+        reader["pool_hit_rate"] = poolRequests > 0 ? double(readerStats.poolHits) / poolRequests : 0.0;
+        result["reader"] = reader;
+
+        OutboundStatsSnapshot outboundStats = PipeServer::getOutboundStats(bot->connectionId);
+        py::dict outbound;
+        outbound["frames"] = outboundStats.frames;
+        outbound["writes"] = outboundStats.writes;
+        result["outbound"] = outbound;
+
+        InboundLanesSnapshot laneStats = PipeServer::getLaneStats(bot->connectionId);
+        auto laneDict = [](const LaneStatsSnapshot &lane, int clientQueued) {
+            py::dict d;
+            d["messages"] = lane.messages;
+            d["queued"] = lane.depth;
+            d["max_queued"] = lane.maxDepth;
+            d["client_queued"] = clientQueued;
+            return d;
+        };
+        py::dict lanes;
+        lanes["control"] = laneDict(laneStats.control, bot->clientControlQueueDepth);
+        lanes["bulk"] = laneDict(laneStats.bulk, bot->clientBulkQueueDepth);
+        result["lanes"] = lanes;
+
+        ReachabilityCache::Stats reachStats = bot->reachCache->stats();
+        quint64 reachQueries = reachStats.hits + reachStats.misses;
+        py::dict reachCache;
+        reachCache["hits"] = reachStats.hits;
+        reachCache["misses"] = reachStats.misses;
+        reachCache["hit_rate"] = reachQueries > 0 ? double(reachStats.hits) / reachQueries : 0.0;
+        reachCache["entries"] = reachStats.entries;
+        reachCache["invalidated"] = reachStats.invalidated;
+        result["reach_cache"] = reachCache;
     } else {
         result["bytes_received"] = 0LL;
         result["bytes_sent"] = 0LL;
         result["data_rate_in"] = 0.0;
         result["data_rate_out"] = 0.0;
+        result["messages"] = py::dict();
+        result["reader"] = py::dict();
+        result["outbound"] = py::dict();
+        result["lanes"] = py::dict();
+        result["reach_cache"] = py::dict();
     }
 
     return result;
@@ -1443,9 +1504,6 @@ static py::dict buildBlockEntityDict(const BlockEntityData& be, bool includeItem
 
 py::object PythonAPI::getBlock(double x, double y, double z, bool useDisk, const std::string &dimension, const std::string &bot)
 {
-    if (!dimension.empty() && !useDisk)
-        throw std::invalid_argument("dimension parameter requires use_disk=True (chunk data in memory has no dimension key)");
-
     QString botName = resolveBotName(bot);
     BotInstance *botInstance = ensureBotOnline(botName);
 
@@ -1455,17 +1513,22 @@ py::object PythonAPI::getBlock(double x, double y, double z, bool useDisk, const
 
     QString dim = dimension.empty() ? botInstance->dimension : QString::fromStdString(dimension);
 
-    // Read from memory only when querying the current dimension (chunks carry no dimension key)
-    if (dim == botInstance->dimension) {
-        std::optional<QString> blockOpt;
-        {
-            QReadLocker locker(botInstance->worldDataLock.get());
-            blockOpt = botInstance->worldData.getBlock(ix, iy, iz);
-        }
-        if (blockOpt.has_value()) {
-            return py::str(blockOpt.value().toStdString());
+    // Loaded chunks come from the lock-free snapshot and only hold the current dimension;
+    // retained ones may be from any
+    std::optional<QString> blockOpt;
+    const std::shared_ptr<const WorldSnapshot> world = botInstance->worldData.snapshot();
+    if (dim == world->dimension) {
+        blockOpt = world->getBlock(ix, iy, iz);
+    }
+    if (!blockOpt) {
+        QReadLocker locker(botInstance->worldDataLock.get());
+        if (const ChunkData *retained = botInstance->worldData.getRetainedChunk(dim, ix >> 4, iz >> 4)) {
+            blockOpt = retained->getBlock(ix & 15, iy, iz & 15);
         }
     }
+    if (blockOpt.has_value()) {
+        return py::str(blockOpt.value().toStdString());
+    }
 
     if (!useDisk || !botInstance->worldAutoSaver) {
         return py::none();
@@ -1480,7 +1543,7 @@ py::object PythonAPI::getBlock(double x, double y, double z, bool useDisk, const
 
     if (!chunkNbt.has_key("sections")) return py::none();
 
-    ChunkData chunkData = NBTSerializer::nbtToChunk(chunkNbt);
+    ChunkData chunkData = NBTSerializer::nbtToChunk(chunkNbt, botInstance->blockRegistry);
     auto block = chunkData.getBlock(ix & 15, iy, iz & 15);
     if (block.has_value()) {
         return py::str(block.value().toStdString());
@@ -1490,9 +1553,6 @@ py::object PythonAPI::getBlock(double x, double y, double z, bool useDisk, const
 
 py::object PythonAPI::getLight(double x, double y, double z, bool useDisk, const std::string &dimension, const std::string &bot)
 {
-    if (!dimension.empty() && !useDisk)
-        throw std::invalid_argument("dimension parameter requires use_disk=True (chunk data in memory has no dimension key)");
-
     QString botName = resolveBotName(bot);
     BotInstance *botInstance = ensureBotOnline(botName);
 
@@ -1502,20 +1562,25 @@ py::object PythonAPI::getLight(double x, double y, double z, bool useDisk, const
 
     QString dim = dimension.empty() ? botInstance->dimension : QString::fromStdString(dimension);
 
-    // Read from memory only when querying the current dimension (chunks carry no dimension key)
-    if (dim == botInstance->dimension) {
-        std::optional<ChunkSection::LightLevels> light;
-        {
-            QReadLocker locker(botInstance->worldDataLock.get());
-            light = botInstance->worldData.getLight(ix, iy, iz);
-        }
-        if (light.has_value()) {
-            py::dict result;
-            result["block"] = light->block;
-            result["sky"] = light->sky;
-            return result;
+    // Loaded chunks come from the lock-free snapshot and only hold the current dimension;
+    // retained ones may be from any
+    std::optional<ChunkSection::LightLevels> light;
+    const std::shared_ptr<const WorldSnapshot> world = botInstance->worldData.snapshot();
+    if (dim == world->dimension) {
+        light = world->getLight(ix, iy, iz);
+    }
+    if (!light) {
+        QReadLocker locker(botInstance->worldDataLock.get());
+        if (const ChunkData *retained = botInstance->worldData.getRetainedChunk(dim, ix >> 4, iz >> 4)) {
+            light = retained->getLight(ix & 15, iy, iz & 15);
         }
     }
+    if (light.has_value()) {
+        py::dict result;
+        result["block"] = light->block;
+        result["sky"] = light->sky;
+        return result;
+    }
 
     if (!useDisk || !botInstance->worldAutoSaver) {
         return py::none();
@@ -1530,7 +1595,7 @@ py::object PythonAPI::getLight(double x, double y, double z, bool useDisk, const
 
     if (!chunkNbt.has_key("sections")) return py::none();
 
-    ChunkData chunkData = NBTSerializer::nbtToChunk(chunkNbt);
+    ChunkData chunkData = NBTSerializer::nbtToChunk(chunkNbt, botInstance->blockRegistry);
     auto levels = chunkData.getLight(ix & 15, iy, iz & 15);
     py::dict result;
     result["block"] = levels.block;
@@ -1671,105 +1736,68 @@ py::object PythonAPI::isBlockSolid(const std::string &blockState, BlockRegistry:
     return py::bool_(botInstance->blockRegistry->isFaceSolid(stateId.value(), face));
 }
 
+// Loaded chunks within radius of center from the world snapshot, plus retained ones of
+// `dimension` if asked (under one read lock). The copies share their sections with the
+// world, so this is cheap and the search can run on them without the lock.
+static QVector<ChunkData> snapshotChunks(BotInstance *botInstance, const QString &dimension,
+                                         const QVector3D &center, int radius, bool includeRetained)
+{
+    int minChunkX = static_cast<int>(qFloor((center.x() - radius) / 16.0));
+    int maxChunkX = static_cast<int>(qFloor((center.x() + radius) / 16.0));
+    int minChunkZ = static_cast<int>(qFloor((center.z() - radius) / 16.0));
+    int maxChunkZ = static_cast<int>(qFloor((center.z() + radius) / 16.0));
+
+    const std::shared_ptr<const WorldSnapshot> world = botInstance->worldData.snapshot();
+    const bool loadedMatches = world->dimension == dimension;
+    QVector<ChunkData> chunks;
+    QVector<ChunkPos> missing;
+    for (int cx = minChunkX; cx <= maxChunkX; ++cx) {
+        for (int cz = minChunkZ; cz <= maxChunkZ; ++cz) {
+            const ChunkData* chunk = loadedMatches ? world->chunk(cx, cz) : nullptr;
+            if (chunk) {
+                chunks.append(*chunk);
+            } else if (includeRetained) {
+                missing.append(ChunkPos(cx, cz));
+            }
+        }
+    }
+
+    if (!missing.isEmpty()) {
+        QReadLocker locker(botInstance->worldDataLock.get());
+        for (const ChunkPos &pos : std::as_const(missing)) {
+            if (const ChunkData* chunk = botInstance->worldData.getRetainedChunk(dimension, pos.x, pos.z)) {
+                chunks.append(*chunk);
+            }
+        }
+    }
+    return chunks;
+}
+
 py::list PythonAPI::findBlocks(const std::string &blockType, double centerX, double centerY, double centerZ,
                                 int radius,
                                 int minBlockLight, int maxBlockLight,
                                 int minSkyLight, int maxSkyLight,
+                                bool includeRetained,
                                 const std::string &bot)
 {
     QString botName = resolveBotName(bot);
     BotInstance *botInstance = ensureBotOnline(botName);
+    const QString dimension = botInstance->dimension;
 
     QVector3D center(centerX, centerY, centerZ);
     QString blockTypeQ = QString::fromStdString(blockType);
 
-    // Extract search ID once (part before '[' for block states)
+    // Matches by block id: properties in the query are ignored
     QString searchId = blockTypeQ.contains('[') ? blockTypeQ.left(blockTypeQ.indexOf('[')) : blockTypeQ;
+    const ChunkSection::LightRange light{minBlockLight, maxBlockLight, minSkyLight, maxSkyLight};
 
     QVector<QVector3D> results;
 
     // Release GIL for the entire search operation to avoid blocking main thread
     {
         py::gil_scoped_release release;
-
-        // Calculate chunk bounds
-        int minChunkX = static_cast<int>(qFloor((centerX - radius) / 16.0));
-        int maxChunkX = static_cast<int>(qFloor((centerX + radius) / 16.0));
-        int minChunkZ = static_cast<int>(qFloor((centerZ - radius) / 16.0));
-        int maxChunkZ = static_cast<int>(qFloor((centerZ + radius) / 16.0));
-
-        // Get list of chunks to search (brief lock)
-        QVector<ChunkPos> chunksToSearch;
-        {
-            QReadLocker locker(botInstance->worldDataLock.get());
-            for (int cx = minChunkX; cx <= maxChunkX; ++cx) {
-                for (int cz = minChunkZ; cz <= maxChunkZ; ++cz) {
-                    if (botInstance->worldData.isChunkLoaded(cx, cz)) {
-                        chunksToSearch.append(ChunkPos{cx, cz});
-                    }
-                }
-            }
-        }
-
-    // Now search each chunk with fine-grained locking
-    for (const ChunkPos &chunkPos : chunksToSearch) {
-        // Copy chunk data under lock
-        ChunkData chunkCopy;
-        {
-            QReadLocker locker(botInstance->worldDataLock.get());
-            const ChunkData* chunk = botInstance->worldData.getChunk(chunkPos.x, chunkPos.z);
-            if (chunk) {
-                chunkCopy = *chunk;
-            } else {
-                continue;  // Chunk unloaded between checks
-            }
-        }
-        // Lock released - now search the copy without holding lock
-
-        // Search this chunk
-        int minY = qMax(static_cast<int>(centerY - radius), -64);
-        int maxY = qMin(static_cast<int>(centerY + radius), 320);
-        double radiusSq = static_cast<double>(radius) * radius;
-
-        for (int x = 0; x < 16; ++x) {
-            int worldX = chunkPos.x * 16 + x;
-            double dx = worldX - centerX;
-            double dxSq = dx * dx;
-
-            for (int z = 0; z < 16; ++z) {
-                int worldZ = chunkPos.z * 16 + z;
-                double dz = worldZ - centerZ;
-                double dzSq = dz * dz;
-                double horizDistSq = dxSq + dzSq;
-
-                if (horizDistSq > radiusSq) continue;
-
-                for (int y = minY; y <= maxY; ++y) {
-                    double dy = y - centerY;
-                    double distSq = horizDistSq + dy*dy;
-
-                    if (distSq > radiusSq) continue;
-
-                    auto block = chunkCopy.getBlock(x, y, z);
-                    if (block) {
-                        // Extract block ID (part before '[' for block states)
-                        QString blockId = block->contains('[') ? block->left(block->indexOf('[')) : *block;
-                        if (blockId == searchId) {
-                            if (minBlockLight == 0 && maxBlockLight == 15 && minSkyLight == 0 && maxSkyLight == 15) {
-                                results.append(QVector3D(worldX, y, worldZ));
-                            } else {
-                                auto light = chunkCopy.getLight(x, y, z);
-                                if (light.block >= minBlockLight && light.block <= maxBlockLight &&
-                                    light.sky   >= minSkyLight   && light.sky   <= maxSkyLight) {
-                                    results.append(QVector3D(worldX, y, worldZ));
-                                }
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+        QVector<ChunkData> chunks = snapshotChunks(botInstance, dimension, center, radius, includeRetained);
+        results = BotWorldData::searchBlocks(chunks, QStringList{searchId}, center, radius, light);
     } // Release GIL scope ends - reacquire for Python object creation
 
     py::list positions;
@@ -1781,18 +1809,17 @@ py::list PythonAPI::findBlocks(const std::string &blockType, double centerX, dou
     return positions;
 }
 
-py::object PythonAPI::findNearestBlock(const py::list &blockTypes, int maxDistance, const std::string &bot)
+py::object PythonAPI::findNearestBlock(const py::list &blockTypes, int maxDistance, bool includeRetained,
+                                       const std::string &bot)
 {
     QString botName = resolveBotName(bot);
     BotInstance *botInstance = ensureBotOnline(botName);
+    const QString dimension = botInstance->dimension;
 
-    // Convert Python list to QStringList and extract block IDs
-    QStringList types;
+    // Convert Python list to block ids: properties in the query are ignored
     QStringList searchIds;
     for (const auto &item : blockTypes) {
         QString type = QString::fromStdString(item.cast<std::string>());
-        types.append(type);
-        // Extract ID (part before '[' for block states)
         searchIds.append(type.contains('[') ? type.left(type.indexOf('[')) : type);
     }
 
@@ -1809,81 +1836,8 @@ py::object PythonAPI::findNearestBlock(const py::list &blockTypes, int maxDistan
             start = botInstance->position;
         }
 
-    // Calculate chunk bounds
-    int minChunkX = static_cast<int>(qFloor((start.x() - maxDistance) / 16.0));
-    int maxChunkX = static_cast<int>(qFloor((start.x() + maxDistance) / 16.0));
-    int minChunkZ = static_cast<int>(qFloor((start.z() - maxDistance) / 16.0));
-    int maxChunkZ = static_cast<int>(qFloor((start.z() + maxDistance) / 16.0));
-
-    // Get list of chunks to search (brief lock)
-    QVector<ChunkPos> chunksToSearch;
-    {
-        QReadLocker locker(botInstance->worldDataLock.get());
-        for (int cx = minChunkX; cx <= maxChunkX; ++cx) {
-            for (int cz = minChunkZ; cz <= maxChunkZ; ++cz) {
-                if (botInstance->worldData.isChunkLoaded(cx, cz)) {
-                    chunksToSearch.append(ChunkPos{cx, cz});
-                }
-            }
-        }
-    }
-
-    // Search each chunk with fine-grained locking
-    double nearestDistSq = static_cast<double>(maxDistance) * maxDistance;
-
-    for (const ChunkPos &chunkPos : chunksToSearch) {
-        // Copy chunk data under lock
-        ChunkData chunkCopy;
-        {
-            QReadLocker locker(botInstance->worldDataLock.get());
-            const ChunkData* chunk = botInstance->worldData.getChunk(chunkPos.x, chunkPos.z);
-            if (chunk) {
-                chunkCopy = *chunk;
-            } else {
-                continue;
-            }
-        }
-        // Lock released
-
-        // Search this chunk
-        int minY = qMax(static_cast<int>(start.y() - maxDistance), -64);
-        int maxY = qMin(static_cast<int>(start.y() + maxDistance), 320);
-
-        for (int x = 0; x < 16; ++x) {
-            int worldX = chunkPos.x * 16 + x;
-            double dx = worldX - start.x();
-            double dxSq = dx * dx;
-
-            for (int z = 0; z < 16; ++z) {
-                int worldZ = chunkPos.z * 16 + z;
-                double dz = worldZ - start.z();
-                double dzSq = dz * dz;
-                double horizDistSq = dxSq + dzSq;
-
-                if (horizDistSq >= nearestDistSq) continue;
-
-                for (int y = minY; y <= maxY; ++y) {
-                    double dy = y - start.y();
-                    double distSq = horizDistSq + dy*dy;
-
-                    if (distSq >= nearestDistSq) continue;
-
-                    auto block = chunkCopy.getBlock(x, y, z);
-                    if (block) {
-                        // Extract block ID (part before '[' for block states)
-                        QString blockId = block->contains('[') ? block->left(block->indexOf('[')) : *block;
-                        for (const QString& searchId : searchIds) {
-                            if (blockId == searchId) {
-                                nearest = QVector3D(worldX, y, worldZ);
-                                nearestDistSq = distSq;
-                                break;
-                            }
-                        }
-                    }
-                }
-            }
-        }
-    }
+        QVector<ChunkData> chunks = snapshotChunks(botInstance, dimension, start, maxDistance, includeRetained);
+        nearest = BotWorldData::searchNearestBlock(chunks, searchIds, start, maxDistance);
     } // Release GIL scope ends - reacquire for Python object creation
 
     if (nearest.has_value()) {
@@ -1898,8 +1852,7 @@ int PythonAPI::getLoadedChunkCount(const std::string &bot)
     QString botName = resolveBotName(bot);
     BotInstance *botInstance = ensureBotOnline(botName);
 
-    QReadLocker locker(botInstance->worldDataLock.get());
-    return botInstance->worldData.chunkCount();
+    return botInstance->worldData.snapshot()->chunkCount;
 }
 
 size_t PythonAPI::getWorldMemoryUsage(const std::string &bot)
@@ -1916,21 +1869,45 @@ py::list PythonAPI::getLoadedChunks(const std::string &bot)
     QString botName = resolveBotName(bot);
     BotInstance *botInstance = ensureBotOnline(botName);
 
+    const QVector<ChunkPos> chunks = botInstance->worldData.snapshot()->chunkPositions();
+
+    py::list chunkList;
+    for (const ChunkPos &pos : std::as_const(chunks)) {
+        py::tuple coord = py::make_tuple(pos.x, pos.z);
+        chunkList.append(coord);
+    }
+
+    return chunkList;
+}
+
+py::list PythonAPI::getRetainedChunks(const std::string &dimension, const std::string &bot)
+{
+    QString botName = resolveBotName(bot);
+    BotInstance *botInstance = ensureBotOnline(botName);
+    QString dim = dimension.empty() ? botInstance->dimension : QString::fromStdString(dimension);
+
     QVector<ChunkPos> chunks;
     {
         QReadLocker locker(botInstance->worldDataLock.get());
-        chunks = botInstance->worldData.getLoadedChunks();
+        chunks = botInstance->worldData.getRetainedChunks(dim);
     }
 
     py::list chunkList;
     for (const ChunkPos &pos : std::as_const(chunks)) {
-        py::tuple coord = py::make_tuple(pos.x, pos.z);
-        chunkList.append(coord);
+        chunkList.append(py::make_tuple(pos.x, pos.z));
     }
-
     return chunkList;
 }
 
+size_t PythonAPI::getRetainedMemoryUsage(const std::string &bot)
+{
+    QString botName = resolveBotName(bot);
+    BotInstance *botInstance = ensureBotOnline(botName);
+
+    QReadLocker locker(botInstance->worldDataLock.get());
+    return botInstance->worldData.retainedMemoryUsage();
+}
+
 static py::dict buildEntityDict(const EntityData &e)
 {
     py::dict d;
@@ -1963,7 +1940,7 @@ py::list PythonAPI::getEntities(const std::string &bot)
     QString botName = resolveBotName(bot);
     BotInstance *botInstance = ensureBotOnline(botName);
 
-    QVector<EntityData> ents;
+    QHash<int, EntityData> ents;
     {
         QReadLocker locker(botInstance->worldDataLock.get());
         ents = botInstance->worldData.getAllEntities();
@@ -2033,7 +2010,234 @@ bool PythonAPI::getHoldAttack(const std::string &botName)
 {
     QString name = resolveBotName(botName);
     ensureBotOnline(name);
-    return BotManager::getHoldAttackStatus(name);
+
+    bool result;
+    {
+        py::gil_scoped_release release;
+        result = BotManager::getHoldAttackStatus(name);
+    }
+    return result;
+}
+
+PyPendingReply PythonAPI::canReachBlockAsync(int x, int y, int z, bool sneak, BlockFace face, const std::string &bot)
+{
+    QString botName = resolveBotName(bot);
+    ensureBotOnline(botName);
+    return {BotManager::requestCanReachBlock(botName, x, y, z, sneak, 3000, static_cast<int>(face))};
+}
+
+PyPendingReply PythonAPI::canReachBlockFromAsync(int fromX, int fromY, int fromZ, int x, int y, int z, bool sneak, BlockFace face, const std::string &bot)
+{
+    QString botName = resolveBotName(bot);
+    ensureBotOnline(botName);
+    return {BotManager::requestCanReachBlockFrom(botName, fromX, fromY, fromZ, x, y, z, sneak, 3000, static_cast<int>(face))};
+}
+
+// (x, y, z) sequences -> block positions, rejecting anything the client wouldn't accept
+static QVector<Vec3i> toBlockPositions(const py::list &positions)
+{
+    if (positions.size() > static_cast<size_t>(BotManager::kMaxReachBatch)) {
+        throw py::value_error("At most " + std::to_string(BotManager::kMaxReachBatch) + " positions per call");
+    }
+
+    QVector<Vec3i> result;
+    result.reserve(static_cast<int>(positions.size()));
+    for (const auto &item : positions) {
+        auto pos = py::cast<std::tuple<int, int, int>>(item);
+        result.append({std::get<0>(pos), std::get<1>(pos), std::get<2>(pos)});
+    }
+    return result;
+}
+
+static std::optional<Vec3i> toOptionalBlockPos(const std::optional<std::tuple<int, int, int>> &pos)
+{
+    if (!pos) {
+        return std::nullopt;
+    }
+    return Vec3i{std::get<0>(*pos), std::get<1>(*pos), std::get<2>(*pos)};
+}
+
+py::list PythonAPI::canReachBlocks(const py::list &positions, bool sneak, BlockFace face,
+                                   std::optional<std::tuple<int, int, int>> fromPos, const std::string &bot)
+{
+    PyPendingReply pending = canReachBlocksAsync(positions, sneak, face, fromPos, bot);
+
+    PendingReply::Status status;
+    {
+        py::gil_scoped_release release;
+        status = pending.reply.wait();
+    }
+
+    // Same contract as can_reach_block: anything that went wrong reads as unreachable
+    py::list result;
+    const QVariantList reachable = status == PendingReply::Status::Completed
+        ? pending.reply.value().toList() : QVariantList();
+    for (size_t i = 0; i < positions.size(); ++i) {
+        result.append(i < static_cast<size_t>(reachable.size()) && reachable[static_cast<int>(i)].toBool());
+    }
+    return result;
+}
+
+PyPendingReply PythonAPI::canReachBlocksAsync(const py::list &positions, bool sneak, BlockFace face,
+                                              std::optional<std::tuple<int, int, int>> fromPos, const std::string &bot)
+{
+    QString botName = resolveBotName(bot);
+    ensureBotOnline(botName);
+    return {BotManager::requestCanReachBlocks(botName, toBlockPositions(positions), sneak,
+                                              toOptionalBlockPos(fromPos), static_cast<int>(face))};
+}
+
+PyPendingReply PythonAPI::getHoldAttackAsync(const std::string &botName)
+{
+    QString name = resolveBotName(botName);
+    ensureBotOnline(name);
+    return {BotManager::requestHoldAttackStatus(name)};
+}
+
+// TimeoutError when the request's deadline passed, RuntimeError for cancel/disconnect/send failure
+static py::object replyFailureError(PendingReply::Status status)
+{
+    std::string message = "Request " + PendingReply::statusName(status).toStdString();
+    return py::reinterpret_borrow<py::object>(
+        status == PendingReply::Status::TimedOut ? PyExc_TimeoutError : PyExc_RuntimeError)(message);
+}
+
+[[noreturn]] static void raiseReplyFailure(PendingReply::Status status)
+{
+    std::string message = "Request " + PendingReply::statusName(status).toStdString();
+    PyErr_SetString(status == PendingReply::Status::TimedOut ? PyExc_TimeoutError : PyExc_RuntimeError,
+                    message.c_str());
+    throw py::error_already_set();
+}
+
+// An awaited reply: resolve() settles the asyncio future from the loop's thread.
+// Only touched with the GIL held.
+struct ReplyAwait {
+    py::object loop;
+    py::object resolve;
+    py::object timer;  // loop.call_later handle for the request's deadline, or None
+};
+
+// Never freed, so no Python object is released after the interpreter shuts down
+static QHash<quint64, ReplyAwait> &replyAwaits()
+{
+    static auto *awaits = new QHash<quint64, ReplyAwait>();
+    return *awaits;
+}
+
+// Replies settle on the network or GUI thread, which must not wait for the GIL (a script
+// may hold it while waiting on that thread), so the hand-off to the event loop runs here
+static QThreadPool &replyWakeupPool()
+{
+    static QThreadPool *pool = [] {
+        auto *p = new QThreadPool();
+        p->setMaxThreadCount(1);
+        return p;
+    }();
+    return *pool;
+}
+
+static void wakeReplyAwait(quint64 id)
+{
+    replyWakeupPool().start([id]() {
+        if (!Py_IsInitialized()) return;
+        py::gil_scoped_acquire acquire;
+        auto it = replyAwaits().constFind(id);
+        if (it == replyAwaits().constEnd()) return;
+        const ReplyAwait await = it.value();
+        try {
+            await.loop.attr("call_soon_threadsafe")(await.resolve);
+        } catch (py::error_already_set &) {
+            replyAwaits().remove(id);  // The loop was closed
+        }
+    });
+}
+
+py::object PythonAPI::pendingReplyResult(const PyPendingReply &pending, std::optional<double> timeout)
+{
+    int timeoutMs = timeout ? static_cast<int>(std::max(0.0, *timeout) * 1000) : -1;
+
+    PendingReply::Status status;
+    {
+        py::gil_scoped_release release;
+        status = pending.reply.wait(timeoutMs);
+    }
+
+    if (status == PendingReply::Status::Pending) {
+        // Only the caller's timeout ran out; the request itself is still live
+        PyErr_SetString(PyExc_TimeoutError, "No response yet");
+        throw py::error_already_set();
+    }
+    if (status != PendingReply::Status::Completed) {
+        raiseReplyFailure(status);
+    }
+    return qVariantToPyObject(pending.reply.value());
+}
+
+bool PythonAPI::pendingReplyDone(const PyPendingReply &pending)
+{
+    return pending.reply.isDone();
+}
+
+std::string PythonAPI::pendingReplyStatus(const PyPendingReply &pending)
+{
+    return PendingReply::statusName(pending.reply.status()).toStdString();
+}
+
+void PythonAPI::pendingReplyCancel(const PyPendingReply &pending)
+{
+    pending.reply.cancel();
+}
+
+py::object PythonAPI::pendingReplyAwait(const PyPendingReply &pending)
+{
+    static quint64 nextAwaitId = 0;  // Guarded by the GIL
+
+    const PendingReply reply = pending.reply;
+    const quint64 id = ++nextAwaitId;
+    py::object loop = py::module_::import("asyncio").attr("get_running_loop")();
+    py::object future = loop.attr("create_future")();
+
+    // Runs on the loop's thread when the reply settles or its deadline passes
+    py::object resolve = py::cpp_function([reply, id, future]() {
+        auto it = replyAwaits().find(id);
+        if (it == replyAwaits().end()) return;
+        const PendingReply::Status status = reply.status();
+        if (status == PendingReply::Status::Pending) return;  // Deadline timer fired a little early
+
+        const py::object timer = it->timer;
+        const py::object target = future;
+        replyAwaits().erase(it);
+        if (!timer.is_none()) timer.attr("cancel")();
+        if (target.attr("done")().cast<bool>()) return;
+        if (status == PendingReply::Status::Completed) {
+            target.attr("set_result")(qVariantToPyObject(reply.value()));
+        } else {
+            target.attr("set_exception")(replyFailureError(status));
+        }
+    });
+
+    // Cancelling the awaiting task cancels the future, and with it the request
+    future.attr("add_done_callback")(py::cpp_function([reply, id](py::object done) {
+        if (!done.attr("cancelled")().cast<bool>()) return;
+        auto it = replyAwaits().find(id);
+        if (it != replyAwaits().end()) {
+            const py::object timer = it->timer;
+            replyAwaits().erase(it);
+            if (!timer.is_none()) timer.attr("cancel")();
+        }
+        reply.cancel();
+    }));
+
+    ReplyAwait await{loop, resolve, py::none()};
+    const QDeadlineTimer deadline = reply.deadline();
+    if (!deadline.isForever()) {
+        await.timer = loop.attr("call_later")((deadline.remainingTime() + 1) / 1000.0, resolve);
+    }
+    replyAwaits().insert(id, await);
+    reply.onSettled([id]() { wakeReplyAwait(id); });
+
+    return future.attr("__await__")();
 }
 
 void PythonAPI::lookAt(double x, double y, double z, BlockFace face, bool sneak, const std::string &botName)
@@ -7,7 +7,9 @@
 #include <vector>
 #include <map>
 #include <optional>
+#include <tuple>
 #include "world/BlockRegistry.h"
+#include "network/PendingRequests.h"
 
 #undef slots
 #include <pybind11/pybind11.h>
@@ -76,6 +78,12 @@ struct PyTabListPlayer {
     std::string display_name;
 };
 
+// A request the client hasn't necessarily answered yet. result() blocks;
+// awaiting it inside a coroutine yields to the event loop instead.
+struct PyPendingReply {
+    PendingReply reply;
+};
+
 class PythonAPI
 {
 public:
@@ -230,11 +238,15 @@ public:
                                 int radius,
                                 int minBlockLight = 0, int maxBlockLight = 15,
                                 int minSkyLight = 0, int maxSkyLight = 15,
+                                bool includeRetained = false,
                                 const std::string &bot = "");
-    static py::object findNearestBlock(const py::list &blockTypes, int maxDistance, const std::string &bot = "");
+    static py::object findNearestBlock(const py::list &blockTypes, int maxDistance, bool includeRetained = false,
+                                       const std::string &bot = "");
     static int getLoadedChunkCount(const std::string &bot = "");
     static size_t getWorldMemoryUsage(const std::string &bot = "");
     static py::list getLoadedChunks(const std::string &bot = "");
+    static py::list getRetainedChunks(const std::string &dimension = "", const std::string &bot = "");
+    static size_t getRetainedMemoryUsage(const std::string &bot = "");
 
     // World interaction
     static void holdAttack(bool enabled, int durationTicks = 0, const std::string &botName = "");
@@ -242,6 +254,13 @@ public:
     static void lookAt(double x, double y, double z, BlockFace face = BlockFace::AUTO, bool sneak = false, const std::string &botName = "");
     static bool canReachBlock(int x, int y, int z, bool sneak = false, BlockFace face = BlockFace::AUTO, const std::string &bot = "");
     static bool canReachBlockFrom(int fromX, int fromY, int fromZ, int x, int y, int z, bool sneak = false, BlockFace face = BlockFace::AUTO, const std::string &bot = "");
+    static PyPendingReply canReachBlockAsync(int x, int y, int z, bool sneak = false, BlockFace face = BlockFace::AUTO, const std::string &bot = "");
+    static py::list canReachBlocks(const py::list &positions, bool sneak = false, BlockFace face = BlockFace::AUTO,
+                                   std::optional<std::tuple<int, int, int>> fromPos = std::nullopt, const std::string &bot = "");
+    static PyPendingReply canReachBlocksAsync(const py::list &positions, bool sneak = false, BlockFace face = BlockFace::AUTO,
+                                              std::optional<std::tuple<int, int, int>> fromPos = std::nullopt, const std::string &bot = "");
+    static PyPendingReply canReachBlockFromAsync(int fromX, int fromY, int fromZ, int x, int y, int z, bool sneak = false, BlockFace face = BlockFace::AUTO, const std::string &bot = "");
+    static PyPendingReply getHoldAttackAsync(const std::string &botName = "");
     static void interactBlock(double x, double y, double z, bool sneak = false, bool lookAtBlock = true, BlockFace face = BlockFace::AUTO, const std::string &bot = "");
 
     // Container interaction
@@ -269,6 +288,13 @@ public:
     static void log(const std::string &message);
     static void error(const std::string &message);
 
+    // PendingReply methods
+    static py::object pendingReplyResult(const PyPendingReply &pending, std::optional<double> timeout);
+    static bool pendingReplyDone(const PyPendingReply &pending);
+    static std::string pendingReplyStatus(const PyPendingReply &pending);
+    static void pendingReplyCancel(const PyPendingReply &pending);
+    static py::object pendingReplyAwait(const PyPendingReply &pending);
+
     static py::object qVariantToPyObject(const QVariant &value);
 
 private:
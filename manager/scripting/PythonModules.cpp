@@ -316,16 +316,16 @@ PYBIND11_EMBEDDED_MODULE(world, m) {
               py::arg("bot_name") = "");
     def_query("get_block", &PythonAPI::getBlock,
               "Get block state at position. Returns block ID string or None if not found. "
-              "If use_disk=True, reads saved world data when chunk not loaded. "
-              "dimension requires use_disk=True.",
+              "Falls back to chunks retained after unloading, then (if use_disk=True) to saved world data. "
+              "dimension defaults to the bot's current one.",
               py::arg("x"), py::arg("y"), py::arg("z"),
               py::arg("use_disk") = false,
               py::arg("dimension") = "",
               py::arg("bot_name") = "");
     def_query("get_light", &PythonAPI::getLight,
               "Get light levels at position as dict with block (0-15) and sky (0-15). Returns None if not found. "
-              "If use_disk=True, reads saved world data when chunk not loaded. "
-              "dimension requires use_disk=True.",
+              "Falls back to chunks retained after unloading, then (if use_disk=True) to saved world data. "
+              "dimension defaults to the bot's current one.",
               py::arg("x"), py::arg("y"), py::arg("z"),
               py::arg("use_disk") = false,
               py::arg("dimension") = "",
@@ -353,11 +353,14 @@ PYBIND11_EMBEDDED_MODULE(world, m) {
               py::arg("bot_name") = "");
     def_query("find_blocks", &PythonAPI::findBlocks,
               "Find all blocks of type within radius of center, returns list of (x,y,z) tuples. "
-              "Optionally filter by block/sky light range (0-15).",
+              "The type may use * wildcards (e.g. 'minecraft:*_ore'). "
+              "Optionally filter by block/sky light range (0-15). "
+              "include_retained also searches chunks retained after unloading.",
               py::arg("block_type"), py::arg("center_x"), py::arg("center_y"), py::arg("center_z"),
               py::arg("radius"),
               py::arg("min_block_light") = 0, py::arg("max_block_light") = 15,
               py::arg("min_sky_light") = 0, py::arg("max_sky_light") = 15,
+              py::arg("include_retained") = false,
               py::arg("bot_name") = "");
     def_state("entities", &PythonAPI::getEntities,
               "Get all tracked entities as list of dicts",
@@ -369,8 +372,11 @@ PYBIND11_EMBEDDED_MODULE(world, m) {
               py::arg("type") = "",
               py::arg("bot_name") = "");
     def_query("find_nearest", &PythonAPI::findNearestBlock,
-              "Find nearest block matching any type in list, returns (x,y,z) tuple or None",
+              "Find nearest block matching any type in list, returns (x,y,z) tuple or None. "
+              "Types may use * wildcards. "
+              "include_retained also searches chunks retained after unloading.",
               py::arg("block_types"), py::arg("max_distance") = 128,
+              py::arg("include_retained") = false,
               py::arg("bot_name") = "");
     def_state("loaded_chunk_count", &PythonAPI::getLoadedChunkCount,
               "Get number of loaded chunks",
@@ -381,6 +387,26 @@ PYBIND11_EMBEDDED_MODULE(world, m) {
     def_state("loaded_chunks", &PythonAPI::getLoadedChunks,
               "Get list of loaded chunk positions as (x,z) tuples",
               py::arg("bot_name") = "");
+    def_state("retained_chunks", &PythonAPI::getRetainedChunks,
+              "Get list of chunks kept in memory after unloading as (x,z) tuples, for dimension (default: current)",
+              py::arg("dimension") = "",
+              py::arg("bot_name") = "");
+    def_state("retained_memory_usage", &PythonAPI::getRetainedMemoryUsage,
+              "Get memory used by chunks kept after unloading, in bytes",
+              py::arg("bot_name") = "");
+
+    // Handle for a request the client answers later
+    py::class_<PyPendingReply>(m, "PendingReply")
+        .def("result", &PythonAPI::pendingReplyResult,
+             "Block until the response arrives and return it. Raises TimeoutError if the request "
+             "(or the optional timeout, in seconds) runs out, RuntimeError if it was cancelled or the bot disconnected.",
+             py::arg("timeout") = py::none())
+        .def("done", &PythonAPI::pendingReplyDone,
+             "True once the request has a response or has failed")
+        .def_property_readonly("status", &PythonAPI::pendingReplyStatus)
+        .def("cancel", &PythonAPI::pendingReplyCancel,
+             "Stop waiting for the response; a late answer is discarded")
+        .def("__await__", &PythonAPI::pendingReplyAwait);
 
     // World interaction
     def_action("hold_attack", &PythonAPI::holdAttack,
@@ -392,6 +418,9 @@ PYBIND11_EMBEDDED_MODULE(world, m) {
                "Query the current hold-attack state from the client. Returns True if attack is "
                "currently being held, False otherwise. Blocks until the client responds.",
                py::arg("bot_name") = "");
+    def_action("get_hold_attack_async", &PythonAPI::getHoldAttackAsync,
+               "Like get_hold_attack, but returns a PendingReply immediately instead of blocking.",
+               py::arg("bot_name") = "");
 
     py::enum_<PythonAPI::BlockFace>(m, "BlockFace")
         .value("AUTO",  PythonAPI::BlockFace::AUTO)
@@ -425,6 +454,34 @@ PYBIND11_EMBEDDED_MODULE(world, m) {
               py::arg("sneak") = false,
               py::arg("face") = PythonAPI::BlockFace::AUTO,
               py::arg("bot_name") = "");
+    def_query("can_reach_block_async", &PythonAPI::canReachBlockAsync,
+              "Like can_reach_block, but returns a PendingReply immediately so many checks can be in flight at once.",
+              py::arg("x"), py::arg("y"), py::arg("z"),
+              py::arg("sneak") = false,
+              py::arg("face") = PythonAPI::BlockFace::AUTO,
+              py::arg("bot_name") = "");
+    def_query("can_reach_blocks", &PythonAPI::canReachBlocks,
+              "Check many blocks in one round trip. positions is a list of (x, y, z); returns a list of bools "
+              "in the same order. from_pos=(x, y, z) checks from a hypothetical standing position instead.",
+              py::arg("positions"),
+              py::arg("sneak") = false,
+              py::arg("face") = PythonAPI::BlockFace::AUTO,
+              py::arg("from_pos") = py::none(),
+              py::arg("bot_name") = "");
+    def_query("can_reach_blocks_async", &PythonAPI::canReachBlocksAsync,
+              "Like can_reach_blocks, but returns a PendingReply whose result is the list of bools.",
+              py::arg("positions"),
+              py::arg("sneak") = false,
+              py::arg("face") = PythonAPI::BlockFace::AUTO,
+              py::arg("from_pos") = py::none(),
+              py::arg("bot_name") = "");
+    def_query("can_reach_block_from_async", &PythonAPI::canReachBlockFromAsync,
+              "Like can_reach_block_from, but returns a PendingReply immediately.",
+              py::arg("from_x"), py::arg("from_y"), py::arg("from_z"),
+              py::arg("x"), py::arg("y"), py::arg("z"),
+              py::arg("sneak") = false,
+              py::arg("face") = PythonAPI::BlockFace::AUTO,
+              py::arg("bot_name") = "");
     def_action("interact_block", &PythonAPI::interactBlock,
                "Right-click/interact with block at position",
                py::arg("x"), py::arg("y"), py::arg("z"),
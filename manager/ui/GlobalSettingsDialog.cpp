@@ -246,6 +246,21 @@ void GlobalSettingsDialog::setupUI()
         crashLayout->addRow("Time window:", crashWindowMinutesSpinBox);
 
         layout->addWidget(crashGroup);
+
+        QGroupBox *worldGroup = new QGroupBox("World Data");
+        QFormLayout *worldLayout = new QFormLayout(worldGroup);
+
+        retainedChunksSpinBox = new QSpinBox(this);
+        retainedChunksSpinBox->setRange(0, 1048576);
+        retainedChunksSpinBox->setSingleStep(64);
+        retainedChunksSpinBox->setValue(512);
+        retainedChunksSpinBox->setSuffix(" MiB");
+        retainedChunksSpinBox->setSpecialValueText("Disabled");
+        retainedChunksSpinBox->setToolTip(
+            "Memory all bots together may use for chunks they have left behind. Each bot also has its own limit.");
+        worldLayout->addRow("Chunk cache:", retainedChunksSpinBox);
+
+        layout->addWidget(worldGroup);
         layout->addStretch();
         sa->setWidget(contents);
         tabWidget->addTab(sa, "Bots");
@@ -348,6 +363,8 @@ void GlobalSettingsDialog::loadSettings()
     crashMaxCrashesSpinBox->setEnabled(crashProtection);
     crashWindowMinutesSpinBox->setEnabled(crashProtection);
 
+    retainedChunksSpinBox->setValue(settings.value("World/retainedChunksMiB", 512).toInt());
+
     int scheme = settings.value("Appearance/colorScheme", static_cast<int>(Qt::ColorScheme::Unknown)).toInt();
     for (int i = 0; i < colorSchemeComboBox->count(); ++i) {
         if (colorSchemeComboBox->itemData(i).toInt() == scheme) {
@@ -402,6 +419,8 @@ void GlobalSettingsDialog::saveSettings()
     settings.setValue("CrashRecovery/maxCrashes", crashMaxCrashesSpinBox->value());
     settings.setValue("CrashRecovery/windowMinutes", crashWindowMinutesSpinBox->value());
 
+    settings.setValue("World/retainedChunksMiB", retainedChunksSpinBox->value());
+
     int scheme = colorSchemeComboBox->currentData().toInt();
     settings.setValue("Appearance/colorScheme", scheme);
 
@@ -51,6 +51,8 @@ private:
     QSpinBox *crashMaxCrashesSpinBox;
     QSpinBox *crashWindowMinutesSpinBox;
 
+    QSpinBox *retainedChunksSpinBox;
+
     QDialogButtonBox *buttonBox;
 
     struct ColorEntry {
@@ -150,7 +150,7 @@ ManagerMainWindow::ManagerMainWindow(QWidget *parent)
                         } else if (bot->status == BotStatus::Online) {
                             LogManager::log(QString("[%1] Stopped unexpectedly").arg(botName), LogManager::Warning);
                             bot->status = BotStatus::Offline;
-                            bot->connectionId = -1;
+                            BotManager::clearConnectionId(bot);
                             bot->minecraftPid = 0;
                             updateInstancesTable();
                         }
@@ -227,6 +227,7 @@ void ManagerMainWindow::setupUI()
     connect(ui->serverLineEdit, &QLineEdit::textChanged, this, &ManagerMainWindow::onConfigurationChanged);
     connect(ui->memorySpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ManagerMainWindow::onConfigurationChanged);
     connect(ui->restartThresholdSpinBox, QOverload<double>::of(&QDoubleSpinBox::valueChanged), this, &ManagerMainWindow::onConfigurationChanged);
+    connect(ui->retainedChunksSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, &ManagerMainWindow::onConfigurationChanged);
     connect(ui->autoConnectCheckBox, &QCheckBox::toggled, this, &ManagerMainWindow::onConfigurationChanged);
     connect(ui->autoRestartCheckBox, &QCheckBox::toggled, this, &ManagerMainWindow::onConfigurationChanged);
     connect(ui->tokenRefreshCheckBox, &QCheckBox::toggled, this, &ManagerMainWindow::onConfigurationChanged);
@@ -809,6 +810,7 @@ void ManagerMainWindow::onConfigurationChanged()
             bot->server = ui->serverLineEdit->text();
             bot->maxMemory = ui->memorySpinBox->value();
             bot->restartThreshold = ui->restartThresholdSpinBox->value();
+            bot->retainedChunksMiB = ui->retainedChunksSpinBox->value();
             bot->autoConnect = ui->autoConnectCheckBox->isChecked();
             bot->autoRestart = ui->autoRestartCheckBox->isChecked();
             bot->tokenRefresh = ui->tokenRefreshCheckBox->isChecked();
@@ -866,6 +868,7 @@ void ManagerMainWindow::loadBotConfiguration(const BotInstance &bot)
     ui->pipeStatusLabel->setText(QString("Connection %1 [%2]").arg(bot.connectionId).arg(bot.status == BotStatus::Online ? "Connected" : "Not Connected"));
     ui->memorySpinBox->setValue(bot.maxMemory);
     ui->restartThresholdSpinBox->setValue(bot.restartThreshold);
+    ui->retainedChunksSpinBox->setValue(bot.retainedChunksMiB);
     ui->autoConnectCheckBox->setChecked(bot.autoConnect);
     ui->autoRestartCheckBox->setChecked(bot.autoRestart);
     ui->tokenRefreshCheckBox->setChecked(bot.tokenRefresh);
@@ -1301,6 +1304,7 @@ void ManagerMainWindow::openGlobalSettings()
         m_crashLoopProtectionEnabled = settings.value("CrashRecovery/enabled", true).toBool();
         m_crashMaxCrashes = settings.value("CrashRecovery/maxCrashes", 3).toInt();
         m_crashWindowSecs = settings.value("CrashRecovery/windowMinutes", 5).toInt() * 60;
+        BotManager::setRetainedChunkBudget(settings.value("World/retainedChunksMiB", 512).toLongLong() * 1024 * 1024);
     }
 }
 
@@ -1403,11 +1407,13 @@ void ManagerMainWindow::saveSettings()
     // Save bot instances
     settings.beginGroup("Bots");
     QVector<BotInstance*> &bots = BotManager::getBots();
-    settings.setValue("count", bots.size());
-
-    for (int i = 0; i < bots.size(); ++i) {
-        saveBotInstance(settings, *bots[i], i);
+    int savedCount = 0;
+    for (const BotInstance *bot : std::as_const(bots)) {
+        if (!bot->testBot) {
+            saveBotInstance(settings, *bot, savedCount++);
+        }
     }
+    settings.setValue("count", savedCount);
     settings.endGroup();
 
     // Save window state
@@ -1507,6 +1513,7 @@ void ManagerMainWindow::loadSettings()
     m_crashLoopProtectionEnabled = settings.value("CrashRecovery/enabled", true).toBool();
     m_crashMaxCrashes = settings.value("CrashRecovery/maxCrashes", 3).toInt();
     m_crashWindowSecs = settings.value("CrashRecovery/windowMinutes", 5).toInt() * 60;
+    BotManager::setRetainedChunkBudget(settings.value("World/retainedChunksMiB", 512).toLongLong() * 1024 * 1024);
 }
 
 void ManagerMainWindow::saveBotInstance(QSettings &settings, const BotConfig &bot, int index)
@@ -1520,6 +1527,7 @@ void ManagerMainWindow::saveBotInstance(QSettings &settings, const BotConfig &bo
     settings.setValue("server", bot.server);
     settings.setValue("maxMemory", bot.maxMemory);
     settings.setValue("restartThreshold", bot.restartThreshold);
+    settings.setValue("retainedChunksMiB", bot.retainedChunksMiB);
     settings.setValue("autoConnect", bot.autoConnect);
     settings.setValue("autoRestart", bot.autoRestart);
     settings.setValue("tokenRefresh", bot.tokenRefresh);
@@ -1553,6 +1561,7 @@ BotConfig ManagerMainWindow::loadBotInstance(QSettings &settings, int index)
     bot.server = settings.value("server", "").toString();
     bot.maxMemory = settings.value("maxMemory", 4096).toInt();
     bot.restartThreshold = settings.value("restartThreshold", 48.0).toDouble();
+    bot.retainedChunksMiB = settings.value("retainedChunksMiB", 64).toInt();
     bot.autoConnect = settings.value("autoConnect", true).toBool();
     bot.autoRestart = settings.value("autoRestart", true).toBool();
     bot.tokenRefresh = settings.value("tokenRefresh", true).toBool();
@@ -1633,7 +1642,7 @@ void ManagerMainWindow::stopAllBots()
                         LogManager::log(QString("Force killing bot '%1' (PID: %2)").arg(botName).arg(pid), LogManager::Warning);
                         PrismLauncherManager::stopBot(pid);
                         b->status = BotStatus::Offline;
-                        b->connectionId = -1;
+                        BotManager::clearConnectionId(b);
                         b->minecraftPid = 0;
                         emit BotManager::instance().botUpdated(botName);
                     }
@@ -1867,7 +1876,7 @@ void ManagerMainWindow::onClientDisconnected(int connectionId)
         QString botName = bot->name;
         bool shouldAutoRestart = bot->autoRestart && !bot->manualStop;
 
-        bot->connectionId = -1;
+        BotManager::clearConnectionId(bot);
         bot->status = BotStatus::Offline;
         bot->manualStop = false;
         updateInstancesTable();
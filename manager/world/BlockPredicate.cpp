@@ -0,0 +1,103 @@
+#include "BlockPredicate.h"
+#include "bot/WorldData.h"
+#include <QRegularExpression>
+
+namespace {
+
+// One pattern, prepared once so matching a state name does no allocation
+struct CompiledPattern {
+    QString exact;             // Matches this state, or any state of this block id if it has no properties
+    QRegularExpression regex;  // Wildcard patterns; anchored at the start only
+    bool wildcard = false;
+
+    bool matches(const QString& state) const {
+        if (wildcard) {
+            return regex.match(state).hasMatch();
+        }
+        if (state.size() == exact.size()) {
+            return state == exact;
+        }
+        return state.size() > exact.size() && state.startsWith(exact) && state.at(exact.size()) == u'[';
+    }
+};
+
+QVector<CompiledPattern> compilePatterns(const QStringList& patterns)
+{
+    QVector<CompiledPattern> compiled;
+    compiled.reserve(patterns.size());
+    for (const QString& type : patterns) {
+        CompiledPattern pattern;
+        if (type.contains('*')) {
+            QString regex = QRegularExpression::escape(type);
+            regex.replace("\\*", ".*");
+            pattern.regex = QRegularExpression("^" + regex);
+            pattern.regex.optimize();
+            pattern.wildcard = true;
+        } else {
+            pattern.exact = type;
+        }
+        compiled.append(std::move(pattern));
+    }
+    return compiled;
+}
+
+bool anyMatches(const QVector<CompiledPattern>& patterns, const QString& state)
+{
+    for (const CompiledPattern& pattern : patterns) {
+        if (pattern.matches(state)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+BlockPredicate::BlockPredicate(const QStringList& patterns, std::shared_ptr<const BlockRegistry> registry)
+    : patternList(patterns)
+    , registry(std::move(registry))
+{
+    const QVector<CompiledPattern> compiled = compilePatterns(patterns);
+    unknownMatches = anyMatches(compiled, QStringLiteral("minecraft:air"));
+    if (!this->registry) {
+        return;
+    }
+
+    const QMap<uint32_t, QString> states = this->registry->states();
+    if (states.isEmpty()) {
+        return;
+    }
+    // Gaps in the id range are unknown ids, so they start out as unknownMatches
+    stateBits.fill(unknownMatches ? ~uint64_t(0) : 0, static_cast<qsizetype>(states.lastKey() / 64) + 1);
+    for (auto it = states.constBegin(); it != states.constEnd(); ++it) {
+        const uint32_t id = it.key();
+        const uint64_t bit = uint64_t(1) << (id & 63);
+        if (anyMatches(compiled, it.value())) {
+            stateBits[id >> 6] |= bit;
+            anyState = true;
+        } else {
+            stateBits[id >> 6] &= ~bit;
+        }
+    }
+}
+
+BlockPredicate::SectionMask BlockPredicate::sectionMask(const ChunkSection& section) const
+{
+    SectionMask mask;
+    mask.paletteSize = static_cast<uint32_t>(section.palette.size());
+    mask.outOfRangeMatches = matches(BlockRegistry::AIR_STATE_ID);
+    mask.bits.fill(0, (section.palette.size() + 63) / 64);
+    // Only reachable if some index can point past the palette
+    const bool readsPastPalette = section.uniform
+        ? section.palette.isEmpty()
+        : section.packedIndices.isEmpty() ||
+          (section.bitsPerEntry < 32 && (qint64(1) << section.bitsPerEntry) > section.palette.size());
+    mask.anyMatch = mask.outOfRangeMatches && readsPastPalette;
+    for (qsizetype slot = 0; slot < section.palette.size(); ++slot) {
+        if (matches(section.palette[slot])) {
+            mask.bits[slot >> 6] |= uint64_t(1) << (slot & 63);
+            mask.anyMatch = true;
+        }
+    }
+    return mask;
+}
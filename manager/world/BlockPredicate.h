@@ -0,0 +1,62 @@
+#ifndef BLOCKPREDICATE_H
+#define BLOCKPREDICATE_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <memory>
+#include "world/BlockRegistry.h"
+
+struct ChunkSection;
+
+// Block type patterns compiled against a BlockRegistry into a bitset of matching state ids.
+// A pattern matches a state exactly ("minecraft:chest[facing=north]"), by block id regardless
+// of properties ("minecraft:chest"), or with '*' wildcards from the start of the state name
+// ("*:chest", "minecraft:*_ore"). Ids missing from the registry read as minecraft:air.
+class BlockPredicate {
+public:
+    // Palette slots of one section that match; indices past the palette read as air
+    class SectionMask {
+    public:
+        bool any() const { return anyMatch; }
+        bool test(uint32_t slot) const {
+            if (slot >= paletteSize) return outOfRangeMatches;
+            return (bits[slot >> 6] >> (slot & 63)) & 1;
+        }
+        // Raw form for BlockScan::matchSlots
+        const uint64_t* slotBits() const { return bits.constData(); }
+        uint32_t slotCount() const { return paletteSize; }
+        bool pastEndMatches() const { return outOfRangeMatches; }
+
+    private:
+        friend class BlockPredicate;
+        QVector<uint64_t> bits;
+        uint32_t paletteSize = 0;
+        bool outOfRangeMatches = false;
+        bool anyMatch = false;
+    };
+
+    BlockPredicate() = default;
+    BlockPredicate(const QStringList& patterns, std::shared_ptr<const BlockRegistry> registry);
+
+    bool matches(uint32_t stateId) const {
+        if (stateId >= static_cast<uint32_t>(stateBits.size()) * 64) return unknownMatches;
+        return (stateBits[stateId >> 6] >> (stateId & 63)) & 1;
+    }
+    bool matchesNothing() const { return !anyState && !unknownMatches; }
+    // A section with no matching slot can be skipped without reading its indices
+    SectionMask sectionMask(const ChunkSection& section) const;
+
+    const QStringList& patterns() const { return patternList; }
+    // Chunks resolve their palettes through their own registry; recompile if it differs
+    bool isCompiledFor(const std::shared_ptr<const BlockRegistry>& other) const { return registry == other; }
+
+private:
+    QStringList patternList;
+    std::shared_ptr<const BlockRegistry> registry;
+    QVector<uint64_t> stateBits;   // Bit per state id in the registry
+    bool unknownMatches = false;  // Ids outside the registry, which read as minecraft:air
+    bool anyState = false;
+};
+
+#endif // BLOCKPREDICATE_H
@@ -186,6 +186,12 @@ std::optional<uint32_t> BlockRegistry::getStateId(const QString& blockState) con
     return std::nullopt;
 }
 
+QMap<uint32_t, QString> BlockRegistry::states() const
+{
+    QMutexLocker locker(&mutex);
+    return idToState;
+}
+
 bool BlockRegistry::isFaceSolid(uint32_t stateId, Direction direction) const
 {
     QMutexLocker locker(&mutex);
@@ -20,6 +20,7 @@ public:
     };
     static constexpr quint32 MAGIC_NUMBER = 0x424C4B52;  // "BLKR"
     static constexpr qint32 FORMAT_VERSION = 2;
+    static constexpr uint32_t AIR_STATE_ID = 0;  // minecraft:air is state 0 in every vanilla registry
 
     BlockRegistry() = default;
 
@@ -29,6 +30,7 @@ public:
     void setFaceMask(uint32_t id, uint8_t mask);
     std::optional<QString> getBlockState(uint32_t id) const;
     std::optional<uint32_t> getStateId(const QString& blockState) const;
+    QMap<uint32_t, QString> states() const;  // Every state by id (implicitly shared copy)
     bool isFaceSolid(uint32_t stateId, Direction direction) const;
 
     int getDataVersion() const { return dataVersion; }
@@ -0,0 +1,327 @@
+#include "BlockScan.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64) || defined(_M_IX86)
+#define BLOCKSCAN_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define BLOCKSCAN_TARGET(isa)
+#else
+#define BLOCKSCAN_TARGET(isa) __attribute__((target(isa)))
+#endif
+#endif
+
+namespace {
+
+using namespace BlockScan;
+
+bool slotMatches(const uint64_t *slotBits, uint32_t slotCount, bool pastEndMatches, uint32_t slot)
+{
+    if (slot >= slotCount) return pastEndMatches;
+    return (slotBits[slot >> 6] >> (slot & 63)) & 1;
+}
+
+void matchSlotsScalar(const uint32_t *indices, const uint64_t *slotBits, uint32_t slotCount, bool pastEndMatches,
+                      uint64_t *out)
+{
+    for (int word = 0; word < kWords; ++word) {
+        uint64_t bits = 0;
+        const uint32_t *chunk = indices + word * 64;
+        for (int i = 0; i < 64; ++i) {
+            bits |= uint64_t(slotMatches(slotBits, slotCount, pastEndMatches, chunk[i])) << i;
+        }
+        out[word] = bits;
+    }
+}
+
+void filterLightScalar(const uint8_t *light, int min, int max, uint64_t *bits)
+{
+    for (int word = 0; word < kWords; ++word) {
+        if (!bits[word]) continue;
+        uint64_t keep = 0;
+        for (int i = 0; i < 64; ++i) {
+            const int idx = word * 64 + i;
+            const int level = (light[idx / 2] >> ((idx % 2) * 4)) & 0xF;
+            keep |= uint64_t(level >= min && level <= max) << i;
+        }
+        bits[word] &= keep;
+    }
+}
+
+#ifdef BLOCKSCAN_X86
+
+// Matching slots compared lane by lane; with more, the SIMD paths use a lookup instead
+constexpr int kMaxCompareSlots = 8;
+
+// The slots set in slotBits; -1 if there are more than kMaxCompareSlots
+int collectSlots(const uint64_t *slotBits, uint32_t slotCount, uint32_t *slots)
+{
+    int count = 0;
+    for (uint32_t slot = 0; slot < slotCount; ++slot) {
+        if (!slotBits[slot >> 6]) {
+            slot |= 63;  // Skip the rest of an empty word
+            continue;
+        }
+        if ((slotBits[slot >> 6] >> (slot & 63)) & 1) {
+            if (count == kMaxCompareSlots) return -1;
+            slots[count++] = slot;
+        }
+    }
+    return count;
+}
+
+BLOCKSCAN_TARGET("sse4.1")
+void matchSlotsSse41(const uint32_t *indices, const uint64_t *slotBits, uint32_t slotCount, bool pastEndMatches,
+                     uint64_t *out)
+{
+    uint32_t slots[kMaxCompareSlots];
+    const int slotTotal = collectSlots(slotBits, slotCount, slots);
+    if (slotTotal < 0) {
+        matchSlotsScalar(indices, slotBits, slotCount, pastEndMatches, out);
+        return;
+    }
+
+    __m128i wanted[kMaxCompareSlots];
+    for (int s = 0; s < slotTotal; ++s) {
+        wanted[s] = _mm_set1_epi32(static_cast<int>(slots[s]));
+    }
+    // Unsigned index <= slotCount - 1 means it is inside the palette
+    const __m128i lastSlot = _mm_set1_epi32(static_cast<int>(slotCount - 1));
+
+    for (int word = 0; word < kWords; ++word) {
+        uint64_t bits = 0;
+        for (int i = 0; i < 64; i += 4) {
+            const __m128i idx = _mm_loadu_si128(reinterpret_cast<const __m128i *>(indices + word * 64 + i));
+            __m128i hit = _mm_setzero_si128();
+            for (int s = 0; s < slotTotal; ++s) {
+                hit = _mm_or_si128(hit, _mm_cmpeq_epi32(idx, wanted[s]));
+            }
+            if (pastEndMatches) {
+                const __m128i inside = slotCount == 0 ? _mm_setzero_si128()
+                                                      : _mm_cmpeq_epi32(_mm_min_epu32(idx, lastSlot), idx);
+                hit = _mm_or_si128(hit, _mm_andnot_si128(inside, _mm_set1_epi32(-1)));
+            }
+            bits |= uint64_t(_mm_movemask_ps(_mm_castsi128_ps(hit))) << i;
+        }
+        out[word] = bits;
+    }
+}
+
+BLOCKSCAN_TARGET("avx2")
+void matchSlotsAvx2(const uint32_t *indices, const uint64_t *slotBits, uint32_t slotCount, bool pastEndMatches,
+                    uint64_t *out)
+{
+    uint32_t slots[kMaxCompareSlots];
+    const int slotTotal = collectSlots(slotBits, slotCount, slots);
+
+    if (slotTotal >= 0) {
+        __m256i wanted[kMaxCompareSlots];
+        for (int s = 0; s < slotTotal; ++s) {
+            wanted[s] = _mm256_set1_epi32(static_cast<int>(slots[s]));
+        }
+        const __m256i lastSlot = _mm256_set1_epi32(static_cast<int>(slotCount - 1));
+
+        for (int word = 0; word < kWords; ++word) {
+            uint64_t bits = 0;
+            for (int i = 0; i < 64; i += 8) {
+                const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices + word * 64 + i));
+                __m256i hit = _mm256_setzero_si256();
+                for (int s = 0; s < slotTotal; ++s) {
+                    hit = _mm256_or_si256(hit, _mm256_cmpeq_epi32(idx, wanted[s]));
+                }
+                if (pastEndMatches) {
+                    const __m256i inside = slotCount == 0 ? _mm256_setzero_si256()
+                                                          : _mm256_cmpeq_epi32(_mm256_min_epu32(idx, lastSlot), idx);
+                    hit = _mm256_or_si256(hit, _mm256_andnot_si256(inside, _mm256_set1_epi32(-1)));
+                }
+                bits |= uint64_t(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(hit)))) << i;
+            }
+            out[word] = bits;
+        }
+        return;
+    }
+
+    // Many matching slots: gather from a per-slot table, masking lanes past the palette
+    std::vector<int32_t> table(slotCount);
+    for (uint32_t slot = 0; slot < slotCount; ++slot) {
+        table[slot] = slotMatches(slotBits, slotCount, false, slot) ? -1 : 0;
+    }
+    const __m256i lastSlot = _mm256_set1_epi32(static_cast<int>(slotCount - 1));
+    const __m256i pastEnd = _mm256_set1_epi32(pastEndMatches ? -1 : 0);
+
+    for (int word = 0; word < kWords; ++word) {
+        uint64_t bits = 0;
+        for (int i = 0; i < 64; i += 8) {
+            const __m256i idx = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(indices + word * 64 + i));
+            const __m256i inside = _mm256_cmpeq_epi32(_mm256_min_epu32(idx, lastSlot), idx);
+            const __m256i hit = _mm256_mask_i32gather_epi32(pastEnd, table.data(), idx, inside, 4);
+            bits |= uint64_t(static_cast<uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(hit)))) << i;
+        }
+        out[word] = bits;
+    }
+}
+
+// Only needs SSE2, but shares the SSE4.1 dispatch
+BLOCKSCAN_TARGET("sse4.1")
+void filterLightSse41(const uint8_t *light, int min, int max, uint64_t *bits)
+{
+    const __m128i low = _mm_set1_epi8(0x0F);
+    const __m128i lo = _mm_set1_epi8(static_cast<char>(min));
+    const __m128i hi = _mm_set1_epi8(static_cast<char>(max));
+
+    for (int word = 0; word < kWords; ++word) {
+        if (!bits[word]) continue;
+        uint64_t keep = 0;
+        // 16 bytes hold the nibbles of 32 blocks
+        for (int half = 0; half < 2; ++half) {
+            const __m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i *>(light + word * 32 + half * 16));
+            const __m128i even = _mm_and_si128(packed, low);
+            const __m128i odd = _mm_and_si128(_mm_srli_epi16(packed, 4), low);
+            const __m128i first = _mm_unpacklo_epi8(even, odd);
+            const __m128i second = _mm_unpackhi_epi8(even, odd);
+            const __m128i firstIn = _mm_cmpeq_epi8(_mm_max_epu8(_mm_min_epu8(first, hi), lo), first);
+            const __m128i secondIn = _mm_cmpeq_epi8(_mm_max_epu8(_mm_min_epu8(second, hi), lo), second);
+            const uint64_t mask = static_cast<uint32_t>(_mm_movemask_epi8(firstIn)) |
+                                  static_cast<uint64_t>(static_cast<uint32_t>(_mm_movemask_epi8(secondIn))) << 16;
+            keep |= mask << (half * 32);
+        }
+        bits[word] &= keep;
+    }
+}
+
+enum class Isa { Scalar, Sse41, Avx2 };
+
+Isa detectIsa()
+{
+#if defined(_MSC_VER) && !defined(__clang__)
+    int info[4];
+    __cpuid(info, 0);
+    const int maxLeaf = info[0];
+    __cpuid(info, 1);
+    const bool sse41 = (info[2] >> 19) & 1;
+    const bool osAvx = ((info[2] >> 27) & 1) && ((info[2] >> 28) & 1) && (_xgetbv(0) & 0x6) == 0x6;
+    bool avx2 = false;
+    if (maxLeaf >= 7 && osAvx) {
+        __cpuidex(info, 7, 0);
+        avx2 = (info[1] >> 5) & 1;
+    }
+#else
+    __builtin_cpu_init();
+    const bool sse41 = __builtin_cpu_supports("sse4.1");
+    const bool avx2 = __builtin_cpu_supports("avx2");
+#endif
+    if (avx2) return Isa::Avx2;
+    if (sse41) return Isa::Sse41;
+    return Isa::Scalar;
+}
+
+Isa activeIsa()
+{
+    static const Isa isa = detectIsa();
+    return isa;
+}
+
+#endif // BLOCKSCAN_X86
+
+} // namespace
+
+namespace BlockScan {
+
+void matchSlots(const uint32_t *indices, const uint64_t *slotBits, uint32_t slotCount, bool pastEndMatches,
+                uint64_t *out)
+{
+#ifdef BLOCKSCAN_X86
+    switch (activeIsa()) {
+    case Isa::Avx2:
+        matchSlotsAvx2(indices, slotBits, slotCount, pastEndMatches, out);
+        return;
+    case Isa::Sse41:
+        matchSlotsSse41(indices, slotBits, slotCount, pastEndMatches, out);
+        return;
+    case Isa::Scalar:
+        break;
+    }
+#endif
+    matchSlotsScalar(indices, slotBits, slotCount, pastEndMatches, out);
+}
+
+void filterLight(const uint8_t *light, int min, int max, uint64_t *bits)
+{
+    if (min <= 0 && max >= 15) return;
+    if (!light) {
+        // Absent light reads as 0 everywhere
+        if (min > 0 || max < 0) {
+            std::memset(bits, 0, kWords * sizeof(uint64_t));
+        }
+        return;
+    }
+    min = std::max(min, 0);
+    max = std::min(max, 15);
+    if (min > max) {
+        std::memset(bits, 0, kWords * sizeof(uint64_t));
+        return;
+    }
+#ifdef BLOCKSCAN_X86
+    if (activeIsa() != Isa::Scalar) {
+        filterLightSse41(light, min, max, bits);
+        return;
+    }
+#endif
+    filterLightScalar(light, min, max, bits);
+}
+
+void clipToSphere(double dx0, double dy0, double dz0, double limitSq, uint64_t *bits)
+{
+    auto inside = [&](int x, double yzSq) {
+        const double dx = dx0 + x;
+        return yzSq + dx * dx <= limitSq;
+    };
+
+    for (int y = 0; y < 16; ++y) {
+        const double dy = dy0 + y;
+        for (int z = 0; z < 16; ++z) {
+            const int row = y * 256 + z * 16;
+            uint64_t &word = bits[row / 64];
+            const int shift = row % 64;
+            if (!((word >> shift) & 0xFFFF)) continue;
+
+            const double dz = dz0 + z;
+            const double yzSq = dy * dy + dz * dz;
+            const double remaining = limitSq - yzSq;
+            uint64_t rowMask = 0;
+            if (remaining >= 0) {
+                // The blocks in reach form one run along X; the sqrt estimate is
+                // nudged so the ends agree with the exact distance test
+                const double reach = std::sqrt(remaining);
+                int first = static_cast<int>(std::clamp(std::ceil(-reach - dx0), 0.0, 16.0));
+                int last = static_cast<int>(std::clamp(std::floor(reach - dx0), -1.0, 15.0));
+                while (first > 0 && inside(first - 1, yzSq)) --first;
+                while (first < 16 && !inside(first, yzSq)) ++first;
+                while (last < 15 && inside(last + 1, yzSq)) ++last;
+                while (last >= 0 && !inside(last, yzSq)) --last;
+                if (first <= last) {
+                    rowMask = ((uint64_t(1) << (last - first + 1)) - 1) << first;
+                }
+            }
+            word &= ~(uint64_t(0xFFFF) << shift) | (rowMask << shift);
+        }
+    }
+}
+
+const char *implementation()
+{
+#ifdef BLOCKSCAN_X86
+    switch (activeIsa()) {
+    case Isa::Avx2: return "avx2";
+    case Isa::Sse41: return "sse4.1";
+    case Isa::Scalar: break;
+    }
+#endif
+    return "scalar";
+}
+
+} // namespace BlockScan
@@ -0,0 +1,36 @@
+#ifndef BLOCKSCAN_H
+#define BLOCKSCAN_H
+
+#include <cstdint>
+
+/**
+ * Kernels for block searches over one 16x16x16 section. Results are bitmaps
+ * of 4096 bits in YZX order (bit y*256 + z*16 + x), so each 16-bit run is one
+ * row along X. The implementation (AVX2, SSE4.1 or scalar) is picked at run
+ * time from what the CPU supports; all of them give the same result.
+ */
+namespace BlockScan {
+
+constexpr int kSectionBlocks = 4096;
+constexpr int kWords = kSectionBlocks / 64;
+
+// Sets bit i of `out` if slot indices[i] is set in `slotBits` (a bit per palette
+// slot). Indices at or past slotCount read as air and match if `pastEndMatches`.
+void matchSlots(const uint32_t *indices, const uint64_t *slotBits, uint32_t slotCount, bool pastEndMatches,
+                uint64_t *out);
+
+// Clears bits whose light level lies outside min-max. `light` is a 2048-byte
+// nibble array (low nibble first) or null, which reads as all 0.
+void filterLight(const uint8_t *light, int min, int max, uint64_t *bits);
+
+// Clears bits farther than sqrt(limitSq) from the center. dx0/dy0/dz0 are the
+// offsets of the section's first block from the center; rows whose YZ distance
+// alone is over the limit are cleared whole.
+void clipToSphere(double dx0, double dy0, double dz0, double limitSq, uint64_t *bits);
+
+// "avx2", "sse4.1" or "scalar"
+const char *implementation();
+
+} // namespace BlockScan
+
+#endif // BLOCKSCAN_H
@@ -1,4 +1,5 @@
 #include "NBTSerializer.h"
+#include "network/StringDictionary.h"
 #include <io/stream_reader.h>
 #include <QRegularExpression>
 #include <QStringList>
@@ -17,8 +18,11 @@ nbt::tag_compound NBTSerializer::chunkToNBT(const ChunkData& chunk, int dataVers
 
     // Calculate yPos (lowest section Y index)
     int lowestSectionY = 0;
-    if (!chunk.sections.isEmpty()) {
-        lowestSectionY = chunk.sections.firstKey();
+    for (int i = 0; i < chunk.sections.size(); ++i) {
+        if (chunk.sections[i]) {
+            lowestSectionY = chunk.minSectionY() + i;
+            break;
+        }
     }
     root.insert("yPos", nbt::tag_int(lowestSectionY));
 
@@ -28,8 +32,10 @@ nbt::tag_compound NBTSerializer::chunkToNBT(const ChunkData& chunk, int dataVers
 
     // Convert sections
     nbt::tag_list sections(nbt::tag_type::Compound);
-    for (auto it = chunk.sections.constBegin(); it != chunk.sections.constEnd(); ++it) {
-        sections.push_back(sectionToNBT(it.value()));
+    for (int i = 0; i < chunk.sections.size(); ++i) {
+        if (chunk.sections[i]) {
+            sections.push_back(sectionToNBT(*chunk.sections[i], chunk.minSectionY() + i, chunk.blockRegistry.get()));
+        }
     }
     root.insert("sections", std::move(sections));
 
@@ -269,15 +275,15 @@ nbt::tag_compound NBTSerializer::playerToNBT(const PlayerSaveData& data, int dat
     return root;
 }
 
-nbt::tag_compound NBTSerializer::sectionToNBT(const ChunkSection& section) {
+nbt::tag_compound NBTSerializer::sectionToNBT(const ChunkSection& section, int sectionY, const BlockRegistry* registry) {
     nbt::tag_compound sectionTag;
 
-    sectionTag.insert("Y", nbt::tag_byte(section.sectionY));
+    sectionTag.insert("Y", nbt::tag_byte(sectionY));
 
     nbt::tag_compound blockStates;
 
     // Convert palette
-    std::vector<nbt::tag_compound> paletteTags = convertPalette(section.palette);
+    std::vector<nbt::tag_compound> paletteTags = convertPalette(section.palette, registry);
     nbt::tag_list paletteList(nbt::tag_type::Compound);
     for (auto& paletteTag : paletteTags) {
         paletteList.push_back(std::move(paletteTag));
@@ -285,7 +291,7 @@ nbt::tag_compound NBTSerializer::sectionToNBT(const ChunkSection& section) {
     blockStates.insert("palette", std::move(paletteList));
 
     // Convert indices if not uniform
-    if (!section.uniform && !section.blockIndices.isEmpty()) {
+    if (!section.uniform && !section.packedIndices.isEmpty()) {
         // Pack indices into long array using Minecraft's variable-width format
         // Uses 4-8 bits per entry for indirect palette, or 15 bits for direct palette
         int bitsPerEntry = std::max(4, static_cast<int>(std::ceil(std::log2(section.palette.size()))));
@@ -297,11 +303,13 @@ nbt::tag_compound NBTSerializer::sectionToNBT(const ChunkSection& section) {
         int longCount = (4096 + entriesPerLong - 1) / entriesPerLong;
 
         std::vector<int64_t> packedData(longCount, 0);
+        std::vector<uint32_t> blockIndices(4096);
+        section.unpackIndices(blockIndices.data());
 
-        for (int i = 0; i < section.blockIndices.size() && i < 4096; i++) {
+        for (int i = 0; i < 4096; i++) {
             int longIndex = i / entriesPerLong;
             int bitOffset = (i % entriesPerLong) * bitsPerEntry;
-            uint32_t value = section.blockIndices[i];
+            uint32_t value = blockIndices[i];
             uint64_t mask = ((1ULL << bitsPerEntry) - 1);
             packedData[longIndex] |= (static_cast<uint64_t>(value) & mask) << bitOffset;
         }
@@ -318,8 +326,9 @@ nbt::tag_compound NBTSerializer::sectionToNBT(const ChunkSection& section) {
     if (section.biomePalette.isEmpty()) {
         biomePaletteTag.push_back(nbt::tag_string("minecraft:the_void"));
     } else {
-        for (const QString& biomeId : section.biomePalette) {
-            biomePaletteTag.push_back(nbt::tag_string(biomeId.toStdString()));
+        for (quint32 biomeId : section.biomePalette) {
+            QString biome = StringInterner::stringFor(biomeId);
+            biomePaletteTag.push_back(nbt::tag_string(biome.isEmpty() ? "minecraft:the_void" : biome.toStdString()));
         }
 
         if (section.biomePalette.size() > 1 && !section.biomeIndices.isEmpty()) {
@@ -332,7 +341,7 @@ nbt::tag_compound NBTSerializer::sectionToNBT(const ChunkSection& section) {
                 int longIndex = i / entriesPerLong;
                 int bitOffset = (i % entriesPerLong) * bitsPerEntry;
                 uint64_t mask = (1ULL << bitsPerEntry) - 1;
-                packedData[longIndex] |= (static_cast<uint64_t>(section.biomeIndices[i]) & mask) << bitOffset;
+                packedData[longIndex] |= (static_cast<uint64_t>(static_cast<uint8_t>(section.biomeIndices[i])) & mask) << bitOffset;
             }
             biomes.insert("data", nbt::tag_long_array(std::move(packedData)));
         }
@@ -366,10 +375,11 @@ nbt::tag_compound NBTSerializer::createHeightmaps(const ChunkData& chunk) {
     int longCount = (256 + entriesPerLong - 1) / entriesPerLong;  // 37 longs
 
     std::vector<int64_t> motionBlocking(longCount, 0);
+    QHash<uint32_t, bool> airStates;
 
     for (int z = 0; z < 16; z++) {
         for (int x = 0; x < 16; x++) {
-            int height = findHighestBlock(chunk, x, z);
+            int height = findHighestBlock(chunk, x, z, airStates);
             int index = z * 16 + x;
             setPackedValue(motionBlocking, index, height, bitsPerEntry);
         }
@@ -415,11 +425,17 @@ nbt::tag_compound NBTSerializer::blockStateToNBT(const QString& blockState) {
     return tag;
 }
 
-int NBTSerializer::findHighestBlock(const ChunkData& chunk, int x, int z) {
+int NBTSerializer::findHighestBlock(const ChunkData& chunk, int x, int z, QHash<uint32_t, bool>& airStates) {
     // Search from top to bottom for first non-air block
     for (int y = chunk.maxY - 1; y >= chunk.minY; y--) {
-        auto block = chunk.getBlock(x, y, z);
-        if (block.has_value() && !block->contains("air")) {
+        auto stateId = chunk.getStateId(x, y, z);
+        if (!stateId.has_value()) continue;
+
+        auto it = airStates.constFind(*stateId);
+        if (it == airStates.constEnd()) {
+            it = airStates.insert(*stateId, chunk.blockStateName(*stateId).contains("air"));
+        }
+        if (!*it) {
             return y - chunk.minY;  // Return relative height
         }
     }
@@ -439,23 +455,25 @@ void NBTSerializer::setPackedValue(std::vector<int64_t>& data, int index, int va
     data[longIndex] |= (static_cast<uint64_t>(value) & mask) << bitOffset;
 }
 
-std::vector<nbt::tag_compound> NBTSerializer::convertPalette(const QVector<QString>& palette) {
+std::vector<nbt::tag_compound> NBTSerializer::convertPalette(const QVector<uint32_t>& palette, const BlockRegistry* registry) {
     std::vector<nbt::tag_compound> result;
     result.reserve(palette.size());
 
-    for (const QString& blockState : palette) {
-        result.push_back(blockStateToNBT(blockState));
+    for (uint32_t stateId : palette) {
+        std::optional<QString> blockState = registry ? registry->getBlockState(stateId) : std::nullopt;
+        result.push_back(blockStateToNBT(blockState.value_or("minecraft:air")));
     }
 
     return result;
 }
 
-ChunkSection NBTSerializer::nbtToChunkSection(const nbt::tag_compound& section) {
+ChunkSection NBTSerializer::nbtToChunkSection(const nbt::tag_compound& section, const BlockRegistry* registry,
+                                              int32_t* sectionY) {
     ChunkSection result;
 
-    if (section.has_key("Y")) {
+    if (sectionY && section.has_key("Y")) {
         try {
-            result.sectionY = static_cast<int32_t>(
+            *sectionY = static_cast<int32_t>(
                 static_cast<const nbt::tag_byte&>(section.at("Y").get()).get());
         } catch (...) {}
     }
@@ -488,7 +506,8 @@ ChunkSection NBTSerializer::nbtToChunkSection(const nbt::tag_compound& section)
                             blockName += "[" + propParts.join(",") + "]";
                         }
                     }
-                    result.palette.append(blockName);
+                    std::optional<uint32_t> stateId = registry ? registry->getStateId(blockName) : std::nullopt;
+                    result.palette.append(stateId.value_or(BlockRegistry::AIR_STATE_ID));
                 }
             }
 
@@ -501,15 +520,16 @@ ChunkSection NBTSerializer::nbtToChunkSection(const nbt::tag_compound& section)
                 int entriesPerLong = 64 / bitsPerEntry;
                 uint64_t mask = (1ULL << bitsPerEntry) - 1;
 
-                result.blockIndices.resize(4096, 0);
+                std::vector<uint32_t> blockIndices(4096, 0);
                 for (int i = 0; i < 4096; i++) {
                     int longIndex = i / entriesPerLong;
                     int bitOffset = (i % entriesPerLong) * bitsPerEntry;
                     if (longIndex < static_cast<int>(dataArr.size())) {
                         uint64_t longVal = static_cast<uint64_t>(dataArr[longIndex]);
-                        result.blockIndices[i] = static_cast<uint32_t>((longVal >> bitOffset) & mask);
+                        blockIndices[i] = static_cast<uint32_t>((longVal >> bitOffset) & mask);
                     }
                 }
+                result.setIndices(blockIndices.data());
             } else {
                 // No data array means single-value section (uniform)
                 result.uniform = true;
@@ -524,8 +544,8 @@ ChunkSection NBTSerializer::nbtToChunkSection(const nbt::tag_compound& section)
             if (biomes.has_key("palette")) {
                 const auto& biomePaletteList = static_cast<const nbt::tag_list&>(biomes.at("palette").get());
                 for (const nbt::value& entry : biomePaletteList) {
-                    result.biomePalette.append(QString::fromStdString(
-                        static_cast<const nbt::tag_string&>(entry.get()).get()));
+                    result.biomePalette.append(StringInterner::idFor(QString::fromStdString(
+                        static_cast<const nbt::tag_string&>(entry.get()).get())));
                 }
             }
             if (biomes.has_key("data") && result.biomePalette.size() > 1) {
@@ -533,13 +553,13 @@ ChunkSection NBTSerializer::nbtToChunkSection(const nbt::tag_compound& section)
                 int bitsPerEntry = static_cast<int>(std::ceil(std::log2(result.biomePalette.size())));
                 int entriesPerLong = 64 / bitsPerEntry;
                 uint64_t mask = (1ULL << bitsPerEntry) - 1;
-                result.biomeIndices.resize(64, 0);
+                result.biomeIndices = QByteArray(64, '\0');
                 for (int i = 0; i < 64; i++) {
                     int longIndex = i / entriesPerLong;
                     int bitOffset = (i % entriesPerLong) * bitsPerEntry;
                     if (longIndex < static_cast<int>(dataArr.size())) {
                         uint64_t longVal = static_cast<uint64_t>(dataArr[longIndex]);
-                        result.biomeIndices[i] = static_cast<uint32_t>((longVal >> bitOffset) & mask);
+                        result.biomeIndices[i] = static_cast<char>((longVal >> bitOffset) & mask);
                     }
                 }
             } else if (result.biomePalette.size() <= 1) {
@@ -575,8 +595,9 @@ ChunkSection NBTSerializer::nbtToChunkSection(const nbt::tag_compound& section)
     return result;
 }
 
-ChunkData NBTSerializer::nbtToChunk(const nbt::tag_compound& root) {
+ChunkData NBTSerializer::nbtToChunk(const nbt::tag_compound& root, std::shared_ptr<const BlockRegistry> registry) {
     ChunkData result;
+    result.blockRegistry = std::move(registry);
 
     try {
         if (root.has_key("xPos")) result.chunkX = static_cast<const nbt::tag_int&>(root.at("xPos").get()).get();
@@ -586,17 +607,23 @@ ChunkData NBTSerializer::nbtToChunk(const nbt::tag_compound& root) {
     if (root.has_key("sections")) {
         try {
             const auto& sectionsList = static_cast<const nbt::tag_list&>(root.at("sections").get());
+            QMap<int32_t, std::shared_ptr<const ChunkSection>> sections;
             for (const nbt::value& entry : sectionsList) {
                 const auto& sectionTag = static_cast<const nbt::tag_compound&>(entry.get());
-                ChunkSection sec = nbtToChunkSection(sectionTag);
-                result.sections[sec.sectionY] = std::move(sec);
+                int32_t sectionY = 0;
+                ChunkSection sec = nbtToChunkSection(sectionTag, result.blockRegistry.get(), &sectionY);
+                sections[sectionY] = std::make_shared<ChunkSection>(std::move(sec));
             }
-        } catch (...) {}
-    }
 
-    if (!result.sections.isEmpty()) {
-        result.minY = result.sections.firstKey() * 16;
-        result.maxY = (result.sections.lastKey() + 1) * 16;
+            // Section range first, so setSection can place them
+            if (!sections.isEmpty()) {
+                result.minY = sections.firstKey() * 16;
+                result.maxY = (sections.lastKey() + 1) * 16;
+            }
+            for (auto it = sections.constBegin(); it != sections.constEnd(); ++it) {
+                result.setSection(it.key(), it.value());
+            }
+        } catch (...) {}
     }
 
     return result;
@@ -1,6 +1,7 @@
 #ifndef NBTSERIALIZER_H
 #define NBTSERIALIZER_H
 
+#include <QHash>
 #include <QString>
 #include <QVector>
 #include "../bot/WorldData.h"
@@ -18,12 +19,14 @@ public:
     // Chunk NBT (block data + block entities)
     static nbt::tag_compound chunkToNBT(const ChunkData& chunk, int dataVersion,
                                         const QVector<BlockEntityData>& blockEntities = {});
-    static nbt::tag_compound sectionToNBT(const ChunkSection& section);
+    static nbt::tag_compound sectionToNBT(const ChunkSection& section, int sectionY, const BlockRegistry* registry);
     static nbt::tag_compound createHeightmaps(const ChunkData& chunk);
 
-    // Deserializers - read from NBT back into data structures
-    static ChunkSection nbtToChunkSection(const nbt::tag_compound& section);
-    static ChunkData nbtToChunk(const nbt::tag_compound& root);
+    // Deserializers - read from NBT back into data structures. Block names missing
+    // from the registry (or with no registry) are read as air.
+    static ChunkSection nbtToChunkSection(const nbt::tag_compound& section, const BlockRegistry* registry,
+                                          int32_t* sectionY = nullptr);
+    static ChunkData nbtToChunk(const nbt::tag_compound& root, std::shared_ptr<const BlockRegistry> registry);
     static QVector<BlockEntityData> nbtToBlockEntities(const nbt::tag_compound& root, const QString& dimension);
 
     // Example: "minecraft:chest[facing=north,type=single]" -> {Name: "minecraft:chest", Properties: {facing: "north", type: "single"}}
@@ -49,9 +52,10 @@ private:
     // Builds {id, count, components} without a Slot field. Used for equipment compound and as base for itemStackToNBT.
     static nbt::tag_compound buildItemNBT(const mankool::mcbot::protocol::ItemStack& item);
 
-    static int findHighestBlock(const ChunkData& chunk, int x, int z);  // x, z: 0-15; returns Y or minY if all air
+    // x, z: 0-15; returns Y or minY if all air. airStates caches the air check per state id.
+    static int findHighestBlock(const ChunkData& chunk, int x, int z, QHash<uint32_t, bool>& airStates);
     static void setPackedValue(std::vector<int64_t>& data, int index, int value, int bitsPerEntry);
-    static std::vector<nbt::tag_compound> convertPalette(const QVector<QString>& palette);
+    static std::vector<nbt::tag_compound> convertPalette(const QVector<uint32_t>& palette, const BlockRegistry* registry);
 };
 
 #endif // NBTSERIALIZER_H
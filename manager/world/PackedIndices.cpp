@@ -0,0 +1,106 @@
+#include "PackedIndices.h"
+#include <QtEndian>
+#include <algorithm>
+#include <array>
+#include <utility>
+
+namespace {
+
+// Width is a template parameter so the per-word loop has a constant trip
+// count and constant shifts; the compiler unrolls and vectorizes it.
+template <int Bits>
+void unpackFixed(const uchar *src, uint32_t *out, int count)
+{
+    constexpr int perWord = 64 / Bits;
+    constexpr uint64_t mask = (uint64_t(1) << Bits) - 1;
+
+    const int fullWords = count / perWord;
+    for (int w = 0; w < fullWords; ++w) {
+        const uint64_t word = qFromLittleEndian<quint64>(src + w * 8);
+        uint32_t *dst = out + w * perWord;
+        for (int k = 0; k < perWord; ++k) {
+            dst[k] = static_cast<uint32_t>((word >> (k * Bits)) & mask);
+        }
+    }
+
+    const int tail = count - fullWords * perWord;
+    if (tail > 0) {
+        const uint64_t word = qFromLittleEndian<quint64>(src + fullWords * 8);
+        uint32_t *dst = out + fullWords * perWord;
+        for (int k = 0; k < tail; ++k) {
+            dst[k] = static_cast<uint32_t>((word >> (k * Bits)) & mask);
+        }
+    }
+}
+
+using UnpackFn = void (*)(const uchar *, uint32_t *, int);
+
+template <int... Bits>
+constexpr auto makeKernels(std::integer_sequence<int, Bits...>)
+{
+    return std::array<UnpackFn, sizeof...(Bits)>{ &unpackFixed<Bits + 1>... };
+}
+
+// kernels[bits - 1]
+constexpr auto kernels = makeKernels(std::make_integer_sequence<int, 32>{});
+
+} // namespace
+
+namespace PackedIndices {
+
+int bitsForPaletteSize(int paletteSize)
+{
+    int bits = 1;
+    while (bits < 32 && (int64_t(1) << bits) < paletteSize) {
+        ++bits;
+    }
+    return bits;
+}
+
+qsizetype packedSize(int count, int bitsPerEntry)
+{
+    const int perWord = 64 / bitsPerEntry;
+    return qsizetype((count + perWord - 1) / perWord) * 8;
+}
+
+bool unpack(QByteArrayView data, int bitsPerEntry, uint32_t *out, int count)
+{
+    if (bitsPerEntry < 1 || bitsPerEntry > 32 || count < 0) {
+        return false;
+    }
+    if (data.size() < packedSize(count, bitsPerEntry)) {
+        return false;
+    }
+    kernels[bitsPerEntry - 1](reinterpret_cast<const uchar *>(data.data()), out, count);
+    return true;
+}
+
+QByteArray pack(const uint32_t *values, int count, int bitsPerEntry)
+{
+    const int perWord = 64 / bitsPerEntry;
+    const uint64_t mask = (uint64_t(1) << bitsPerEntry) - 1;
+    QByteArray data(packedSize(count, bitsPerEntry), Qt::Uninitialized);
+    uchar *dst = reinterpret_cast<uchar *>(data.data());
+
+    for (int start = 0, w = 0; start < count; start += perWord, ++w) {
+        const int n = std::min(perWord, count - start);
+        uint64_t word = 0;
+        for (int k = 0; k < n; ++k) {
+            word |= (uint64_t(values[start + k]) & mask) << (k * bitsPerEntry);
+        }
+        qToLittleEndian<quint64>(word, dst + w * 8);
+    }
+    return data;
+}
+
+void set(uchar *data, int bitsPerEntry, int index, uint32_t value)
+{
+    const int perWord = 64 / bitsPerEntry;
+    const int shift = (index % perWord) * bitsPerEntry;
+    const uint64_t mask = ((uint64_t(1) << bitsPerEntry) - 1) << shift;
+    uchar *wordPtr = data + (index / perWord) * 8;
+    const uint64_t word = qFromLittleEndian<quint64>(wordPtr);
+    qToLittleEndian<quint64>((word & ~mask) | ((uint64_t(value) << shift) & mask), wordPtr);
+}
+
+} // namespace PackedIndices
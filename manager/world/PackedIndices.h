@@ -0,0 +1,43 @@
+#ifndef PACKEDINDICES_H
+#define PACKEDINDICES_H
+
+#include <QByteArray>
+#include <QByteArrayView>
+#include <QtEndian>
+#include <cstdint>
+
+/**
+ * Palette indices packed into little-endian 64-bit words, Minecraft style:
+ * each word holds floor(64 / bitsPerEntry) entries starting at the low bits,
+ * and entries never span two words. This is the wire format of
+ * ChunkSection.packed_block_indices.
+ */
+namespace PackedIndices {
+
+// Smallest width that can address a palette of this size (at least 1 bit)
+int bitsForPaletteSize(int paletteSize);
+
+// Number of bytes needed to pack `count` entries
+qsizetype packedSize(int count, int bitsPerEntry);
+
+// Unpacks `count` entries into `out`. Returns false (leaving `out` untouched)
+// if the width is outside 1-32 or `data` is too short for `count` entries.
+bool unpack(QByteArrayView data, int bitsPerEntry, uint32_t *out, int count);
+
+// Packs `count` entries; values wider than bitsPerEntry are truncated
+QByteArray pack(const uint32_t *values, int count, int bitsPerEntry);
+
+// Single entry access for random reads and writes. No bounds checks: `data`
+// must hold packedSize(index + 1, bitsPerEntry) bytes.
+inline uint32_t get(const uchar *data, int bitsPerEntry, int index)
+{
+    const int perWord = 64 / bitsPerEntry;
+    const uint64_t word = qFromLittleEndian<quint64>(data + (index / perWord) * 8);
+    return static_cast<uint32_t>((word >> ((index % perWord) * bitsPerEntry)) & ((uint64_t(1) << bitsPerEntry) - 1));
+}
+
+void set(uchar *data, int bitsPerEntry, int index, uint32_t value);
+
+} // namespace PackedIndices
+
+#endif // PACKEDINDICES_H